@@ -1,7 +1,12 @@
 #pragma once
 
+#include <array>
+
 #include "d3d11_include.h"
 
+#include "../dxvk/dxvk_buffer.h"
+#include "../dxvk/dxvk_image.h"
+
 namespace dxvk {
 
   /**
@@ -40,4 +45,34 @@ namespace dxvk {
     uint32_t            stride;
   };
 
-}
\ No newline at end of file
+
+
+  /**
+   * \brief Shader resource view binding
+   *
+   * Stores the DXVK views of a shader
+   * resource view for deferred binding.
+   */
+  struct D3D11ViewBinding {
+    Rc<DxvkImageView>   imageView;
+    Rc<DxvkBufferView>  bufferView;
+  };
+
+
+  /**
+   * \brief Resource binding batch
+   *
+   * Stores up to \c N bindings of the same type for a
+   * single shader stage, which are applied to the DXVK
+   * context by one command on the CS thread.
+   * \tparam T Binding type
+   * \tparam N Maximum number of bindings
+   */
+  template<typename T, uint32_t N>
+  struct D3D11BindingBatch {
+    uint32_t                count = 0;
+    std::array<uint32_t, N> slots;
+    std::array<T, N>        bindings;
+  };
+
+}
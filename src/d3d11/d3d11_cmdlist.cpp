@@ -68,13 +68,12 @@ namespace dxvk {
   
   
   uint64_t D3D11CommandList::EmitToCsThread(DxvkCsThread* CsThread) {
-    uint64_t seq = 0;
-
     for (const auto& query : m_queries)
       query->DoDeferredEnd();
 
-    for (const auto& chunk : m_chunks)
-      seq = CsThread->dispatchChunk(DxvkCsChunkRef(chunk));
+    // Chunks are kept alive by the command list, so multiple
+    // executions only need to reference them, not copy them
+    uint64_t seq = CsThread->dispatchChunks(m_chunks.size(), m_chunks.data());
     
     for (const auto& resource : m_resources)
       TrackResourceSequenceNumber(resource, seq);
@@ -10,6 +10,47 @@
 
 namespace dxvk {
 
+  template<uint32_t N>
+  static UINT GatherDirtySlots(
+          DxvkBindingSet<N>&                Mask,
+          UINT*                             pSlots) {
+    UINT count = 0;
+
+    for (int32_t slot = Mask.findNext(0); slot >= 0; slot = Mask.findNext(slot + 1))
+      pSlots[count++] = UINT(slot);
+
+    Mask.clear();
+    return count;
+  }
+
+
+  static void ApplyBinding(
+          DxvkContext*                      ctx,
+          VkShaderStageFlagBits             Stage,
+          UINT                              Slot,
+    const DxvkBufferSlice&                  Binding) {
+    ctx->bindResourceBuffer(Stage, Slot, Binding);
+  }
+
+
+  static void ApplyBinding(
+          DxvkContext*                      ctx,
+          VkShaderStageFlagBits             Stage,
+          UINT                              Slot,
+    const Rc<DxvkSampler>&                  Binding) {
+    ctx->bindResourceSampler(Stage, Slot, Binding);
+  }
+
+
+  static void ApplyBinding(
+          DxvkContext*                      ctx,
+          VkShaderStageFlagBits             Stage,
+          UINT                              Slot,
+    const D3D11ViewBinding&                 Binding) {
+    ctx->bindResourceView(Stage, Slot, Binding.imageView, Binding.bufferView);
+  }
+
+
   D3D11DeviceContext::D3D11DeviceContext(
           D3D11Device*            pParent,
     const Rc<DxvkDevice>&         Device,
@@ -22,7 +63,8 @@ namespace dxvk {
     m_annotation(this),
     m_csFlags   (CsFlags),
     m_csChunk   (AllocCsChunk()),
-    m_cmdData   (nullptr) {
+    m_cmdData   (nullptr),
+    m_dirtyStages(0) {
 
   }
   
@@ -257,6 +299,11 @@ namespace dxvk {
     m_state.pr.predicateObject = nullptr;
     m_state.pr.predicateValue  = FALSE;
     
+    // All bindings get reset below, so pending
+    // binding updates would only re-apply null
+    m_dirtyBindings = { };
+    m_dirtyStages   = 0;
+    
     // Make sure to apply all state
     ResetState();
   }
@@ -1143,6 +1190,7 @@ namespace dxvk {
   
   void STDMETHODCALLTYPE D3D11DeviceContext::DrawAuto() {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyGraphicsBindings();
 
     D3D11Buffer* buffer = m_state.ia.vertexBuffers[0].buffer.ptr();
 
@@ -1167,6 +1215,7 @@ namespace dxvk {
           UINT            VertexCount,
           UINT            StartVertexLocation) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyGraphicsBindings();
 
     EmitCs([=] (DxvkContext* ctx) {
       ctx->draw(
@@ -1181,6 +1230,7 @@ namespace dxvk {
           UINT            StartIndexLocation,
           INT             BaseVertexLocation) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyGraphicsBindings();
     
     EmitCs([=] (DxvkContext* ctx) {
       ctx->drawIndexed(
@@ -1197,6 +1247,7 @@ namespace dxvk {
           UINT            StartVertexLocation,
           UINT            StartInstanceLocation) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyGraphicsBindings();
     
     EmitCs([=] (DxvkContext* ctx) {
       ctx->draw(
@@ -1215,6 +1266,7 @@ namespace dxvk {
           INT             BaseVertexLocation,
           UINT            StartInstanceLocation) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyGraphicsBindings();
     
     EmitCs([=] (DxvkContext* ctx) {
       ctx->drawIndexed(
@@ -1231,6 +1283,7 @@ namespace dxvk {
           ID3D11Buffer*   pBufferForArgs,
           UINT            AlignedByteOffsetForArgs) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyGraphicsBindings();
     SetDrawBuffers(pBufferForArgs, nullptr);
 
     if (!ValidateDrawBufferSize(pBufferForArgs, AlignedByteOffsetForArgs, sizeof(VkDrawIndexedIndirectCommand)))
@@ -1265,6 +1318,7 @@ namespace dxvk {
           ID3D11Buffer*   pBufferForArgs,
           UINT            AlignedByteOffsetForArgs) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyGraphicsBindings();
     SetDrawBuffers(pBufferForArgs, nullptr);
 
     if (!ValidateDrawBufferSize(pBufferForArgs, AlignedByteOffsetForArgs, sizeof(VkDrawIndirectCommand)))
@@ -1300,6 +1354,7 @@ namespace dxvk {
           UINT            ThreadGroupCountY,
           UINT            ThreadGroupCountZ) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyComputeBindings();
     
     EmitCs([=] (DxvkContext* ctx) {
       ctx->dispatch(
@@ -1314,6 +1369,7 @@ namespace dxvk {
           ID3D11Buffer*   pBufferForArgs,
           UINT            AlignedByteOffsetForArgs) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyComputeBindings();
     SetDrawBuffers(pBufferForArgs, nullptr);
     
     if (!ValidateDrawBufferSize(pBufferForArgs, AlignedByteOffsetForArgs, sizeof(VkDispatchIndirectCommand)))
@@ -3141,23 +3197,25 @@ namespace dxvk {
   template<DxbcProgramType ShaderStage>
   void D3D11DeviceContext::BindShader(
     const D3D11CommonShader*    pShaderModule) {
-    // Bind the shader and the ICB at once
+    // Bind the shader and the ICB at once. If shader compilation
+    // is deferred, this will wait for the shader on the CS thread
+    // rather than stalling the application thread.
     EmitCs([
-      cSlice  = pShaderModule           != nullptr
-             && pShaderModule->GetIcb() != nullptr
-        ? DxvkBufferSlice(pShaderModule->GetIcb())
-        : DxvkBufferSlice(),
       cShader = pShaderModule != nullptr
-        ? pShaderModule->GetShader()
-        : nullptr
+        ? *pShaderModule
+        : D3D11CommonShader()
     ] (DxvkContext* ctx) {
       VkShaderStageFlagBits stage = GetShaderStage(ShaderStage);
 
       uint32_t slotId = computeConstantBufferBinding(ShaderStage,
         D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT);
 
-      ctx->bindShader        (stage, cShader);
-      ctx->bindResourceBuffer(stage, slotId, cSlice);
+      Rc<DxvkBuffer> icb = cShader.GetIcb();
+
+      ctx->bindShader        (stage, cShader.GetShader());
+      ctx->bindResourceBuffer(stage, slotId, icb != nullptr
+        ? DxvkBufferSlice(icb)
+        : DxvkBufferSlice());
     });
   }
 
@@ -3283,64 +3341,123 @@ namespace dxvk {
   }
 
 
-  template<DxbcProgramType ShaderStage>
-  void D3D11DeviceContext::BindConstantBuffer(
-          UINT                              Slot,
-          D3D11Buffer*                      pBuffer,
-          UINT                              Offset,
-          UINT                              Length) {
-    EmitCs([
-      cSlotId      = Slot,
-      cBufferSlice = pBuffer ? pBuffer->GetBufferSlice(16 * Offset, 16 * Length) : DxvkBufferSlice()
-    ] (DxvkContext* ctx) {
-      VkShaderStageFlagBits stage = GetShaderStage(ShaderStage);
-      ctx->bindResourceBuffer(stage, cSlotId, cBufferSlice);
-    });
+  void D3D11DeviceContext::ApplyDirtyGraphicsBindings() {
+    constexpr uint32_t graphicsStages = ~(1u << uint32_t(DxbcProgramType::ComputeShader));
+
+    if (likely(!(m_dirtyStages & graphicsStages)))
+      return;
+
+    ApplyDirtyBindings<DxbcProgramType::VertexShader>   (m_state.vs.constantBuffers, m_state.vs.samplers, m_state.vs.shaderResources);
+    ApplyDirtyBindings<DxbcProgramType::HullShader>     (m_state.hs.constantBuffers, m_state.hs.samplers, m_state.hs.shaderResources);
+    ApplyDirtyBindings<DxbcProgramType::DomainShader>   (m_state.ds.constantBuffers, m_state.ds.samplers, m_state.ds.shaderResources);
+    ApplyDirtyBindings<DxbcProgramType::GeometryShader> (m_state.gs.constantBuffers, m_state.gs.samplers, m_state.gs.shaderResources);
+    ApplyDirtyBindings<DxbcProgramType::PixelShader>    (m_state.ps.constantBuffers, m_state.ps.samplers, m_state.ps.shaderResources);
   }
-  
-  
-  template<DxbcProgramType ShaderStage>
-  void D3D11DeviceContext::BindConstantBufferRange(
-          UINT                              Slot,
-          UINT                              Offset,
-          UINT                              Length) {
-    EmitCs([
-      cSlotId       = Slot,
-      cOffset       = 16 * Offset,
-      cLength       = 16 * Length
-    ] (DxvkContext* ctx) {
-      VkShaderStageFlagBits stage = GetShaderStage(ShaderStage);
-      ctx->bindResourceBufferRange(stage, cSlotId, cOffset, cLength);
-    });
+
+
+  void D3D11DeviceContext::ApplyDirtyComputeBindings() {
+    ApplyDirtyBindings<DxbcProgramType::ComputeShader>  (m_state.cs.constantBuffers, m_state.cs.samplers, m_state.cs.shaderResources);
   }
 
 
   template<DxbcProgramType ShaderStage>
-  void D3D11DeviceContext::BindSampler(
-          UINT                              Slot,
-          D3D11SamplerState*                pSampler) {
-    EmitCs([
-      cSlotId   = Slot,
-      cSampler  = pSampler != nullptr ? pSampler->GetDXVKSampler() : nullptr
-    ] (DxvkContext* ctx) {
-      VkShaderStageFlagBits stage = GetShaderStage(ShaderStage);
-      ctx->bindResourceSampler(stage, cSlotId, cSampler);
-    });
+  void D3D11DeviceContext::ApplyDirtyBindings(
+    const D3D11ConstantBufferBindings&      ConstantBuffers,
+    const D3D11SamplerBindings&             Samplers,
+    const D3D11ShaderResourceBindings&      ShaderResources) {
+    const uint32_t stageBit = 1u << uint32_t(ShaderStage);
+
+    if (likely(!(m_dirtyStages & stageBit)))
+      return;
+
+    m_dirtyStages &= ~stageBit;
+
+    auto& dirty = m_dirtyBindings[uint32_t(ShaderStage)];
+
+    std::array<UINT, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> slots;
+    UINT count;
+
+    count = GatherDirtySlots(dirty.constantBuffers, slots.data());
+
+    EmitBindings<ShaderStage, DxvkBufferSlice>(
+      computeConstantBufferBinding(ShaderStage, 0), count, slots.data(),
+      [&ConstantBuffers] (UINT Slot) {
+        const auto& binding = ConstantBuffers[Slot];
+
+        return binding.buffer != nullptr
+          ? binding.buffer->GetBufferSlice(16 * binding.constantOffset, 16 * binding.constantBound)
+          : DxvkBufferSlice();
+      });
+
+    count = GatherDirtySlots(dirty.samplers, slots.data());
+
+    EmitBindings<ShaderStage, Rc<DxvkSampler>>(
+      computeSamplerBinding(ShaderStage, 0), count, slots.data(),
+      [&Samplers] (UINT Slot) {
+        return Samplers[Slot] != nullptr
+          ? Samplers[Slot]->GetDXVKSampler()
+          : nullptr;
+      });
+
+    count = GatherDirtySlots(dirty.shaderResources, slots.data());
+
+    EmitBindings<ShaderStage, D3D11ViewBinding>(
+      computeSrvBinding(ShaderStage, 0), count, slots.data(),
+      [&ShaderResources] (UINT Slot) {
+        D3D11ViewBinding binding;
+
+        if (auto view = ShaderResources.views[Slot].ptr()) {
+          binding.imageView  = view->GetImageView();
+          binding.bufferView = view->GetBufferView();
+        }
+
+        return binding;
+      });
   }
-  
-  
-  template<DxbcProgramType ShaderStage>
-  void D3D11DeviceContext::BindShaderResource(
-          UINT                              Slot,
-          D3D11ShaderResourceView*          pResource) {
+
+
+  template<DxbcProgramType ShaderStage, typename T, typename Fn>
+  void D3D11DeviceContext::EmitBindings(
+          UINT                              BaseSlot,
+          UINT                              Count,
+    const UINT*                             pSlots,
+          Fn&&                              GetBinding) {
+    // Use small commands for small updates so that
+    // we don't waste CS chunk memory on empty slots
+    for (uint32_t i = 0; i < Count; ) {
+      i += (Count - i > 4)
+        ? EmitBindingBatch<ShaderStage, T, 16>(BaseSlot, Count - i, &pSlots[i], GetBinding)
+        : EmitBindingBatch<ShaderStage, T,  4>(BaseSlot, Count - i, &pSlots[i], GetBinding);
+    }
+  }
+
+
+  template<DxbcProgramType ShaderStage, typename T, uint32_t N, typename Fn>
+  UINT D3D11DeviceContext::EmitBindingBatch(
+          UINT                              BaseSlot,
+          UINT                              Count,
+    const UINT*                             pSlots,
+          Fn&                               GetBinding) {
+    D3D11BindingBatch<T, N> batch;
+    batch.count = std::min(Count, N);
+
+    for (uint32_t i = 0; i < batch.count; i++) {
+      batch.slots[i]    = BaseSlot + pSlots[i];
+      batch.bindings[i] = GetBinding(pSlots[i]);
+    }
+
+    UINT count = batch.count;
+
     EmitCs([
-      cSlotId     = Slot,
-      cImageView  = pResource != nullptr ? pResource->GetImageView()  : nullptr,
-      cBufferView = pResource != nullptr ? pResource->GetBufferView() : nullptr
+      cBatch = std::move(batch)
     ] (DxvkContext* ctx) {
       VkShaderStageFlagBits stage = GetShaderStage(ShaderStage);
-      ctx->bindResourceView(stage, cSlotId, cImageView, cBufferView);
+
+      for (uint32_t i = 0; i < cBatch.count; i++)
+        ApplyBinding(ctx, stage, cBatch.slots[i], cBatch.bindings[i]);
     });
+
+    return count;
   }
   
   
@@ -3911,8 +4028,6 @@ namespace dxvk {
           UINT                              StartSlot,
           UINT                              NumBuffers,
           ID3D11Buffer* const*              ppConstantBuffers) {
-    uint32_t slotId = computeConstantBufferBinding(ShaderStage, StartSlot);
-    
     for (uint32_t i = 0; i < NumBuffers; i++) {
       auto newBuffer = static_cast<D3D11Buffer*>(ppConstantBuffers[i]);
       
@@ -3928,7 +4043,7 @@ namespace dxvk {
         Bindings[StartSlot + i].constantCount  = constantCount;
         Bindings[StartSlot + i].constantBound  = constantCount;
         
-        BindConstantBuffer<ShaderStage>(slotId + i, newBuffer, 0, constantCount);
+        DirtyBindings<ShaderStage>().constantBuffers.set(StartSlot + i);
       }
     }
   }
@@ -3942,8 +4057,6 @@ namespace dxvk {
           ID3D11Buffer* const*              ppConstantBuffers,
     const UINT*                             pFirstConstant,
     const UINT*                             pNumConstants) {
-    uint32_t slotId = computeConstantBufferBinding(ShaderStage, StartSlot);
-    
     for (uint32_t i = 0; i < NumBuffers; i++) {
       auto newBuffer = static_cast<D3D11Buffer*>(ppConstantBuffers[i]);
       
@@ -3991,14 +4104,14 @@ namespace dxvk {
         Bindings[StartSlot + i].constantCount  = constantCount;
         Bindings[StartSlot + i].constantBound  = constantBound;
 
-        BindConstantBuffer<ShaderStage>(slotId + i, newBuffer, constantOffset, constantBound);
+        DirtyBindings<ShaderStage>().constantBuffers.set(StartSlot + i);
       } else if (Bindings[StartSlot + i].constantOffset != constantOffset
               || Bindings[StartSlot + i].constantCount  != constantCount) {
         Bindings[StartSlot + i].constantOffset = constantOffset;
         Bindings[StartSlot + i].constantCount  = constantCount;
         Bindings[StartSlot + i].constantBound  = constantBound;
 
-        BindConstantBufferRange<ShaderStage>(slotId + i, constantOffset, constantBound);
+        DirtyBindings<ShaderStage>().constantBuffers.set(StartSlot + i);
       }
     }
   }
@@ -4010,14 +4123,12 @@ namespace dxvk {
           UINT                              StartSlot,
           UINT                              NumSamplers,
           ID3D11SamplerState* const*        ppSamplers) {
-    uint32_t slotId = computeSamplerBinding(ShaderStage, StartSlot);
-    
     for (uint32_t i = 0; i < NumSamplers; i++) {
       auto sampler = static_cast<D3D11SamplerState*>(ppSamplers[i]);
       
       if (Bindings[StartSlot + i] != sampler) {
         Bindings[StartSlot + i] = sampler;
-        BindSampler<ShaderStage>(slotId + i, sampler);
+        DirtyBindings<ShaderStage>().samplers.set(StartSlot + i);
       }
     }
   }
@@ -4029,8 +4140,6 @@ namespace dxvk {
           UINT                              StartSlot,
           UINT                              NumResources,
           ID3D11ShaderResourceView* const*  ppResources) {
-    uint32_t slotId = computeSrvBinding(ShaderStage, StartSlot);
-    
     for (uint32_t i = 0; i < NumResources; i++) {
       auto resView = static_cast<D3D11ShaderResourceView*>(ppResources[i]);
       
@@ -4046,7 +4155,7 @@ namespace dxvk {
         }
 
         Bindings.views[StartSlot + i] = resView;
-        BindShaderResource<ShaderStage>(slotId + i, resView);
+        DirtyBindings<ShaderStage>().shaderResources.set(StartSlot + i);
       }
     }
   }
@@ -4215,24 +4324,13 @@ namespace dxvk {
 
 
   void D3D11DeviceContext::RestoreState() {
-    BindFramebuffer();
-    
-    BindShader<DxbcProgramType::VertexShader>   (GetCommonShader(m_state.vs.shader.ptr()));
-    BindShader<DxbcProgramType::HullShader>     (GetCommonShader(m_state.hs.shader.ptr()));
-    BindShader<DxbcProgramType::DomainShader>   (GetCommonShader(m_state.ds.shader.ptr()));
-    BindShader<DxbcProgramType::GeometryShader> (GetCommonShader(m_state.gs.shader.ptr()));
-    BindShader<DxbcProgramType::PixelShader>    (GetCommonShader(m_state.ps.shader.ptr()));
+    RestoreGraphicsPipelineState();
+
     BindShader<DxbcProgramType::ComputeShader>  (GetCommonShader(m_state.cs.shader.ptr()));
     
-    ApplyInputLayout();
-    ApplyPrimitiveTopology();
-    ApplyBlendState();
     ApplyBlendFactor();
-    ApplyDepthStencilState();
     ApplyStencilRef();
-    ApplyRasterizerState();
     ApplyRasterizerSampleCount();
-    ApplyViewportState();
 
     BindDrawBuffers(
       m_state.id.argBuffer.ptr(),
@@ -4279,35 +4377,42 @@ namespace dxvk {
   }
   
   
+  void D3D11DeviceContext::RestoreGraphicsPipelineState() {
+    BindFramebuffer();
+
+    BindShader<DxbcProgramType::VertexShader>   (GetCommonShader(m_state.vs.shader.ptr()));
+    BindShader<DxbcProgramType::HullShader>     (GetCommonShader(m_state.hs.shader.ptr()));
+    BindShader<DxbcProgramType::DomainShader>   (GetCommonShader(m_state.ds.shader.ptr()));
+    BindShader<DxbcProgramType::GeometryShader> (GetCommonShader(m_state.gs.shader.ptr()));
+    BindShader<DxbcProgramType::PixelShader>    (GetCommonShader(m_state.ps.shader.ptr()));
+
+    ApplyInputLayout();
+    ApplyPrimitiveTopology();
+    ApplyBlendState();
+    ApplyDepthStencilState();
+    ApplyRasterizerState();
+    ApplyViewportState();
+  }
+
+
   template<DxbcProgramType Stage>
   void D3D11DeviceContext::RestoreConstantBuffers(
           D3D11ConstantBufferBindings&      Bindings) {
-    uint32_t slotId = computeConstantBufferBinding(Stage, 0);
-    
-    for (uint32_t i = 0; i < Bindings.size(); i++) {
-      BindConstantBuffer<Stage>(slotId + i, Bindings[i].buffer.ptr(),
-        Bindings[i].constantOffset, Bindings[i].constantBound);
-    }
+    DirtyBindings<Stage>().constantBuffers.setRange(0, Bindings.size());
   }
   
   
   template<DxbcProgramType Stage>
   void D3D11DeviceContext::RestoreSamplers(
           D3D11SamplerBindings&             Bindings) {
-    uint32_t slotId = computeSamplerBinding(Stage, 0);
-    
-    for (uint32_t i = 0; i < Bindings.size(); i++)
-      BindSampler<Stage>(slotId + i, Bindings[i]);
+    DirtyBindings<Stage>().samplers.setRange(0, Bindings.size());
   }
   
   
   template<DxbcProgramType Stage>
   void D3D11DeviceContext::RestoreShaderResources(
           D3D11ShaderResourceBindings&      Bindings) {
-    uint32_t slotId = computeSrvBinding(Stage, 0);
-    
-    for (uint32_t i = 0; i < Bindings.views.size(); i++)
-      BindShaderResource<Stage>(slotId + i, Bindings.views[i].ptr());
+    DirtyBindings<Stage>().shaderResources.setRange(0, Bindings.views.size());
   }
   
   
@@ -4399,7 +4504,6 @@ namespace dxvk {
   void D3D11DeviceContext::ResolveSrvHazards(
           T*                                pView,
           D3D11ShaderResourceBindings&      Bindings) {
-    uint32_t slotId = computeSrvBinding(ShaderStage, 0);
     int32_t srvId = Bindings.hazardous.findNext(0);
 
     while (srvId >= 0) {
@@ -4412,7 +4516,7 @@ namespace dxvk {
           Bindings.views[srvId] = nullptr;
           Bindings.hazardous.clr(srvId);
 
-          BindShaderResource<ShaderStage>(slotId + srvId, nullptr);
+          DirtyBindings<ShaderStage>().shaderResources.set(srvId);
         }
       } else {
         // Avoid further redundant iterations
@@ -708,6 +708,9 @@ namespace dxvk {
     
     D3D11ContextState           m_state;
     D3D11CmdData*               m_cmdData;
+
+    std::array<D3D11DirtyBindings, 6> m_dirtyBindings;
+    uint32_t                    m_dirtyStages;
     
     void ApplyInputLayout();
     
@@ -753,28 +756,29 @@ namespace dxvk {
             D3D11Buffer*                      pBuffer,
             UINT                              Offset);
     
-    template<DxbcProgramType ShaderStage>
-    void BindConstantBuffer(
-            UINT                              Slot,
-            D3D11Buffer*                      pBuffer,
-            UINT                              Offset,
-            UINT                              Length);
-    
-    template<DxbcProgramType ShaderStage>
-    void BindConstantBufferRange(
-            UINT                              Slot,
-            UINT                              Offset,
-            UINT                              Length);
+    void ApplyDirtyGraphicsBindings();
+
+    void ApplyDirtyComputeBindings();
 
     template<DxbcProgramType ShaderStage>
-    void BindSampler(
-            UINT                              Slot,
-            D3D11SamplerState*                pSampler);
-    
-    template<DxbcProgramType ShaderStage>
-    void BindShaderResource(
-            UINT                              Slot,
-            D3D11ShaderResourceView*          pResource);
+    void ApplyDirtyBindings(
+      const D3D11ConstantBufferBindings&      ConstantBuffers,
+      const D3D11SamplerBindings&             Samplers,
+      const D3D11ShaderResourceBindings&      ShaderResources);
+
+    template<DxbcProgramType ShaderStage, typename T, typename Fn>
+    void EmitBindings(
+            UINT                              BaseSlot,
+            UINT                              Count,
+      const UINT*                             pSlots,
+            Fn&&                              GetBinding);
+
+    template<DxbcProgramType ShaderStage, typename T, uint32_t N, typename Fn>
+    UINT EmitBindingBatch(
+            UINT                              BaseSlot,
+            UINT                              Count,
+      const UINT*                             pSlots,
+            Fn&                               GetBinding);
     
     template<DxbcProgramType ShaderStage>
     void BindUnorderedAccessView(
@@ -856,6 +860,11 @@ namespace dxvk {
             pContext->UpdateMappedBuffer(bufferResource, offset, length, pSrcData, CopyFlags);
             return;
           }
+
+          // Partial updates can go straight to mapped memory if the
+          // buffer is not in use, which skips the GPU copy entirely
+          if (pContext->UpdateIdleBuffer(bufferResource, offset, length, pSrcData))
+            return;
         }
 
         // Otherwise we can't really do anything fancy, so just do a GPU copy
@@ -946,6 +955,8 @@ namespace dxvk {
     void ResetState();
 
     void RestoreState();
+
+    void RestoreGraphicsPipelineState();
     
     template<DxbcProgramType Stage>
     void RestoreConstantBuffers(
@@ -1047,6 +1058,12 @@ namespace dxvk {
       return bufferSize >= Offset + Size;
     }
     
+    template<DxbcProgramType ShaderStage>
+    D3D11DirtyBindings& DirtyBindings() {
+      m_dirtyStages |= 1u << uint32_t(ShaderStage);
+      return m_dirtyBindings[uint32_t(ShaderStage)];
+    }
+    
     template<typename Cmd>
     void EmitCs(Cmd&& command) {
       m_cmdData = nullptr;
@@ -381,6 +381,17 @@ namespace dxvk {
   }
 
 
+  bool D3D11DeferredContext::UpdateIdleBuffer(
+          D3D11Buffer*                  pDstBuffer,
+          UINT                          Offset,
+          UINT                          Length,
+    const void*                         pSrcData) {
+    // The update must be ordered with the rest of the
+    // command list, so we always need to emit a copy
+    return false;
+  }
+
+
   void D3D11DeferredContext::FinalizeQueries() {
     for (auto& query : m_queriesBegun) {
       m_commandList->AddQuery(query.ptr());
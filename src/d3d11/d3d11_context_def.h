@@ -133,6 +133,12 @@ namespace dxvk {
       const void*                         pSrcData,
             UINT                          CopyFlags);
 
+    bool UpdateIdleBuffer(
+            D3D11Buffer*                  pDstBuffer,
+            UINT                          Offset,
+            UINT                          Length,
+      const void*                         pSrcData);
+
     void FinalizeQueries();
 
     Com<D3D11CommandList> CreateCommandList();
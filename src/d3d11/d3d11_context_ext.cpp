@@ -40,6 +40,7 @@ namespace dxvk {
           UINT                    ByteOffsetForArgs,
           UINT                    ByteStrideForArgs) {
     D3D10DeviceLock lock = m_ctx->LockContext();
+    m_ctx->ApplyDirtyGraphicsBindings();
     m_ctx->SetDrawBuffers(pBufferForArgs, nullptr);
     
     m_ctx->EmitCs([
@@ -58,6 +59,7 @@ namespace dxvk {
           UINT                    ByteOffsetForArgs,
           UINT                    ByteStrideForArgs) {
     D3D10DeviceLock lock = m_ctx->LockContext();
+    m_ctx->ApplyDirtyGraphicsBindings();
     m_ctx->SetDrawBuffers(pBufferForArgs, nullptr);
     
     m_ctx->EmitCs([
@@ -78,6 +80,7 @@ namespace dxvk {
           UINT                    ByteOffsetForArgs,
           UINT                    ByteStrideForArgs) {
     D3D10DeviceLock lock = m_ctx->LockContext();
+    m_ctx->ApplyDirtyGraphicsBindings();
     m_ctx->SetDrawBuffers(pBufferForArgs, pBufferForCount);
 
     m_ctx->EmitCs([
@@ -99,6 +102,7 @@ namespace dxvk {
           UINT                    ByteOffsetForArgs,
           UINT                    ByteStrideForArgs) {
     D3D10DeviceLock lock = m_ctx->LockContext();
+    m_ctx->ApplyDirtyGraphicsBindings();
     m_ctx->SetDrawBuffers(pBufferForArgs, pBufferForCount);
 
     m_ctx->EmitCs([
@@ -3,10 +3,6 @@
 #include "d3d11_device.h"
 #include "d3d11_texture.h"
 
-constexpr static uint32_t MinFlushIntervalUs = 750;
-constexpr static uint32_t IncFlushIntervalUs = 250;
-constexpr static uint32_t MaxPendingSubmits  = 6;
-
 namespace dxvk {
   
   D3D11ImmediateContext::D3D11ImmediateContext(
@@ -15,6 +11,7 @@ namespace dxvk {
   : D3D11DeviceContext(pParent, Device, DxvkCsChunkFlag::SingleUse),
     m_csThread(Device, Device->createContext(DxvkContextType::Primary)),
     m_maxImplicitDiscardSize(pParent->GetOptions()->maxImplicitDiscardSize),
+    m_flushTracker(Device),
     m_videoContext(this, Device) {
     EmitCs([
       cDevice                 = m_device,
@@ -181,7 +178,7 @@ namespace dxvk {
       FlushCsChunk();
       
       // Reset flush timer used for implicit flushes
-      m_lastFlush = dxvk::high_resolution_clock::now();
+      m_flushTracker.notifyFlush();
       m_csIsBusy  = false;
     }
   }
@@ -481,19 +478,44 @@ namespace dxvk {
     void* mapPtr;
 
     if (mapMode == D3D11_COMMON_TEXTURE_MAP_MODE_DIRECT) {
-      // Wait for the resource to become available. We do not
-      // support image renaming, so stall on DISCARD instead.
-      if (MapType == D3D11_MAP_WRITE_DISCARD)
-        MapFlags &= ~D3D11_MAP_FLAG_DO_NOT_WAIT;
+      bool doDiscard = false;
 
-      if (MapType != D3D11_MAP_WRITE_NO_OVERWRITE) {
-        if (!WaitForResource(mappedImage, sequenceNumber, MapType, MapFlags))
-          return DXGI_ERROR_WAS_STILL_DRAWING;
+      if (MapType == D3D11_MAP_WRITE_DISCARD && pResource->CanDiscardImage()) {
+        // If the image may still be in use, swap in a backing image
+        // that the GPU is done with instead of waiting for the GPU.
+        uint64_t imageSeq = sequenceNumber != DxvkCsThread::SynchronizeAll
+          ? sequenceNumber : GetCurrentSequenceNumber();
+
+        doDiscard = m_csThread.lastSequenceNumber() < imageSeq
+                 || mappedImage->isInUse(DxvkAccess::Read);
+      }
+
+      if (doDiscard) {
+        VkImageLayout layout;
+        DxvkPhysicalImage physImage = pResource->DiscardImage(&layout);
+
+        EmitCs([
+          cImage      = mappedImage,
+          cPhysImage  = std::move(physImage),
+          cLayout     = layout
+        ] (DxvkContext* ctx) mutable {
+          ctx->invalidateImage(cImage, std::move(cPhysImage), cLayout);
+        });
+      } else {
+        // Wait for the resource to become available. Images that
+        // cannot be renamed will stall on DISCARD instead.
+        if (MapType == D3D11_MAP_WRITE_DISCARD)
+          MapFlags &= ~D3D11_MAP_FLAG_DO_NOT_WAIT;
+
+        if (MapType != D3D11_MAP_WRITE_NO_OVERWRITE) {
+          if (!WaitForResource(mappedImage, sequenceNumber, MapType, MapFlags))
+            return DXGI_ERROR_WAS_STILL_DRAWING;
+        }
       }
       
-      // Query the subresource's memory layout and hope that
+      // Use the cached subresource memory layout and hope that
       // the application respects the returned pitch values.
-      mapPtr = mappedImage->mapPtr(0);
+      mapPtr = pResource->GetMapPtr();
     } else {
       constexpr uint32_t DoInvalidate = (1u << 0);
       constexpr uint32_t DoPreserve   = (1u << 1);
@@ -644,6 +666,29 @@ namespace dxvk {
   }
 
 
+  bool D3D11ImmediateContext::UpdateIdleBuffer(
+          D3D11Buffer*                  pDstBuffer,
+          UINT                          Offset,
+          UINT                          Length,
+    const void*                         pSrcData) {
+    // Buffers that can be bound to the pipeline do not track
+    // sequence numbers, so for those we require that the CS
+    // thread has processed all commands recorded so far.
+    uint64_t sequenceNumber = pDstBuffer->GetSequenceNumber();
+
+    if (sequenceNumber == DxvkCsThread::SynchronizeAll)
+      sequenceNumber = GetCurrentSequenceNumber();
+
+    if (m_csThread.lastSequenceNumber() < sequenceNumber
+     || pDstBuffer->GetBuffer()->isInUse(DxvkAccess::Read))
+      return false;
+
+    DxvkBufferSliceHandle slice = pDstBuffer->GetMappedSlice();
+    std::memcpy(reinterpret_cast<char*>(slice.mapPtr) + Offset, pSrcData, Length);
+    return true;
+  }
+
+
   void STDMETHODCALLTYPE D3D11ImmediateContext::SwapDeviceContextState(
           ID3DDeviceContextState*           pState,
           ID3DDeviceContextState**          ppPreviousState) {
@@ -771,20 +816,10 @@ namespace dxvk {
 
 
   void D3D11ImmediateContext::FlushImplicit(BOOL StrongHint) {
-    // Flush only if the GPU is about to go idle, in
-    // order to keep the number of submissions low.
-    uint32_t pending = m_device->pendingSubmissions();
-
-    if (StrongHint || pending <= MaxPendingSubmits) {
-      auto now = dxvk::high_resolution_clock::now();
+    uint64_t csQueueDepth = m_csSeqNum - m_csThread.lastSequenceNumber();
 
-      uint32_t delay = MinFlushIntervalUs
-                     + IncFlushIntervalUs * pending;
-
-      // Prevent flushing too often in short intervals.
-      if (now - m_lastFlush >= std::chrono::microseconds(delay))
-        Flush();
-    }
+    if (m_flushTracker.considerFlush(StrongHint, csQueueDepth))
+      Flush();
   }
 
 
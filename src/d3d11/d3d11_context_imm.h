@@ -4,6 +4,8 @@
 
 #include "../util/sync/sync_signal.h"
 
+#include "../dxvk/dxvk_flush.h"
+
 #include "d3d11_context.h"
 #include "d3d11_state_object.h"
 #include "d3d11_video.h"
@@ -127,8 +129,7 @@ namespace dxvk {
 
     VkDeviceSize            m_maxImplicitDiscardSize = 0ull;
 
-    dxvk::high_resolution_clock::time_point m_lastFlush
-      = dxvk::high_resolution_clock::now();
+    DxvkFlushTracker        m_flushTracker;
     
     D3D11VideoContext            m_videoContext;
     Com<D3D11DeviceContextState> m_stateObject;
@@ -157,6 +158,12 @@ namespace dxvk {
       const void*                         pSrcData,
             UINT                          CopyFlags);
 
+    bool UpdateIdleBuffer(
+            D3D11Buffer*                  pDstBuffer,
+            UINT                          Offset,
+            UINT                          Length,
+      const void*                         pSrcData);
+
     void SynchronizeDevice();
 
     void EndFrame();
@@ -92,6 +92,22 @@ namespace dxvk {
   };
   
   
+  /**
+   * \brief Pending resource bindings
+   *
+   * Tracks constant buffer, sampler and shader resource
+   * slots of a shader stage that have changed since they
+   * were last applied to the DXVK context. This is not
+   * part of the API state, bindings are flushed right
+   * before the next draw or dispatch.
+   */
+  struct D3D11DirtyBindings {
+    DxvkBindingSet<D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> constantBuffers = { };
+    DxvkBindingSet<D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT>             samplers        = { };
+    DxvkBindingSet<D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT>      shaderResources = { };
+  };
+  
+  
   struct D3D11VertexBufferBinding {
     Com<D3D11Buffer> buffer = nullptr;
     UINT             offset = 0;
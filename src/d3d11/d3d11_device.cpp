@@ -2018,15 +2018,10 @@ namespace dxvk {
     if (FAILED(hr))
       return hr;
 
-    auto shader = commonShader.GetShader();
-
-    if (shader->flags().test(DxvkShaderFlag::ExportsStencilRef)
-     && !m_dxvkDevice->extensions().extShaderStencilExport)
-      return E_INVALIDARG;
-
-    if (shader->flags().test(DxvkShaderFlag::ExportsViewportIndexLayerFromVertexStage)
-     && (!m_dxvkDevice->features().vk12.shaderOutputViewportIndex
-      || !m_dxvkDevice->features().vk12.shaderOutputLayer))
+    // Shaders that failed to compile or use unsupported features
+    // are cached as well. If compilation is deferred, errors can
+    // only be reported once the shader is bound.
+    if (!commonShader.IsDeferred() && commonShader.GetShader() == nullptr)
       return E_INVALIDARG;
 
     *pShaderModule = std::move(commonShader);
@@ -2379,10 +2374,10 @@ namespace dxvk {
     D3D11_MAPPED_SUBRESOURCE subresourceData = { };
 
     if (texture->GetMapMode() == D3D11_COMMON_TEXTURE_MAP_MODE_DIRECT) {
-      VkSubresourceLayout layout = image->querySubresourceLayout(subresource);
-      subresourceData.pData      = image->mapPtr(layout.offset);
-      subresourceData.RowPitch   = layout.rowPitch;
-      subresourceData.DepthPitch = layout.depthPitch;
+      auto layout = texture->GetSubresourceLayout(subresource.aspectMask, Subresource);
+      subresourceData.pData      = reinterpret_cast<char*>(texture->GetMapPtr()) + layout.Offset;
+      subresourceData.RowPitch   = layout.RowPitch;
+      subresourceData.DepthPitch = layout.DepthPitch;
     } else {
       subresourceData.pData      = texture->GetMappedBuffer(Subresource)->mapPtr(0);
       subresourceData.RowPitch   = formatInfo->elementSize * extent.width;
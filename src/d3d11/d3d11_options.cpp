@@ -16,6 +16,8 @@ namespace dxvk {
     this->invariantPosition     = config.getOption<bool>("d3d11.invariantPosition", true);
     this->floatControls         = config.getOption<bool>("d3d11.floatControls", true);
     this->disableMsaa           = config.getOption<bool>("d3d11.disableMsaa", false);
+    this->deferShaderCompilation = config.getOption<bool>("d3d11.deferShaderCompilation", false);
+    this->promoteShaderRegisters = config.getOption<bool>("d3d11.promoteShaderRegisters", false);
     this->deferSurfaceCreation  = config.getOption<bool>("dxgi.deferSurfaceCreation", false);
     this->numBackBuffers        = config.getOption<int32_t>("dxgi.numBackBuffers", 0);
     this->maxFrameLatency       = config.getOption<int32_t>("dxgi.maxFrameLatency", 0);
@@ -33,6 +35,8 @@ namespace dxvk {
       ? VkDeviceSize(maxDynamicImageBufferSize) << 10
       : VkDeviceSize(~0ull);
 
+    this->renameDynamicImages = config.getOption<Tristate>("d3d11.renameDynamicImages", Tristate::False);
+
     auto cachedDynamicResources = config.getOption<std::string>("d3d11.cachedDynamicResources", std::string());
 
     if (::GetModuleHandle("dxgitrace.dll")) {
@@ -93,6 +93,9 @@ namespace dxvk {
     /// Limit size of buffer-mapped images
     VkDeviceSize maxDynamicImageBufferSize;
 
+    /// Map dynamic images directly and rename them on discard
+    Tristate renameDynamicImages;
+
     /// Defer surface creation until first present call. This
     /// fixes issues with games that create multiple swap chains
     /// for a single window that may interfere with each other.
@@ -102,6 +105,15 @@ namespace dxvk {
     /// performs the required shader and resolve fixups.
     bool disableMsaa;
 
+    /// Compile shaders on worker threads instead of the
+    /// thread that creates them. The application thread
+    /// will only wait for the shader if it gets used.
+    bool deferShaderCompilation;
+
+    /// Emit single-assignment temps as SSA values and split
+    /// indexable temps with constant indices into variables
+    bool promoteShaderRegisters;
+
     /// Dynamic resources with the given bind flags will be allocated
     /// in cached system memory. Enabled automatically when recording
     /// an api trace.
@@ -2,84 +2,153 @@
 #include "d3d11_shader.h"
 
 namespace dxvk {
-  
-  D3D11CommonShader:: D3D11CommonShader() { }
-  D3D11CommonShader::~D3D11CommonShader() { }
-  
-  
-  D3D11CommonShader::D3D11CommonShader(
+
+  D3D11ShaderCompileJob::D3D11ShaderCompileJob(
           D3D11Device*    pDevice,
     const DxvkShaderKey*  pShaderKey,
     const DxbcModuleInfo* pDxbcModuleInfo,
-    const void*           pShaderBytecode,
-          size_t          BytecodeLength) {
-    const std::string name = pShaderKey->toString();
-    Logger::debug(str::format("Compiling shader ", name));
-    
-    DxbcReader reader(
-      reinterpret_cast<const char*>(pShaderBytecode),
-      BytecodeLength);
-    
-    DxbcModule module(reader);
-    
-    // If requested by the user, dump both the raw DXBC
-    // shader and the compiled SPIR-V module to a file.
-    const std::string dumpPath = env::getEnvVar("DXVK_SHADER_DUMP_PATH");
-    
-    if (dumpPath.size() != 0) {
-      reader.store(std::ofstream(str::tows(str::format(dumpPath, "/", name, ".dxbc").c_str()).c_str(),
-        std::ios_base::binary | std::ios_base::trunc));
+          DxbcModule&&    Module,
+          bool            Deferred)
+  : m_device  (pDevice->GetDXVKDevice().ptr()),
+    m_key     (*pShaderKey),
+    m_name    (pShaderKey->toString()),
+    m_deferred(Deferred),
+    m_info    (*pDxbcModuleInfo),
+    m_module  (std::move(Module)) {
+    // The tessellation info is usually stored on the
+    // stack of the calling function, so copy it
+    if (m_info.tess) {
+      m_tess = *m_info.tess;
+      m_info.tess = &m_tess;
+    }
+  }
+
+
+  D3D11ShaderCompileJob::~D3D11ShaderCompileJob() {
+
+  }
+
+
+  void D3D11ShaderCompileJob::Compile() {
+    Rc<DxvkShader> shader;
+
+    try {
+      shader = CompileShader();
+
+      if (!ValidateShader(shader))
+        shader = nullptr;
+    } catch (const DxvkError& e) {
+      Logger::err(e.message());
     }
-    
+
+    // The DXBC code is no longer needed at this point
+    m_module.reset();
+
+    if (shader != nullptr) {
+      // Create shader constant buffer if necessary
+      const DxvkShaderCreateInfo& shaderInfo = shader->info();
+
+      if (shaderInfo.uniformSize) {
+        DxvkBufferCreateInfo info;
+        info.size   = shaderInfo.uniformSize;
+        info.usage  = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        info.stages = util::pipelineStages(shaderInfo.stage);
+        info.access = VK_ACCESS_UNIFORM_READ_BIT;
+
+        VkMemoryPropertyFlags memFlags
+          = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+          | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+          | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+        m_buffer = m_device->createBuffer(info, memFlags);
+        std::memcpy(m_buffer->mapPtr(0), shaderInfo.uniformData, shaderInfo.uniformSize);
+      }
+
+      m_device->registerShader(shader);
+    }
+
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    m_shader = std::move(shader);
+    m_ready.store(true, std::memory_order_release);
+    m_cond.notify_all();
+  }
+
+
+  void D3D11ShaderCompileJob::Wait() {
+    if (likely(m_ready.load(std::memory_order_acquire)))
+      return;
+
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    m_cond.wait(lock, [this] {
+      return m_ready.load(std::memory_order_acquire);
+    });
+  }
+
+
+  Rc<DxvkShader> D3D11ShaderCompileJob::CompileShader() {
+    Logger::debug(str::format("Compiling shader ", m_name));
+
     // Decide whether we need to create a pass-through
     // geometry shader for vertex shader stream output
-    bool passthroughShader = pDxbcModuleInfo->xfb != nullptr
-      && (module.programInfo().type() == DxbcProgramType::VertexShader
-       || module.programInfo().type() == DxbcProgramType::DomainShader);
-
-    if (module.programInfo().shaderStage() != pShaderKey->type() && !passthroughShader)
-      throw DxvkError("Mismatching shader type.");
-
-    m_shader = passthroughShader
-      ? module.compilePassthroughShader(*pDxbcModuleInfo, name)
-      : module.compile                 (*pDxbcModuleInfo, name);
-    m_shader->setShaderKey(*pShaderKey);
-    
+    bool passthroughShader = m_info.xfb != nullptr
+      && (m_module->programInfo().type() == DxbcProgramType::VertexShader
+       || m_module->programInfo().type() == DxbcProgramType::DomainShader);
+
+    Rc<DxvkShader> shader = passthroughShader
+      ? m_module->compilePassthroughShader(m_info, m_name)
+      : m_module->compile                 (m_info, m_name);
+    shader->setShaderKey(m_key);
+
+    // If requested by the user, dump the compiled SPIR-V module
+    const std::string dumpPath = env::getEnvVar("DXVK_SHADER_DUMP_PATH");
+
     if (dumpPath.size() != 0) {
       std::ofstream dumpStream(
-        str::tows(str::format(dumpPath, "/", name, ".spv").c_str()).c_str(),
+        str::tows(str::format(dumpPath, "/", m_name, ".spv").c_str()).c_str(),
         std::ios_base::binary | std::ios_base::trunc);
-      
-      m_shader->dump(dumpStream);
+
+      shader->dump(dumpStream);
+    }
+
+    return shader;
+  }
+
+
+  bool D3D11ShaderCompileJob::ValidateShader(
+    const Rc<DxvkShader>&   Shader) const {
+    if (Shader->flags().test(DxvkShaderFlag::ExportsStencilRef)
+     && !m_device->extensions().extShaderStencilExport) {
+      Logger::err(str::format("Shader ", m_name, ": Stencil export not supported"));
+      return false;
     }
-    
-    // Create shader constant buffer if necessary
-    const DxvkShaderCreateInfo& shaderInfo = m_shader->info();
-
-    if (shaderInfo.uniformSize) {
-      DxvkBufferCreateInfo info;
-      info.size   = shaderInfo.uniformSize;
-      info.usage  = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-      info.stages = util::pipelineStages(shaderInfo.stage);
-      info.access = VK_ACCESS_UNIFORM_READ_BIT;
-      
-      VkMemoryPropertyFlags memFlags
-        = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-        | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-      
-      m_buffer = pDevice->GetDXVKDevice()->createBuffer(info, memFlags);
-      std::memcpy(m_buffer->mapPtr(0), shaderInfo.uniformData, shaderInfo.uniformSize);
+
+    if (Shader->flags().test(DxvkShaderFlag::ExportsViewportIndexLayerFromVertexStage)
+     && (!m_device->features().vk12.shaderOutputViewportIndex
+      || !m_device->features().vk12.shaderOutputLayer)) {
+      Logger::err(str::format("Shader ", m_name, ": Viewport index and layer export not supported"));
+      return false;
     }
 
-    pDevice->GetDXVKDevice()->registerShader(m_shader);
+    return true;
   }
 
-  
+
+  D3D11CommonShader:: D3D11CommonShader() { }
+  D3D11CommonShader::~D3D11CommonShader() { }
+
+
+  D3D11CommonShader::D3D11CommonShader(
+    const Rc<D3D11ShaderCompileJob>& Job)
+  : m_job(Job) {
+
+  }
+
+
   D3D11ShaderModuleSet:: D3D11ShaderModuleSet() { }
   D3D11ShaderModuleSet::~D3D11ShaderModuleSet() { }
-  
-  
+
+
   HRESULT D3D11ShaderModuleSet::GetShaderModule(
           D3D11Device*        pDevice,
     const DxvkShaderKey*      pShaderKey,
@@ -89,40 +158,75 @@ namespace dxvk {
           D3D11CommonShader*  pShader) {
     // Use the shader's unique key for the lookup
     { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      
+
       auto entry = m_modules.find(*pShaderKey);
       if (entry != m_modules.end()) {
         *pShader = entry->second;
         return S_OK;
       }
     }
-    
+
     // This shader has not been compiled yet, so we have to create a
-    // new module. This takes a while, so we won't lock the structure.
-    D3D11CommonShader module;
-    
+    // new module. Parsing the DXBC container is cheap, and lets us
+    // reject invalid shaders even if compilation is deferred.
+    Rc<D3D11ShaderCompileJob> job;
+
     try {
-      module = D3D11CommonShader(pDevice, pShaderKey,
-        pDxbcModuleInfo, pShaderBytecode, BytecodeLength);
+      DxbcReader reader(
+        reinterpret_cast<const char*>(pShaderBytecode),
+        BytecodeLength);
+
+      DxbcModule module(reader);
+
+      // If requested by the user, dump the raw DXBC shader
+      const std::string dumpPath = env::getEnvVar("DXVK_SHADER_DUMP_PATH");
+
+      if (dumpPath.size() != 0) {
+        reader.store(std::ofstream(str::tows(str::format(dumpPath, "/", pShaderKey->toString(), ".dxbc").c_str()).c_str(),
+          std::ios_base::binary | std::ios_base::trunc));
+      }
+
+      bool passthroughShader = pDxbcModuleInfo->xfb != nullptr
+        && (module.programInfo().type() == DxbcProgramType::VertexShader
+         || module.programInfo().type() == DxbcProgramType::DomainShader);
+
+      if (module.programInfo().shaderStage() != pShaderKey->type() && !passthroughShader)
+        throw DxvkError("Mismatching shader type.");
+
+      // Stream output info references memory owned by the
+      // application, so we need to compile those shaders
+      // immediately, as well as all shaders if deferred
+      // compilation is disabled.
+      bool deferCompile = pDevice->GetOptions()->deferShaderCompilation
+        && pDxbcModuleInfo->xfb == nullptr;
+
+      job = new D3D11ShaderCompileJob(pDevice,
+        pShaderKey, pDxbcModuleInfo, std::move(module), deferCompile);
     } catch (const DxvkError& e) {
       Logger::err(e.message());
       return E_INVALIDARG;
     }
-    
+
+    if (!job->IsDeferred())
+      job->Compile();
+
     // Insert the new module into the lookup table. If another thread
     // has compiled the same shader in the meantime, we should return
     // that object instead and discard the newly created module.
     { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      
-      auto status = m_modules.insert({ *pShaderKey, module });
+
+      auto status = m_modules.insert({ *pShaderKey, D3D11CommonShader(job) });
       if (!status.second) {
         *pShader = status.first->second;
         return S_OK;
       }
     }
-    
-    *pShader = std::move(module);
+
+    if (job->IsDeferred())
+      pDevice->GetDXVKDevice()->compileShader(job);
+
+    *pShader = D3D11CommonShader(job);
     return S_OK;
   }
-  
+
 }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
+#include <optional>
 #include <unordered_map>
 
 #include "../dxbc/dxbc_module.h"
@@ -10,6 +12,7 @@
 
 #include "../util/sha1/sha1_util.h"
 
+#include "../util/thread.h"
 #include "../util/util_env.h"
 
 #include "d3d11_device_child.h"
@@ -19,12 +22,117 @@ namespace dxvk {
   
   class D3D11Device;
   
+  /**
+   * \brief Shader compile job
+   *
+   * Translates a DXBC module to SPIR-V and creates the
+   * immediate constant buffer, if any. Compilation may
+   * run on a DXVK pipeline worker, in which case accessing
+   * the compiled shader waits for compilation to finish.
+   * Only references the DXVK device, since the job may
+   * outlive the D3D11 device that created it.
+   */
+  class D3D11ShaderCompileJob : public DxvkShaderCompileTask {
+
+  public:
+
+    D3D11ShaderCompileJob(
+            D3D11Device*    pDevice,
+      const DxvkShaderKey*  pShaderKey,
+      const DxbcModuleInfo* pDxbcModuleInfo,
+            DxbcModule&&    Module,
+            bool            Deferred);
+
+    ~D3D11ShaderCompileJob();
+
+    void compileShader() final {
+      Compile();
+    }
+
+    /**
+     * \brief Checks whether compilation is deferred
+     *
+     * Deferred jobs are compiled on a worker thread, and
+     * errors are only reported once the shader is used.
+     * \returns \c true if compiled on a worker thread
+     */
+    bool IsDeferred() const {
+      return m_deferred;
+    }
+
+    /**
+     * \brief Compiles the shader
+     *
+     * Must be called exactly once. Errors are logged,
+     * and the resulting shader will be \c nullptr.
+     */
+    void Compile();
+
+    /**
+     * \brief Retrieves compiled shader
+     *
+     * Waits for compilation to finish.
+     * \returns Shader, or \c nullptr on error
+     */
+    Rc<DxvkShader> GetShader() {
+      Wait();
+      return m_shader;
+    }
+
+    /**
+     * \brief Retrieves immediate constant buffer
+     *
+     * Waits for compilation to finish.
+     * \returns Constant buffer, if any
+     */
+    Rc<DxvkBuffer> GetIcb() {
+      Wait();
+      return m_buffer;
+    }
+
+    /**
+     * \brief Retrieves shader name
+     * \returns Shader name
+     */
+    const std::string& GetName() const {
+      return m_name;
+    }
+
+  private:
+
+    DxvkDevice*               m_device;
+    DxvkShaderKey             m_key;
+    std::string               m_name;
+    bool                      m_deferred;
+
+    DxbcModuleInfo            m_info;
+    DxbcTessInfo              m_tess = { };
+    std::optional<DxbcModule> m_module;
+
+    Rc<DxvkShader>            m_shader;
+    Rc<DxvkBuffer>            m_buffer;
+
+    std::atomic<bool>         m_ready = { false };
+    dxvk::mutex               m_mutex;
+    dxvk::condition_variable  m_cond;
+
+    void Wait();
+
+    Rc<DxvkShader> CompileShader();
+
+    bool ValidateShader(
+      const Rc<DxvkShader>&   Shader) const;
+
+  };
+
+
   /**
    * \brief Common shader object
    * 
    * Stores the compiled SPIR-V shader and the SHA-1
    * hash of the original DXBC shader, which can be
-   * used to identify the shader.
+   * used to identify the shader. If compilation is
+   * deferred, accessing the shader will wait for it.
    */
   class D3D11CommonShader {
     
@@ -32,29 +140,28 @@ namespace dxvk {
     
     D3D11CommonShader();
     D3D11CommonShader(
-            D3D11Device*    pDevice,
-      const DxvkShaderKey*  pShaderKey,
-      const DxbcModuleInfo* pDxbcModuleInfo,
-      const void*           pShaderBytecode,
-            size_t          BytecodeLength);
+      const Rc<D3D11ShaderCompileJob>& Job);
     ~D3D11CommonShader();
 
     Rc<DxvkShader> GetShader() const {
-      return m_shader;
+      return m_job != nullptr ? m_job->GetShader() : nullptr;
     }
 
     Rc<DxvkBuffer> GetIcb() const {
-      return m_buffer;
+      return m_job != nullptr ? m_job->GetIcb() : nullptr;
+    }
+
+    bool IsDeferred() const {
+      return m_job != nullptr && m_job->IsDeferred();
     }
     
     std::string GetName() const {
-      return m_shader->debugName();
+      return m_job->GetName();
     }
     
   private:
     
-    Rc<DxvkShader> m_shader;
-    Rc<DxvkBuffer> m_buffer;
+    Rc<D3D11ShaderCompileJob> m_job;
     
   };
   
@@ -128,6 +235,11 @@ namespace dxvk {
    * times, so we should cache the resulting shader modules
    * and reuse them rather than creating new ones. This
    * class is thread-safe.
+   *
+   * If enabled, shaders are compiled on the DXVK pipeline
+   * worker threads, and shader creation only parses the
+   * DXBC container. The shader is then awaited on the CS
+   * thread the first time it is bound.
    */
   class D3D11ShaderModuleSet {
     
@@ -190,7 +190,13 @@ namespace dxvk {
     // should in no way affect the default image layout
     imageInfo.usage |= EnableMetaCopyUsage(imageInfo.format, imageInfo.tiling);
     imageInfo.usage |= EnableMetaPackUsage(imageInfo.format, m_desc.CPUAccessFlags);
-    
+
+    // Storage usage lets the backend generate mip maps in a
+    // compute shader, but only add it for images that would
+    // actually take that path.
+    if (m_desc.MiscFlags & D3D11_RESOURCE_MISC_GENERATE_MIPS)
+      DxvkMetaMipGenObjects::enableStorageUsage(m_device->GetDXVKDevice().ptr(), imageInfo);
+
     // Check if we can actually create the image
     if (!CheckImageSupport(&imageInfo, imageInfo.tiling)) {
       throw DxvkError(str::format(
@@ -218,6 +224,20 @@ namespace dxvk {
     else
       m_image = m_device->GetDXVKDevice()->createImageFromVkImage(imageInfo, vkImage);
 
+    // Query the memory layout of directly mapped subresources once,
+    // rather than on every map. Backing images that may be swapped
+    // in on discard share create info, and therefore the layout.
+    if (m_mapMode == D3D11_COMMON_TEXTURE_MAP_MODE_DIRECT) {
+      VkImageAspectFlags aspectMask = lookupFormatInfo(imageInfo.format)->aspectMask;
+
+      for (uint32_t i = 0; i < m_mapInfo.size(); i++) {
+        m_mapInfo[i].layout = m_image->querySubresourceLayout(
+          GetSubresourceFromIndex(aspectMask, i));
+      }
+
+      m_mapPtr = m_image->mapPtr(0);
+    }
+
     if (imageInfo.sharing.mode == DxvkSharedHandleMode::Export)
       ExportImageInfo();
   }
@@ -271,7 +291,7 @@ namespace dxvk {
 
     switch (m_mapMode) {
       case D3D11_COMMON_TEXTURE_MAP_MODE_DIRECT: {
-        auto vkLayout = m_image->querySubresourceLayout(subresource);
+        const auto& vkLayout = m_mapInfo[Subresource].layout;
         layout.Offset     = vkLayout.offset;
         layout.Size       = vkLayout.size;
         layout.RowPitch   = vkLayout.rowPitch;
@@ -537,7 +557,6 @@ namespace dxvk {
       : 0;
   }
 
-  
   VkMemoryPropertyFlags D3D11CommonTexture::GetMemoryFlags() const {
     VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
                                       | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
@@ -594,6 +613,21 @@ namespace dxvk {
     if (size > threshold)
       return D3D11_COMMON_TEXTURE_MAP_MODE_DIRECT;
 
+    // Dynamic images with only one subresource can be renamed on discard,
+    // which avoids the per-map buffer to image copy entirely. By default,
+    // only do this if the row pitch is likely to match the packed layout,
+    // since some games ignore the pitch returned by Map.
+    if (m_desc.Usage == D3D11_USAGE_DYNAMIC && m_desc.MipLevels == 1 && m_desc.ArraySize == 1) {
+      Tristate renameDynamicImages = m_device->GetOptions()->renameDynamicImages;
+
+      VkDeviceSize rowSize = util::computeImageDataSize(pImageInfo->format,
+        VkExtent3D { pImageInfo->extent.width, 1u, 1u });
+
+      if (renameDynamicImages == Tristate::True
+       || (renameDynamicImages == Tristate::Auto && !(rowSize % 256)))
+        return D3D11_COMMON_TEXTURE_MAP_MODE_DIRECT;
+    }
+
     // Dynamic images that can be sampled by a shader should generally go
     // through a buffer to allow optimal tiling and to avoid running into
     // bugs where games ignore the pitch when mapping the image.
@@ -230,6 +230,45 @@ namespace dxvk {
         : DxvkBufferSliceHandle();
     }
 
+    /**
+     * \brief Checks whether the image can be discarded
+     *
+     * Directly mapped dynamic images with a single subresource
+     * can swap in a new backing image on \c D3D11_MAP_WRITE_DISCARD
+     * rather than waiting for the GPU to stop using the image.
+     * \returns \c true if the image can be discarded
+     */
+    bool CanDiscardImage() const {
+      return m_mapMode == D3D11_COMMON_TEXTURE_MAP_MODE_DIRECT
+          && m_desc.Usage == D3D11_USAGE_DYNAMIC
+          && CountSubresources() == 1;
+    }
+
+    /**
+     * \brief Discards directly mapped image
+     *
+     * Allocates a new backing image for the application to write
+     * to. The backing image must then be passed to the context.
+     * \param [out] pLayout Layout that the backing image is in
+     * \returns Newly allocated backing image
+     */
+    DxvkPhysicalImage DiscardImage(VkImageLayout* pLayout) {
+      DxvkPhysicalImage image = m_image->allocPhysicalImage(pLayout);
+      m_mapPtr = image.memory.mapPtr(0);
+      return image;
+    }
+
+    /**
+     * \brief Retrieves pointer to directly mapped image memory
+     *
+     * Unlike the pointer returned by the image itself, this
+     * always points to the most recently discarded image.
+     * \returns Pointer to mapped image memory
+     */
+    void* GetMapPtr() const {
+      return m_mapPtr;
+    }
+
     /**
      * \brief Returns underlying packed Vulkan format
      *
@@ -382,6 +421,7 @@ namespace dxvk {
     struct MappedInfo {
       D3D11_MAP             mapType;
       uint64_t              seq;
+      VkSubresourceLayout   layout;
     };
 
     ID3D11Resource*               m_interface;
@@ -393,6 +433,7 @@ namespace dxvk {
     VkFormat                      m_packedFormat;
     
     Rc<DxvkImage>                 m_image;
+    void*                         m_mapPtr = nullptr;
     std::vector<MappedBuffer>     m_buffers;
     std::vector<MappedInfo>       m_mapInfo;
     
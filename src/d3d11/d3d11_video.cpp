@@ -3,6 +3,7 @@
 #include "d3d11_context.h"
 #include "d3d11_context_imm.h"
 #include "d3d11_video.h"
+#include "d3d11_video_color.h"
 
 #include <d3d11_video_blit_frag.h>
 #include <d3d11_video_blit_vert.h>
@@ -1039,8 +1040,10 @@ namespace dxvk {
     auto videoProcessor = static_cast<D3D11VideoProcessor*>(pVideoProcessor);
     bool hasStreamsEnabled = false;
 
-    // Resetting and restoring all context state incurs
-    // a lot of overhead, so only do it as necessary
+    // Resetting and restoring all context state incurs a lot
+    // of overhead, so only override and restore the state that
+    // the blit actually depends on, and only do it once for
+    // all streams that are enabled.
     for (uint32_t i = 0; i < StreamCount; i++) {
       auto streamState = videoProcessor->GetStreamState(i);
 
@@ -1048,7 +1051,6 @@ namespace dxvk {
         continue;
 
       if (!hasStreamsEnabled) {
-        m_ctx->ResetState();
         BindOutputView(pOutputView);
         hasStreamsEnabled = true;
       }
@@ -1057,7 +1059,7 @@ namespace dxvk {
     }
 
     if (hasStreamsEnabled)
-      m_ctx->RestoreState();
+      RestoreContextState();
 
     return S_OK;
   }
@@ -1148,46 +1150,6 @@ namespace dxvk {
   }
 
 
-  void D3D11VideoContext::ApplyColorMatrix(float pDst[3][4], const float pSrc[3][4]) {
-    float result[3][4];
-
-    for (uint32_t i = 0; i < 3; i++) {
-      for (uint32_t j = 0; j < 4; j++) {
-        result[i][j] = pSrc[i][0] * pDst[0][j]
-                     + pSrc[i][1] * pDst[1][j]
-                     + pSrc[i][2] * pDst[2][j]
-                     + pSrc[i][3] * float(j == 3);
-      }
-    }
-
-    memcpy(pDst, &result[0][0], sizeof(result));
-  }
-
-
-  void D3D11VideoContext::ApplyYCbCrMatrix(float pColorMatrix[3][4], bool UseBt709) {
-    static const float pretransform[3][4] = {
-      { 0.0f, 1.0f, 0.0f,  0.0f },
-      { 0.0f, 0.0f, 1.0f, -0.5f },
-      { 1.0f, 0.0f, 0.0f, -0.5f },
-    };
-
-    static const float bt601[3][4] = {
-      { 1.0f,  0.000000f,  1.402000f, 0.0f },
-      { 1.0f, -0.344136f, -0.714136f, 0.0f },
-      { 1.0f,  1.772000f,  0.000000f, 0.0f },
-    };
-
-    static const float bt709[3][4] = {
-      { 1.0f,  0.000000f,  1.574800f, 0.0f },
-      { 1.0f, -0.187324f, -0.468124f, 0.0f },
-      { 1.0f,  1.855600f,  0.000000f, 0.0f },
-    };
-
-    ApplyColorMatrix(pColorMatrix, pretransform);
-    ApplyColorMatrix(pColorMatrix, UseBt709 ? bt709 : bt601);
-  }
-
-
   void D3D11VideoContext::BindOutputView(
           ID3D11VideoProcessorOutputView* pOutputView) {
     auto dxvkView = static_cast<D3D11VideoProcessorOutputView*>(pOutputView)->GetView();
@@ -1199,14 +1161,43 @@ namespace dxvk {
 
       ctx->bindRenderTargets(rt);
       ctx->bindShader(VK_SHADER_STAGE_VERTEX_BIT, m_vs);
+      ctx->bindShader(VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, nullptr);
+      ctx->bindShader(VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT, nullptr);
+      ctx->bindShader(VK_SHADER_STAGE_GEOMETRY_BIT, nullptr);
       ctx->bindShader(VK_SHADER_STAGE_FRAGMENT_BIT, m_fs);
       ctx->bindResourceBuffer(VK_SHADER_STAGE_FRAGMENT_BIT, 0, DxvkBufferSlice(m_ubo));
 
+      // Override any pipeline state that may affect the blit,
+      // everything else is ignored by the blit shaders. Note
+      // that predication never reaches the DXVK context since
+      // SetPredication is a stub, so there is none to disable.
+      ctx->setInputLayout(0, nullptr, 0, nullptr);
+
+      for (uint32_t i = 0; i < D3D11_SO_BUFFER_SLOT_COUNT; i++)
+        ctx->bindXfbBuffer(i, DxvkBufferSlice(), DxvkBufferSlice());
+
       DxvkInputAssemblyState iaState;
       iaState.primitiveTopology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
       iaState.primitiveRestart = VK_FALSE;
       iaState.patchVertexCount = 0;
       ctx->setInputAssemblyState(iaState);
+
+      DxvkDepthStencilState dsState;
+      D3D11ImmediateContext::InitDefaultDepthStencilState(&dsState);
+
+      DxvkRasterizerState rsState;
+      D3D11ImmediateContext::InitDefaultRasterizerState(&rsState);
+
+      DxvkBlendMode cbState;
+      DxvkLogicOpState loState;
+      DxvkMultisampleState msState;
+      D3D11ImmediateContext::InitDefaultBlendState(&cbState, &loState, &msState, D3D11_DEFAULT_SAMPLE_MASK);
+
+      ctx->setDepthStencilState(dsState);
+      ctx->setRasterizerState(rsState);
+      ctx->setLogicOpState(loState);
+      ctx->setMultisampleState(msState);
+      ctx->setBlendMode(0, cbState);
     });
 
     VkExtent3D viewExtent = dxvkView->mipLevelExtent(0);
@@ -1271,24 +1262,18 @@ namespace dxvk {
         viewport.height = float(cStreamState.dstRect.bottom) - viewport.y;
       }
 
+      D3D11VideoColorTransform colorTransform = ComputeVideoColorTransform(cIsYCbCr,
+        cStreamState.colorSpace.YCbCr_Matrix,
+        cStreamState.colorSpace.Nominal_Range);
+
       UboData uboData = { };
-      uboData.colorMatrix[0][0] = 1.0f;
-      uboData.colorMatrix[1][1] = 1.0f;
-      uboData.colorMatrix[2][2] = 1.0f;
+      std::memcpy(uboData.colorMatrix, colorTransform.colorMatrix, sizeof(uboData.colorMatrix));
       uboData.coordMatrix[0][0] = 1.0f;
       uboData.coordMatrix[1][1] = 1.0f;
-      uboData.yMin = 0.0f;
-      uboData.yMax = 1.0f;
+      uboData.yMin = colorTransform.yMin;
+      uboData.yMax = colorTransform.yMax;
       uboData.isPlanar = cViews[1] != nullptr;
 
-      if (cIsYCbCr)
-        ApplyYCbCrMatrix(uboData.colorMatrix, cStreamState.colorSpace.YCbCr_Matrix);
-
-      if (cStreamState.colorSpace.Nominal_Range) {
-        uboData.yMin = 0.0627451f;
-        uboData.yMax = 0.9215686f;
-      }
-
       DxvkBufferSliceHandle uboSlice = m_ubo->allocSlice();
       memcpy(uboSlice.mapPtr, &uboData, sizeof(uboData));
 
@@ -1303,4 +1288,18 @@ namespace dxvk {
     });
   }
 
+
+
+  void D3D11VideoContext::RestoreContextState() {
+    // Restore everything that was overridden in BindOutputView
+    // and BlitStream. The blit shaders only use resource slots
+    // that alias pixel shader constant buffers.
+    m_ctx->RestoreGraphicsPipelineState();
+    m_ctx->DirtyBindings<DxbcProgramType::PixelShader>().constantBuffers.setRange(0, 4);
+
+    // Stream output resumes at the current counter value
+    for (uint32_t i = 0; i < m_ctx->m_state.so.targets.size(); i++)
+      m_ctx->BindXfbBuffer(i, m_ctx->m_state.so.targets[i].buffer.ptr(), ~0u);
+  }
+
 }
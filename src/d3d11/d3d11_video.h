@@ -597,10 +597,6 @@ namespace dxvk {
 
     VkExtent2D m_dstExtent = { 0u, 0u };
 
-    void ApplyColorMatrix(float pDst[3][4], const float pSrc[3][4]);
-
-    void ApplyYCbCrMatrix(float pColorMatrix[3][4], bool UseBt709);
-
     void BindOutputView(
             ID3D11VideoProcessorOutputView* pOutputView);
 
@@ -608,6 +604,8 @@ namespace dxvk {
       const D3D11VideoProcessorStreamState* pStreamState,
       const D3D11_VIDEO_PROCESSOR_STREAM*   pStream);
 
+    void RestoreContextState();
+
   };
 
 }
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace dxvk {
+
+  /**
+   * \brief Video processor color transform
+   *
+   * Stores the 3x4 matrix that the video blit shader applies
+   * to the fetched source color, as well as the luma range.
+   * Kept free of any device state so that the conversion
+   * math can be validated on the CPU.
+   */
+  struct D3D11VideoColorTransform {
+    float colorMatrix[3][4];
+    float yMin;
+    float yMax;
+  };
+
+
+  /**
+   * \brief Multiplies color matrices
+   *
+   * Computes \c pSrc * \c pDst, treating both as 4x4
+   * matrices with an implicit last row of (0, 0, 0, 1).
+   * \param [in,out] pDst Matrix to transform
+   * \param [in] pSrc Matrix to apply
+   */
+  inline void ApplyVideoColorMatrix(float pDst[3][4], const float pSrc[3][4]) {
+    float result[3][4];
+
+    for (uint32_t i = 0; i < 3; i++) {
+      for (uint32_t j = 0; j < 4; j++) {
+        result[i][j] = pSrc[i][0] * pDst[0][j]
+                     + pSrc[i][1] * pDst[1][j]
+                     + pSrc[i][2] * pDst[2][j]
+                     + pSrc[i][3] * float(j == 3);
+      }
+    }
+
+    std::memcpy(pDst, &result[0][0], sizeof(result));
+  }
+
+
+  /**
+   * \brief Applies YCbCr to RGB conversion
+   *
+   * The shader stores luma in the green channel and
+   * Cr and Cb in the red and blue channels, respectively.
+   * \param [in,out] pColorMatrix Matrix to transform
+   * \param [in] UseBt709 Whether to use BT.709 instead of BT.601
+   */
+  inline void ApplyVideoYCbCrMatrix(float pColorMatrix[3][4], bool UseBt709) {
+    static const float pretransform[3][4] = {
+      { 0.0f, 1.0f, 0.0f,  0.0f },
+      { 0.0f, 0.0f, 1.0f, -0.5f },
+      { 1.0f, 0.0f, 0.0f, -0.5f },
+    };
+
+    static const float bt601[3][4] = {
+      { 1.0f,  0.000000f,  1.402000f, 0.0f },
+      { 1.0f, -0.344136f, -0.714136f, 0.0f },
+      { 1.0f,  1.772000f,  0.000000f, 0.0f },
+    };
+
+    static const float bt709[3][4] = {
+      { 1.0f,  0.000000f,  1.574800f, 0.0f },
+      { 1.0f, -0.187324f, -0.468124f, 0.0f },
+      { 1.0f,  1.855600f,  0.000000f, 0.0f },
+    };
+
+    ApplyVideoColorMatrix(pColorMatrix, pretransform);
+    ApplyVideoColorMatrix(pColorMatrix, UseBt709 ? bt709 : bt601);
+  }
+
+
+  /**
+   * \brief Computes the color transform for a stream
+   *
+   * \param [in] IsYCbCr Whether the source format is YCbCr
+   * \param [in] UseBt709 Whether to use BT.709 instead of BT.601
+   * \param [in] NominalRange Whether luma uses the 16-235 range
+   * \returns Color transform to pass to the shader
+   */
+  inline D3D11VideoColorTransform ComputeVideoColorTransform(
+          bool                    IsYCbCr,
+          bool                    UseBt709,
+          bool                    NominalRange) {
+    D3D11VideoColorTransform result = { };
+    result.colorMatrix[0][0] = 1.0f;
+    result.colorMatrix[1][1] = 1.0f;
+    result.colorMatrix[2][2] = 1.0f;
+    result.yMin = 0.0f;
+    result.yMax = 1.0f;
+
+    if (IsYCbCr)
+      ApplyVideoYCbCrMatrix(result.colorMatrix, UseBt709);
+
+    if (NominalRange) {
+      result.yMin = 0.0627451f;
+      result.yMax = 0.9215686f;
+    }
+
+    return result;
+  }
+
+
+  /**
+   * \brief Converts a planar source color on the CPU
+   *
+   * Mirrors what the blit shader does for planar formats.
+   * \param [in] Transform Color transform
+   * \param [in] Y Luma value, normalized
+   * \param [in] Cb Blue-difference chroma, normalized
+   * \param [in] Cr Red-difference chroma, normalized
+   * \param [out] pRgb Resulting RGB color
+   */
+  inline void ConvertVideoColor(
+    const D3D11VideoColorTransform& Transform,
+          float                   Y,
+          float                   Cb,
+          float                   Cr,
+          float                   pRgb[3]) {
+    float y = (Y - Transform.yMin) / (Transform.yMax - Transform.yMin);
+    y = y < 0.0f ? 0.0f : (y > 1.0f ? 1.0f : y);
+
+    const float src[4] = { Cr, y, Cb, 1.0f };
+
+    for (uint32_t i = 0; i < 3; i++) {
+      pRgb[i] = 0.0f;
+
+      for (uint32_t j = 0; j < 4; j++)
+        pRgb[i] += src[j] * Transform.colorMatrix[i][j];
+    }
+  }
+
+}
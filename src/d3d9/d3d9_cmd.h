@@ -0,0 +1,63 @@
+#pragma once
+
+#include "d3d9_include.h"
+
+#include <array>
+
+namespace dxvk {
+
+  /**
+   * \brief D3D9 command type
+   *
+   * Used to identify the type of command
+   * data most recently added to a CS chunk.
+   */
+  enum class D3D9CmdType {
+    Draw,
+    DrawIndexed,
+  };
+
+
+  /**
+   * \brief Command data header
+   *
+   * Stores the command type. All command
+   * data structs must inherit this struct.
+   */
+  struct D3D9CmdData {
+    D3D9CmdType         type;
+  };
+
+
+  /**
+   * \brief Arguments of a single batched draw
+   *
+   * For non-indexed draws, \c first is the first vertex
+   * and \c baseVertex is unused. For indexed draws,
+   * \c first is the first index.
+   */
+  struct D3D9CmdDrawArgs {
+    uint32_t            primitiveCount;
+    uint32_t            first;
+    int32_t             baseVertex;
+  };
+
+
+  /**
+   * \brief Draw batch command data
+   *
+   * Stores a run of draws that were issued without any
+   * state changes in between. These share the primitive
+   * type and instance count, and are executed back to
+   * back by a single command on the CS thread.
+   */
+  struct D3D9CmdDrawBatchData : public D3D9CmdData {
+    constexpr static uint32_t MaxDraws = 8;
+
+    D3DPRIMITIVETYPE    primitiveType;
+    uint32_t            instanceCount;
+    uint32_t            count;
+    std::array<D3D9CmdDrawArgs, MaxDraws> draws;
+  };
+
+}
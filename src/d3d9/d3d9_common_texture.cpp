@@ -86,6 +86,9 @@ namespace dxvk {
   D3D9CommonTexture::~D3D9CommonTexture() {
     if (m_size != 0)
       m_device->ChangeReportedMemory(m_size);
+
+    if (IsUploadQueued())
+      m_device->DequeueManagedTextureUpload(this);
   }
 
 
@@ -182,6 +185,7 @@ namespace dxvk {
     if (m_mapping.ConversionFormatInfo.FormatType != D3D9ConversionFormat_None) {
       info.usage  |= VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT;
       info.stages |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+      info.access |= VK_ACCESS_SHADER_READ_BIT;
     }
 
     VkMemoryPropertyFlags memType = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
@@ -195,6 +199,18 @@ namespace dxvk {
   }
 
 
+  VkDeviceSize D3D9CommonTexture::GetPendingUploadSize() const {
+    VkDeviceSize size = 0;
+
+    for (uint32_t i = 0; i < CountSubresources(); i++) {
+      if (m_needsUpload.get(i))
+        size += GetMipSize(i);
+    }
+
+    return size;
+  }
+
+
   VkDeviceSize D3D9CommonTexture::GetMipSize(UINT Subresource) const {
     const UINT MipLevel = Subresource % m_desc.MipLevels;
 
@@ -310,6 +326,12 @@ namespace dxvk {
     // in no way affect the default image layout
     imageInfo.usage |= EnableMetaCopyUsage(imageInfo.format, imageInfo.tiling);
 
+    // Storage usage lets the backend generate mip maps in a
+    // compute shader, but only add it for images that would
+    // actually take that path.
+    if (m_desc.Usage & D3DUSAGE_AUTOGENMIPMAP)
+      DxvkMetaMipGenObjects::enableStorageUsage(m_device->GetDXVKDevice().ptr(), imageInfo);
+
     // Check if we can actually create the image
     if (!CheckImageSupport(&imageInfo, imageInfo.tiling)) {
       throw DxvkError(str::format(
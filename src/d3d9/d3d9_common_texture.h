@@ -380,6 +380,23 @@ namespace dxvk {
     void ClearNeedsUpload() { return m_needsUpload.clearAll();  }
     bool DoesStagingBufferUploads(UINT Subresource) const { return m_uploadUsingStaging.get(Subresource); }
 
+    /**
+     * \brief Pending upload size
+     * \returns Number of bytes that need to be uploaded
+     */
+    VkDeviceSize GetPendingUploadSize() const;
+
+    /**
+     * \brief Position in the device's managed upload queue
+     * \returns Queue index, or \c ~0u if not queued
+     */
+    uint32_t GetUploadQueueIndex() const { return m_uploadQueueIndex; }
+    void SetUploadQueueIndex(uint32_t index) { m_uploadQueueIndex = index; }
+    bool IsUploadQueued() const { return m_uploadQueueIndex != ~0u; }
+
+    void SetLastWriteFrame(uint64_t frame) { m_lastWriteFrame = frame; }
+    uint64_t GetLastWriteFrame() const { return m_lastWriteFrame; }
+
     void EnableStagingBufferUploads(UINT Subresource) {
       m_uploadUsingStaging.set(Subresource, true);
     }
@@ -500,6 +517,10 @@ namespace dxvk {
 
     D3D9SubresourceBitset         m_uploadUsingStaging = { };
 
+    uint32_t                      m_uploadQueueIndex = ~0u;
+
+    uint64_t                      m_lastWriteFrame = 0;
+
     DWORD                         m_exposedMipLevels = 0;
 
     bool                          m_needsMipGen = false;
@@ -50,6 +50,7 @@ namespace dxvk {
     , m_d3d9Options    ( dxvkDevice, pParent->GetInstance()->config() )
     , m_multithread    ( BehaviorFlags & D3DCREATE_MULTITHREADED )
     , m_isSWVP         ( (BehaviorFlags & D3DCREATE_SOFTWARE_VERTEXPROCESSING) ? true : false )
+    , m_flushTracker   ( dxvkDevice )
     , m_csThread       ( dxvkDevice, dxvkDevice->createContext(DxvkContextType::Primary) )
     , m_csChunk        ( AllocCsChunk() ) {
     // If we can SWVP, then we use an extended constant set
@@ -2413,21 +2414,12 @@ namespace dxvk {
 
     PrepareDraw(PrimitiveType);
 
-    EmitCs([this,
-      cPrimType    = PrimitiveType,
-      cPrimCount   = PrimitiveCount,
-      cStartVertex = StartVertex,
-      cInstanceCount = GetInstanceCount()
-    ](DxvkContext* ctx) {
-      auto drawInfo = GenerateDrawInfo(cPrimType, cPrimCount, cInstanceCount);
-
-      ApplyPrimitiveType(ctx, cPrimType);
-
-      ctx->draw(
-        drawInfo.vertexCount, drawInfo.instanceCount,
-        cStartVertex, 0);
-    });
+    D3D9CmdDrawArgs args;
+    args.primitiveCount = PrimitiveCount;
+    args.first          = StartVertex;
+    args.baseVertex     = 0;
 
+    EmitDraw<D3D9CmdType::Draw>(PrimitiveType, args);
     return D3D_OK;
   }
 
@@ -2449,23 +2441,12 @@ namespace dxvk {
 
     PrepareDraw(PrimitiveType);
 
-    EmitCs([this,
-      cPrimType        = PrimitiveType,
-      cPrimCount       = PrimitiveCount,
-      cStartIndex      = StartIndex,
-      cBaseVertexIndex = BaseVertexIndex,
-      cInstanceCount   = GetInstanceCount()
-    ](DxvkContext* ctx) {
-      auto drawInfo = GenerateDrawInfo(cPrimType, cPrimCount, cInstanceCount);
-
-      ApplyPrimitiveType(ctx, cPrimType);
-
-      ctx->drawIndexed(
-        drawInfo.vertexCount, drawInfo.instanceCount,
-        cStartIndex,
-        cBaseVertexIndex, 0);
-    });
+    D3D9CmdDrawArgs args;
+    args.primitiveCount = PrimitiveCount;
+    args.first          = StartIndex;
+    args.baseVertex     = BaseVertexIndex;
 
+    EmitDraw<D3D9CmdType::DrawIndexed>(PrimitiveType, args);
     return D3D_OK;
   }
 
@@ -2852,7 +2833,10 @@ namespace dxvk {
       m_consts[DxsoProgramTypes::VertexShader].dirty
         |= newShader->GetMeta().maxConstIndexF > oldShader->GetMeta().maxConstIndexF
         || newShader->GetMeta().maxConstIndexI > oldShader->GetMeta().maxConstIndexI
-        || newShader->GetMeta().maxConstIndexB > oldShader->GetMeta().maxConstIndexB;
+        || newShader->GetMeta().maxConstIndexB > oldShader->GetMeta().maxConstIndexB
+        || newShader->GetMeta().packedConstantsF != oldShader->GetMeta().packedConstantsF
+        || (newShader->GetMeta().packedConstantsF
+         && newShader->GetMeta().constantMaskF != oldShader->GetMeta().constantMaskF);
     }
 
     m_state.vertexShader = shader;
@@ -3184,7 +3168,10 @@ namespace dxvk {
       m_consts[DxsoProgramTypes::PixelShader].dirty
         |= newShader->GetMeta().maxConstIndexF > oldShader->GetMeta().maxConstIndexF
         || newShader->GetMeta().maxConstIndexI > oldShader->GetMeta().maxConstIndexI
-        || newShader->GetMeta().maxConstIndexB > oldShader->GetMeta().maxConstIndexB;
+        || newShader->GetMeta().maxConstIndexB > oldShader->GetMeta().maxConstIndexB
+        || newShader->GetMeta().packedConstantsF != oldShader->GetMeta().packedConstantsF
+        || (newShader->GetMeta().packedConstantsF
+         && newShader->GetMeta().constantMaskF != oldShader->GetMeta().constantMaskF);
     }
 
     m_state.pixelShader = shader;
@@ -4327,6 +4314,7 @@ namespace dxvk {
 
     if (managed && !m_d3d9Options.evictManagedOnUnlock && !readOnly) {
       pResource->SetNeedsUpload(Subresource, true);
+      QueueManagedTextureUpload(pResource);
 
       for (uint32_t i : bit::BitMask(m_activeTextures)) {
         // Guaranteed to not be nullptr...
@@ -4530,21 +4518,40 @@ namespace dxvk {
         return;
       }
 
-      // the converter can not handle the 4 aligned pitch so we always repack into a staging buffer
-      D3D9BufferSlice slice = AllocStagingBuffer(srcSlice.length);
-      VkDeviceSize pitch = align(srcTexLevelExtentBlockCount.width * formatInfo->elementSize, 4);
+      VkDeviceSize rowSize = srcTexLevelExtentBlockCount.width * formatInfo->elementSize;
+      VkDeviceSize pitch = align(rowSize, 4);
 
-      util::packImageData(
-        slice.mapPtr, srcSlice.mapPtr, srcTexLevelExtentBlockCount, formatInfo->elementSize,
-        pitch, std::min(convertFormat.PlaneCount, 2u) * pitch * srcTexLevelExtentBlockCount.height);
+      DxvkBufferSlice convertSrcSlice;
 
-      Flush();
-      SynchronizeCsThread(DxvkCsThread::SynchronizeAll);
+      if (rowSize == pitch && !pSrcTexture->DoesStagingBufferUploads(SrcSubresource)) {
+        // The mapping buffer is already tightly packed,
+        // so the converter can read from it directly
+        convertSrcSlice = DxvkBufferSlice(pSrcTexture->GetBuffer(SrcSubresource), 0, srcSlice.length);
+        TrackTextureMappingBufferSequenceNumber(pSrcTexture, SrcSubresource);
+      } else {
+        // the converter can not handle the 4 aligned pitch so we need to repack into a staging buffer
+        D3D9BufferSlice slice = AllocStagingBuffer(srcSlice.length);
+        convertSrcSlice = slice.slice;
+
+        util::packImageData(
+          slice.mapPtr, srcSlice.mapPtr, srcTexLevelExtentBlockCount, formatInfo->elementSize,
+          pitch, std::min(convertFormat.PlaneCount, 2u) * pitch * srcTexLevelExtentBlockCount.height);
+      }
+
+      EmitCs([this,
+        cConvertFormat  = convertFormat,
+        cDstImage       = image,
+        cDstLayers      = dstLayers,
+        cSrcSlice       = std::move(convertSrcSlice)
+      ] (DxvkContext* ctx) {
+        m_converter->ConvertFormat(ctx,
+          cConvertFormat, cDstImage,
+          cDstLayers, cSrcSlice);
+      });
 
-      m_converter->ConvertFormat(
-        convertFormat,
-        image, dstLayers,
-        slice.slice);
+      // The conversion shader clobbers the start of
+      // the push constant block, so restore it here
+      UpdatePushConstant<D3D9RenderStateItem::FogColor>();
     }
   }
 
@@ -4754,20 +4761,10 @@ namespace dxvk {
 
 
   void D3D9DeviceEx::FlushImplicit(BOOL StrongHint) {
-    // Flush only if the GPU is about to go idle, in
-    // order to keep the number of submissions low.
-    uint32_t pending = m_dxvkDevice->pendingSubmissions();
+    uint64_t csQueueDepth = m_csSeqNum - m_csThread.lastSequenceNumber();
 
-    if (StrongHint || pending <= MaxPendingSubmits) {
-      auto now = dxvk::high_resolution_clock::now();
-
-      uint32_t delay = MinFlushIntervalUs
-                     + IncFlushIntervalUs * pending;
-
-      // Prevent flushing too often in short intervals.
-      if (now - m_lastFlush >= std::chrono::microseconds(delay))
-        Flush();
-    }
+    if (m_flushTracker.considerFlush(StrongHint, csQueueDepth))
+      Flush();
   }
 
 
@@ -4982,6 +4979,9 @@ namespace dxvk {
     }
     floatCount = std::min(constSet.meta.maxConstIndexF, floatCount);
 
+    if (constSet.meta.packedConstantsF)
+      floatCount = constSet.meta.packedConstantCountF;
+
     const uint32_t intRange = caps::MaxOtherConstants * sizeof(Vector4i);
     const uint32_t intDataSize = constSet.meta.maxConstIndexI * sizeof(Vector4i);
     uint32_t floatDataSize = floatCount * sizeof(Vector4);
@@ -4994,8 +4994,34 @@ namespace dxvk {
 
     if (constSet.meta.maxConstIndexI != 0)
       std::memcpy(dst->iConsts, Src.iConsts, intDataSize);
-    if (constSet.meta.maxConstIndexF != 0)
+
+    if (constSet.meta.packedConstantsF) {
+      // Only copy the constants that the shader actually reads,
+      // merging consecutive registers into one single copy
+      const auto& mask = constSet.meta.constantMaskF;
+
+      uint32_t dstIndex = 0;
+      uint32_t srcIndex = 0;
+
+      while (srcIndex < constSet.meta.maxConstIndexF) {
+        if (!mask.get(srcIndex)) {
+          srcIndex += 1;
+          continue;
+        }
+
+        uint32_t count = 1;
+
+        while (srcIndex + count < constSet.meta.maxConstIndexF && mask.get(srcIndex + count))
+          count += 1;
+
+        std::memcpy(&dst->fConsts[dstIndex], &Src.fConsts[srcIndex], count * sizeof(Vector4));
+
+        dstIndex += count;
+        srcIndex += count;
+      }
+    } else if (constSet.meta.maxConstIndexF != 0) {
       std::memcpy(dst->fConsts, Src.fConsts, floatDataSize);
+    }
 
     if (constSet.meta.needsConstantCopies) {
       Vector4* data = reinterpret_cast<Vector4*>(dst->fConsts);
@@ -5051,6 +5077,20 @@ namespace dxvk {
   }
 
 
+  void D3D9DeviceEx::SetSpecConstant(
+          DxvkContext*          ctx,
+          D3D9SpecConstantId    id,
+          uint32_t              value) {
+    ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, id, value);
+
+    // Pipeline libraries are not specialized and read
+    // the value from the render state block instead
+    ctx->pushConstants(
+      offsetof(D3D9RenderStateInfo, specConstants) + sizeof(uint32_t) * id,
+      sizeof(uint32_t), &value);
+  }
+
+
   template <D3D9RenderStateItem Item>
   void D3D9DeviceEx::UpdatePushConstant() {
     auto& rs = m_state.renderStates;
@@ -5116,7 +5156,6 @@ namespace dxvk {
     D3D9DeviceLock lock = LockDevice();
 
     m_initializer->Flush();
-    m_converter->Flush();
 
     if (m_csIsBusy || !m_csChunk->empty()) {
       // Add commands to flush the threaded
@@ -5128,16 +5167,20 @@ namespace dxvk {
       FlushCsChunk();
 
       // Reset flush timer used for implicit flushes
-      m_lastFlush = dxvk::high_resolution_clock::now();
+      m_flushTracker.notifyFlush();
       m_csIsBusy = false;
     }
   }
 
 
   void D3D9DeviceEx::EndFrame() {
+    PrefetchManagedTextures();
+
     EmitCs([] (DxvkContext* ctx) {
       ctx->endFrame();
     });
+
+    m_frameCounter += 1;
   }
 
 
@@ -5279,6 +5322,86 @@ namespace dxvk {
   }
 
 
+  void D3D9DeviceEx::QueueManagedTextureUpload(D3D9CommonTexture* pResource) {
+    pResource->SetLastWriteFrame(m_frameCounter);
+
+    if (m_d3d9Options.managedUploadBudget <= 0 || pResource->IsUploadQueued())
+      return;
+
+    pResource->SetUploadQueueIndex(uint32_t(m_managedUploadQueue.size()));
+    m_managedUploadQueue.push_back(pResource);
+  }
+
+
+  void D3D9DeviceEx::DequeueManagedTextureUpload(D3D9CommonTexture* pResource) {
+    D3D9DeviceLock lock = LockDevice();
+
+    // Leave a hole in the queue, it gets compacted
+    // the next time we prefetch managed textures
+    m_managedUploadQueue[pResource->GetUploadQueueIndex()] = nullptr;
+    pResource->SetUploadQueueIndex(~0u);
+  }
+
+
+  void D3D9DeviceEx::PrefetchManagedTextures() {
+    if (m_managedUploadQueue.empty())
+      return;
+
+    VkDeviceSize budget = VkDeviceSize(std::max(m_d3d9Options.managedUploadBudget, 0)) << 20;
+
+    // Only prefetch textures that were written in a previous frame, since
+    // the app may still be updating anything it touched in this frame, and
+    // locking a texture again would have to wait for the upload to finish.
+    // Textures bound for the next draw go first as they are most likely to
+    // be needed soon and would otherwise be uploaded inside the next draw.
+    auto tryUpload = [this, &budget] (D3D9CommonTexture* pResource) {
+      if (!pResource->NeedsAnyUpload())
+        return true;
+
+      if (pResource->GetLastWriteFrame() == m_frameCounter
+       || pResource->IsAnySubresourceLocked())
+        return false;
+
+      VkDeviceSize size = pResource->GetPendingUploadSize();
+
+      if (size > budget)
+        return false;
+
+      budget -= size;
+
+      UploadManagedTexture(pResource);
+      MarkTextureUploaded(pResource);
+      return true;
+    };
+
+    for (uint32_t i : bit::BitMask(m_activeTexturesToUpload)) {
+      // Guaranteed to not be nullptr...
+      auto texInfo = GetCommonTexture(m_state.textures[i]);
+
+      if (texInfo->IsUploadQueued())
+        tryUpload(texInfo);
+    }
+
+    size_t dst = 0;
+
+    for (size_t src = 0; src < m_managedUploadQueue.size(); src++) {
+      D3D9CommonTexture* texInfo = m_managedUploadQueue[src];
+
+      if (!texInfo)
+        continue;
+
+      if (tryUpload(texInfo)) {
+        texInfo->SetUploadQueueIndex(~0u);
+      } else {
+        texInfo->SetUploadQueueIndex(uint32_t(dst));
+        m_managedUploadQueue[dst++] = texInfo;
+      }
+    }
+
+    m_managedUploadQueue.resize(dst);
+  }
+
+
   void D3D9DeviceEx::GenerateTextureMips(uint32_t mask) {
     for (uint32_t texIdx : bit::BitMask(mask)) {
       // Guaranteed to not be nullptr...
@@ -5341,7 +5464,7 @@ namespace dxvk {
       m_lastPointMode = 0;
 
       EmitCs([](DxvkContext* ctx) {
-        ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::PointMode, 0);
+        SetSpecConstant(ctx, D3D9SpecConstantId::PointMode, 0);
       });
     }
     else {
@@ -5365,7 +5488,7 @@ namespace dxvk {
 
       if (unlikely(mode != m_lastPointMode)) {
         EmitCs([cMode = mode] (DxvkContext* ctx) {
-          ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::PointMode, cMode);
+          SetSpecConstant(ctx, D3D9SpecConstantId::PointMode, cMode);
         });
 
         m_lastPointMode = mode;
@@ -5416,9 +5539,9 @@ namespace dxvk {
         m_flags.clr(D3D9DeviceFlag::DirtyFogState);
 
         EmitCs([cMode = mode] (DxvkContext* ctx) {
-          ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::FogEnabled,    true);
-          ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::VertexFogMode, cMode);
-          ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::PixelFogMode,  D3DFOG_NONE);
+          SetSpecConstant(ctx, D3D9SpecConstantId::FogEnabled,    true);
+          SetSpecConstant(ctx, D3D9SpecConstantId::VertexFogMode, cMode);
+          SetSpecConstant(ctx, D3D9SpecConstantId::PixelFogMode,  D3DFOG_NONE);
         });
       }
     }
@@ -5431,9 +5554,9 @@ namespace dxvk {
         m_flags.clr(D3D9DeviceFlag::DirtyFogState);
 
         EmitCs([cMode = mode] (DxvkContext* ctx) {
-          ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::FogEnabled,    true);
-          ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::VertexFogMode, D3DFOG_NONE);
-          ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::PixelFogMode,  cMode);
+          SetSpecConstant(ctx, D3D9SpecConstantId::FogEnabled,    true);
+          SetSpecConstant(ctx, D3D9SpecConstantId::VertexFogMode, D3DFOG_NONE);
+          SetSpecConstant(ctx, D3D9SpecConstantId::PixelFogMode,  cMode);
         });
       }
     }
@@ -5445,9 +5568,9 @@ namespace dxvk {
         m_flags.clr(D3D9DeviceFlag::DirtyFogState);
 
         EmitCs([cEnabled = fogEnabled] (DxvkContext* ctx) {
-          ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::FogEnabled,    cEnabled);
-          ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::VertexFogMode, D3DFOG_NONE);
-          ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::PixelFogMode,  D3DFOG_NONE);
+          SetSpecConstant(ctx, D3D9SpecConstantId::FogEnabled,    cEnabled);
+          SetSpecConstant(ctx, D3D9SpecConstantId::VertexFogMode, D3DFOG_NONE);
+          SetSpecConstant(ctx, D3D9SpecConstantId::PixelFogMode,  D3DFOG_NONE);
         });
       }
     }
@@ -5778,7 +5901,7 @@ namespace dxvk {
       : VK_COMPARE_OP_ALWAYS;
 
     EmitCs([cAlphaOp = alphaOp] (DxvkContext* ctx) {
-      ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::AlphaCompareOp, cAlphaOp);
+      SetSpecConstant(ctx, D3D9SpecConstantId::AlphaCompareOp, cAlphaOp);
     });
   }
 
@@ -5834,12 +5957,8 @@ namespace dxvk {
     ] (DxvkContext* ctx) {
       VkShaderStageFlags stage = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
-      auto pair = m_samplers.find(cKey);
-      if (pair != m_samplers.end()) {
-        ctx->bindResourceSampler(stage, cSlot, pair->second);
-        return;
-      }
-
+      // Samplers are cached by the DXVK device, which can free
+      // them again once they are no longer bound anywhere.
       auto mipFilter = DecodeMipFilter(cKey.MipFilter);
 
       DxvkSamplerCreateInfo info;
@@ -5875,11 +5994,7 @@ namespace dxvk {
 
       try {
         auto sampler = m_dxvkDevice->createSampler(info);
-
-        m_samplers.insert(std::make_pair(cKey, sampler));
         ctx->bindResourceSampler(stage, cSlot, std::move(sampler));
-
-        m_samplerCount++;
       }
       catch (const DxvkError& e) {
         Logger::err(e.message());
@@ -6146,6 +6261,60 @@ namespace dxvk {
   }
 
 
+  template <D3D9CmdType Type>
+  void D3D9DeviceEx::EmitDraw(
+          D3DPRIMITIVETYPE                  PrimitiveType,
+    const D3D9CmdDrawArgs&                  Args) {
+    uint32_t instanceCount = GetInstanceCount();
+
+    // If PrepareDraw did not emit any commands since the last
+    // draw, nothing the draw depends on has changed, so we can
+    // append it to the previous command instead of emitting a
+    // new one. This saves CS chunk space and per-command overhead.
+    auto cmdData = static_cast<D3D9CmdDrawBatchData*>(m_cmdData);
+
+    if (cmdData && cmdData->type == Type
+     && cmdData->primitiveType == PrimitiveType
+     && cmdData->instanceCount == instanceCount
+     && cmdData->count < D3D9CmdDrawBatchData::MaxDraws) {
+      cmdData->draws[cmdData->count++] = Args;
+      return;
+    }
+
+    cmdData = EmitCsCmd<D3D9CmdDrawBatchData>(
+      [this] (DxvkContext* ctx, const D3D9CmdDrawBatchData* data) {
+        ApplyPrimitiveType(ctx, data->primitiveType);
+
+        for (uint32_t i = 0; i < data->count; i++) {
+          const auto& draw = data->draws[i];
+
+          auto drawInfo = GenerateDrawInfo(
+            data->primitiveType, draw.primitiveCount, data->instanceCount);
+
+          if (Type == D3D9CmdType::DrawIndexed) {
+            ctx->drawIndexed(
+              drawInfo.vertexCount, drawInfo.instanceCount,
+              draw.first, draw.baseVertex, 0);
+          } else {
+            ctx->draw(
+              drawInfo.vertexCount, drawInfo.instanceCount,
+              draw.first, 0);
+          }
+        }
+      });
+
+    cmdData->type           = Type;
+    cmdData->primitiveType  = PrimitiveType;
+    cmdData->instanceCount  = instanceCount;
+    cmdData->count          = 1;
+    cmdData->draws[0]       = Args;
+
+    // Batching disabled, make sure the next draw emits its own command
+    if (!m_d3d9Options.batchDraws)
+      m_cmdData = nullptr;
+  }
+
+
   template <DxsoProgramType ShaderStage>
   void D3D9DeviceEx::BindShader(
   const D3D9CommonShader*                 pShaderModule,
@@ -6740,7 +6909,7 @@ namespace dxvk {
       return;
 
     EmitCs([cBitfield = value](DxvkContext* ctx) {
-      ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::VertexShaderBools, cBitfield);
+      SetSpecConstant(ctx, D3D9SpecConstantId::VertexShaderBools, cBitfield);
       });
 
     m_lastBoolSpecConstantVertex = value;
@@ -6752,7 +6921,7 @@ namespace dxvk {
       return;
 
     EmitCs([cBitfield = value](DxvkContext* ctx) {
-      ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::PixelShaderBools, cBitfield);
+      SetSpecConstant(ctx, D3D9SpecConstantId::PixelShaderBools, cBitfield);
       });
 
     m_lastBoolSpecConstantPixel = value;
@@ -6770,9 +6939,9 @@ namespace dxvk {
         cProjectionType = projections,
         cFetch4 = fetch4
       ] (DxvkContext* ctx) {
-        ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::SamplerType, cSamplerType);
-        ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::ProjectionType, cProjectionType);
-        ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::Fetch4, cFetch4);
+        SetSpecConstant(ctx, D3D9SpecConstantId::SamplerType, cSamplerType);
+        SetSpecConstant(ctx, D3D9SpecConstantId::ProjectionType, cProjectionType);
+        SetSpecConstant(ctx, D3D9SpecConstantId::Fetch4, cFetch4);
       });
     }
   }
@@ -6787,8 +6956,8 @@ namespace dxvk {
         cNullMask = nullMask,
         cDepthMask = depthMask
       ] (DxvkContext* ctx) {
-        ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::SamplerNull, cNullMask);
-        ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_GRAPHICS, D3D9SpecConstantId::SamplerDepthMode, cDepthMask);
+        SetSpecConstant(ctx, D3D9SpecConstantId::SamplerNull, cNullMask);
+        SetSpecConstant(ctx, D3D9SpecConstantId::SamplerDepthMode, cDepthMask);
       });
     }
   }
@@ -2,9 +2,11 @@
 
 #include "../dxvk/dxvk_device.h"
 #include "../dxvk/dxvk_cs.h"
+#include "../dxvk/dxvk_flush.h"
 #include "../dxvk/dxvk_staging.h"
 
 #include "d3d9_include.h"
+#include "d3d9_cmd.h"
 #include "d3d9_cursor.h"
 #include "d3d9_format.h"
 #include "d3d9_multithread.h"
@@ -94,10 +96,6 @@ namespace dxvk {
     constexpr static uint32_t DefaultFrameLatency = 3;
     constexpr static uint32_t MaxFrameLatency     = 20;
 
-    constexpr static uint32_t MinFlushIntervalUs = 750;
-    constexpr static uint32_t IncFlushIntervalUs = 250;
-    constexpr static uint32_t MaxPendingSubmits = 6;
-
     constexpr static uint32_t NullStreamIdx = caps::MaxStreams;
 
     constexpr static VkDeviceSize StagingBufferSize = 4ull << 20;
@@ -764,6 +762,10 @@ namespace dxvk {
 
     void UploadManagedTextures(uint32_t mask);
 
+    void QueueManagedTextureUpload(D3D9CommonTexture* pResource);
+
+    void PrefetchManagedTextures();
+
     void GenerateTextureMips(uint32_t mask);
 
     void MarkTextureMipsDirty(D3D9CommonTexture* pResource);
@@ -842,6 +844,11 @@ namespace dxvk {
     template <D3D9RenderStateItem Item>
     void UpdatePushConstant();
 
+    static void SetSpecConstant(
+            DxvkContext*          ctx,
+            D3D9SpecConstantId    id,
+            uint32_t              value);
+
     void BindSampler(DWORD Sampler);
 
     void BindTexture(DWORD SamplerSampler);
@@ -863,6 +870,11 @@ namespace dxvk {
 
     void PrepareDraw(D3DPRIMITIVETYPE PrimitiveType);
 
+    template <D3D9CmdType Type>
+    void EmitDraw(
+            D3DPRIMITIVETYPE                  PrimitiveType,
+      const D3D9CmdDrawArgs&                  Args);
+
     template <DxsoProgramType ShaderStage>
     void BindShader(
       const D3D9CommonShader*                 pShaderModule,
@@ -907,6 +919,8 @@ namespace dxvk {
       return !m_d3d9Options.memoryTrackTest || availableMemory >= delta;
     }
 
+    void DequeueManagedTextureUpload(D3D9CommonTexture* pResource);
+
     void ResolveZ();
 
     void TransitionImage(D3D9CommonTexture* pResource, VkImageLayout NewLayout);
@@ -926,7 +940,7 @@ namespace dxvk {
     HRESULT InitialReset(D3DPRESENT_PARAMETERS* pPresentationParameters, D3DDISPLAYMODEEX* pFullscreenDisplayMode);
 
     UINT GetSamplerCount() const {
-      return m_samplerCount.load();
+      return UINT(m_dxvkDevice->getStatCounters().getCtr(DxvkStatCounter::SamplerCount));
     }
 
   private:
@@ -938,6 +952,8 @@ namespace dxvk {
 
     template<typename Cmd>
     void EmitCs(Cmd&& command) {
+      m_cmdData = nullptr;
+
       if (unlikely(!m_csChunk->push(command))) {
         EmitCsChunk(std::move(m_csChunk));
 
@@ -946,12 +962,30 @@ namespace dxvk {
       }
     }
 
+    template<typename M, typename Cmd, typename... Args>
+    M* EmitCsCmd(Cmd&& command, Args&&... args) {
+      M* data = m_csChunk->pushCmd<M, Cmd, Args...>(
+        command, std::forward<Args>(args)...);
+
+      if (unlikely(!data)) {
+        EmitCsChunk(std::move(m_csChunk));
+
+        m_csChunk = AllocCsChunk();
+        data = m_csChunk->pushCmd<M, Cmd, Args...>(
+          command, std::forward<Args>(args)...);
+      }
+
+      m_cmdData = data;
+      return data;
+    }
+
     void EmitCsChunk(DxvkCsChunkRef&& chunk);
 
     void FlushCsChunk() {
       if (likely(!m_csChunk->empty())) {
         EmitCsChunk(std::move(m_csChunk));
         m_csChunk = AllocCsChunk();
+        m_cmdData = nullptr;
       }
     }
 
@@ -1173,6 +1207,11 @@ namespace dxvk {
 
     DxvkStagingBuffer               m_stagingBuffer;
 
+    // Managed textures with pending uploads that get
+    // prefetched at the end of a frame, see EndFrame
+    std::vector<D3D9CommonTexture*> m_managedUploadQueue;
+    uint64_t                        m_frameCounter = 0;
+
     D3D9Cursor                      m_cursor;
 
     Com<D3D9Surface, false>         m_autoDepthStencil;
@@ -1182,12 +1221,6 @@ namespace dxvk {
     const D3D9Options               m_d3d9Options;
     DxsoOptions                     m_dxsoOptions;
 
-    std::unordered_map<
-      D3D9SamplerKey,
-      Rc<DxvkSampler>,
-      D3D9SamplerKeyHash,
-      D3D9SamplerKeyEq>             m_samplers;
-
     std::unordered_map<
       DWORD,
       Com<D3D9VertexDecl,
@@ -1263,15 +1296,14 @@ namespace dxvk {
     D3D9ViewportInfo                m_viewportInfo;
 
     DxvkCsChunkPool                 m_csChunkPool;
-    dxvk::high_resolution_clock::time_point m_lastFlush
-      = dxvk::high_resolution_clock::now();
+    DxvkFlushTracker                m_flushTracker;
     DxvkCsThread                    m_csThread;
     DxvkCsChunkRef                  m_csChunk;
+    D3D9CmdData*                    m_cmdData = nullptr;
     uint64_t                        m_csSeqNum = 0ull;
     bool                            m_csIsBusy = false;
 
     std::atomic<int64_t>            m_availableMemory = { 0 };
-    std::atomic<int32_t>            m_samplerCount    = { 0 };
 
     Direct3DState9                  m_state;
 
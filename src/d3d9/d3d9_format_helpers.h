@@ -2,6 +2,7 @@
 
 #include "d3d9_include.h"
 #include "d3d9_format.h"
+#include "../dxso/dxso_util.h"
 #include "../dxvk/dxvk_device.h"
 #include "../dxvk/dxvk_context.h"
 
@@ -13,9 +14,17 @@ namespace dxvk {
 
     D3D9FormatHelper(const Rc<DxvkDevice>& device);
 
-    void Flush();
-
+    /**
+     * \brief Records a format conversion
+     *
+     * Must be called on the CS thread. The conversion is recorded
+     * into the given context along with all other commands of the
+     * frame, so no separate submission or synchronization is needed.
+     * Note that this overrides the compute shader, its resources and
+     * the first eight bytes of push constant data.
+     */
     void ConvertFormat(
+            DxvkContext*                  ctx,
             D3D9_CONVERSION_FORMAT_INFO   conversionFormat,
       const Rc<DxvkImage>&                dstImage,
             VkImageSubresourceLayers      dstSubresource,
@@ -24,6 +33,7 @@ namespace dxvk {
   private:
 
     void ConvertGenericFormat(
+            DxvkContext*                  ctx,
             D3D9_CONVERSION_FORMAT_INFO   videoFormat,
       const Rc<DxvkImage>&                dstImage,
             VkImageSubresourceLayers      dstSubresource,
@@ -32,21 +42,23 @@ namespace dxvk {
             uint32_t                      specConstantValue,
             VkExtent2D                    macroPixelRun);
 
+    // Conversions are recorded into the same context as draws, and
+    // resource slots are shared between all shader stages, so these
+    // must not alias any slot used by D3D9 graphics shaders. They
+    // also have to match the bindings declared in the shaders.
     enum BindingIds : uint32_t {
-      Image  = 0,
-      Buffer = 1,
+      Image  = 32,
+      Buffer = 33,
     };
 
+    static_assert(BindingIds::Image > getSWVPBufferSlot(),
+      "Format conversion slots alias D3D9 shader slots");
+
     void InitShaders();
 
     Rc<DxvkShader> InitShader(SpirvCodeBuffer code);
 
-    void FlushInternal();
-
     Rc<DxvkDevice>    m_device;
-    Rc<DxvkContext>   m_context;
-
-    size_t            m_transferCommands = 0;
 
     std::array<Rc<DxvkShader>, D3D9ConversionFormat_Count> m_shaders;
 
@@ -74,6 +74,8 @@ namespace dxvk {
     this->deviceLocalConstantBuffers    = config.getOption<bool>        ("d3d9.deviceLocalConstantBuffers",    false);
     this->allowDirectBufferMapping      = config.getOption<bool>        ("d3d9.allowDirectBufferMapping",      true);
     this->seamlessCubes                 = config.getOption<bool>        ("d3d9.seamlessCubes",                 false);
+    this->batchDraws                    = config.getOption<bool>        ("d3d9.batchDraws",                    true);
+    this->managedUploadBudget           = config.getOption<int32_t>     ("d3d9.managedUploadBudget",           16);
 
     // If we are not Nvidia, enable general hazards.
     this->generalHazards = adapter != nullptr
@@ -160,6 +160,15 @@ namespace dxvk {
 
     /// Don't use non seamless cube maps
     bool seamlessCubes;
+
+    /// Merge consecutive draws without state changes
+    /// in between into a single CS command
+    bool batchDraws;
+
+    /// Amount of managed texture data, in MiB, that may be uploaded
+    /// ahead of time at the end of a frame. Textures written in an
+    /// earlier frame are uploaded before they are needed for a draw.
+    int32_t managedUploadBudget;
   };
 
 }
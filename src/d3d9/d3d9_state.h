@@ -44,8 +44,14 @@ namespace dxvk {
     float pointScaleA  = 1.0f;
     float pointScaleB  = 0.0f;
     float pointScaleC  = 0.0f;
+
+    // Spec constant values for pipelines
+    // that do not use specialization
+    std::array<uint32_t, MaxNumSpecConstants> specConstants = { };
   };
 
+  static_assert(sizeof(D3D9RenderStateInfo) <= MaxPushConstantSize);
+
   enum class D3D9RenderStateItem {
     FogColor   = 0,
     FogScale   = 1,
@@ -60,6 +66,8 @@ namespace dxvk {
     PointScaleB,
     PointScaleC,
 
+    SpecConstants,
+
     Count
   };
 
@@ -11,6 +11,25 @@
 
 namespace dxvk {
 
+  template <size_t Bits>
+  static void BuildConstantRanges(
+          bit::bitset<Bits>&               Captures,
+          std::vector<D3D9ConstantRange>&  Ranges) {
+    Ranges.clear();
+
+    for (uint32_t i = 0; i < Captures.dwordCount(); i++) {
+      for (uint32_t consts : bit::BitMask(Captures.dword(i))) {
+        uint32_t idx = i * 32 + consts;
+
+        if (!Ranges.empty() && Ranges.back().start + Ranges.back().count == idx)
+          Ranges.back().count += 1;
+        else
+          Ranges.push_back({ idx, 1u });
+      }
+    }
+  }
+
+
   D3D9StateBlock::D3D9StateBlock(D3D9DeviceEx* pDevice, D3D9StateBlockType Type)
     : D3D9StateBlockBase(pDevice)
     , m_deviceState     (pDevice->GetRawState()) {
@@ -306,6 +325,16 @@ namespace dxvk {
   }
 
 
+  void D3D9StateBlock::UpdateConstantRanges() {
+    BuildConstantRanges(m_captures.vsConsts.fConsts, m_vsConstRanges.fConsts);
+    BuildConstantRanges(m_captures.vsConsts.iConsts, m_vsConstRanges.iConsts);
+    BuildConstantRanges(m_captures.psConsts.fConsts, m_psConstRanges.fConsts);
+    BuildConstantRanges(m_captures.psConsts.iConsts, m_psConstRanges.iConsts);
+
+    m_constRangesDirty = false;
+  }
+
+
   void D3D9StateBlock::CapturePixelRenderStates() {
     m_captures.flags.set(D3D9CapturedStateFlag::RenderStates);
 
@@ -402,6 +431,8 @@ namespace dxvk {
     m_captures.psConsts.fConsts.setAll();
     m_captures.psConsts.iConsts.setAll();
     m_captures.psConsts.bConsts.setAll();
+
+    m_constRangesDirty = true;
   }
 
 
@@ -478,6 +509,8 @@ namespace dxvk {
 
     for (uint32_t i = 0; i < m_parent->GetVertexConstantLayout().bitmaskCount; i++)
       m_captures.vsConsts.bConsts.dword(i) = std::numeric_limits<uint32_t>::max();
+
+    m_constRangesDirty = true;
   }
 
 
@@ -63,6 +63,27 @@ namespace dxvk {
     } psConsts;
   };
 
+  /**
+   * \brief Contiguous range of captured constant registers
+   */
+  struct D3D9ConstantRange {
+    uint32_t start;
+    uint32_t count;
+  };
+
+  /**
+   * \brief Compact list of captured constant registers
+   *
+   * Built from the capture bitsets whenever those change,
+   * so that applying or capturing a state block can set each
+   * run of registers with a single call rather than walking
+   * the bitsets and setting one register at a time.
+   */
+  struct D3D9ConstantRanges {
+    std::vector<D3D9ConstantRange> fConsts;
+    std::vector<D3D9ConstantRange> iConsts;
+  };
+
   enum class D3D9StateBlockType :uint32_t {
     None,
     VertexState,
@@ -253,21 +274,11 @@ namespace dxvk {
       }
 
       if (m_captures.flags.test(D3D9CapturedStateFlag::VsConstants)) {
-        for (uint32_t i = 0; i < m_captures.vsConsts.fConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.vsConsts.fConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
-
-            dst->SetVertexShaderConstantF(idx, (float*)&src->vsConsts.fConsts[idx], 1);
-          }
-        }
-
-        for (uint32_t i = 0; i < m_captures.vsConsts.iConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.vsConsts.iConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
+        for (const auto& range : m_vsConstRanges.fConsts)
+          dst->SetVertexShaderConstantF(range.start, (float*)&src->vsConsts.fConsts[range.start], range.count);
 
-            dst->SetVertexShaderConstantI(idx, (int*)&src->vsConsts.iConsts[idx], 1);
-          }
-        }
+        for (const auto& range : m_vsConstRanges.iConsts)
+          dst->SetVertexShaderConstantI(range.start, (int*)&src->vsConsts.iConsts[range.start], range.count);
 
         if (m_captures.vsConsts.bConsts.any()) {
           for (uint32_t i = 0; i < m_captures.vsConsts.bConsts.dwordCount(); i++)
@@ -276,21 +287,11 @@ namespace dxvk {
       }
 
       if (m_captures.flags.test(D3D9CapturedStateFlag::PsConstants)) {
-        for (uint32_t i = 0; i < m_captures.psConsts.fConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.psConsts.fConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
+        for (const auto& range : m_psConstRanges.fConsts)
+          dst->SetPixelShaderConstantF(range.start, (float*)&src->psConsts.fConsts[range.start], range.count);
 
-            dst->SetPixelShaderConstantF(idx, (float*)&src->psConsts.fConsts[idx], 1);
-          }
-        }
-
-        for (uint32_t i = 0; i < m_captures.psConsts.iConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.psConsts.iConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
-
-            dst->SetPixelShaderConstantI(idx, (int*)&src->psConsts.iConsts[idx], 1);
-          }
-        }
+        for (const auto& range : m_psConstRanges.iConsts)
+          dst->SetPixelShaderConstantI(range.start, (int*)&src->psConsts.iConsts[range.start], range.count);
 
         if (m_captures.psConsts.bConsts.any()) {
           for (uint32_t i = 0; i < m_captures.psConsts.bConsts.dwordCount(); i++)
@@ -301,6 +302,9 @@ namespace dxvk {
 
     template <D3D9StateFunction Func>
     void ApplyOrCapture() {
+      if (unlikely(m_constRangesDirty))
+        UpdateConstantRanges();
+
       if      constexpr (Func == D3D9StateFunction::Apply)
         ApplyOrCapture(m_parent, &m_state);
       else if constexpr (Func == D3D9StateFunction::Capture)
@@ -324,9 +328,9 @@ namespace dxvk {
         for (uint32_t i = 0; i < Count; i++) {
           uint32_t reg = StartRegister + i;
           if      constexpr (ConstantType == D3D9ConstantType::Float)
-            setCaptures.fConsts.set(reg, true);
+            m_constRangesDirty |= !setCaptures.fConsts.exchange(reg, true);
           else if constexpr (ConstantType == D3D9ConstantType::Int)
-            setCaptures.iConsts.set(reg, true);
+            m_constRangesDirty |= !setCaptures.iConsts.exchange(reg, true);
           else if constexpr (ConstantType == D3D9ConstantType::Bool)
             setCaptures.bConsts.set(reg, true);
         }
@@ -368,9 +372,15 @@ namespace dxvk {
 
     void CaptureType(D3D9StateBlockType State);
 
+    void UpdateConstantRanges();
+
     D3D9CapturableState  m_state;
     D3D9StateCaptures    m_captures;
 
+    D3D9ConstantRanges   m_vsConstRanges;
+    D3D9ConstantRanges   m_psConstRanges;
+    bool                 m_constRangesDirty = false;
+
     D3D9CapturableState* m_deviceState;
 
     bool                 m_applying = false;
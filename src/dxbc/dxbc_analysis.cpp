@@ -50,6 +50,11 @@ namespace dxvk {
           m_analysis->usesKill = true;
       } break;
       
+      case DxbcInstClass::HullShaderPhase: {
+        m_functionId += 1;
+        m_controlFlowDepth = 0;
+      } break;
+      
       case DxbcInstClass::BufferLoad: {
         uint32_t operandId = ins.op == DxbcOpcode::LdStructured ? 2 : 1;
 
@@ -81,12 +86,142 @@ namespace dxvk {
         break;
     }
 
-    for (uint32_t i = 0; i < ins.dstCount; i++) {
-      if (ins.dst[0].type == DxbcOperandType::IndexableTemp) {
-        uint32_t index = ins.dst[0].idx[0].offset;
-        m_analysis->xRegMasks[index] |= ins.dst[0].mask;
+    // Subroutines are emitted as separate functions
+    if (ins.op == DxbcOpcode::Label) {
+      m_functionId += 1;
+      m_controlFlowDepth = 0;
+    }
+    
+    // Source operands are read before any destination
+    // operand gets written, so process them first
+    for (uint32_t i = 0; i < ins.srcCount; i++)
+      this->processOperand(ins.src[i], false);
+    
+    // The compiler may store the results of atomics inside
+    // a conditional block, so treat them like nested code
+    const bool isConditional = ins.opClass == DxbcInstClass::Atomic
+                            || ins.opClass == DxbcInstClass::AtomicCounter;
+    
+    m_controlFlowDepth += isConditional ? 1 : 0;
+    
+    for (uint32_t i = 0; i < ins.dstCount; i++)
+      this->processOperand(ins.dst[i], true);
+    
+    m_controlFlowDepth -= isConditional ? 1 : 0;
+    
+    switch (ins.op) {
+      case DxbcOpcode::If:
+      case DxbcOpcode::Loop:
+      case DxbcOpcode::Switch:
+        m_controlFlowDepth += 1;
+        break;
+      
+      case DxbcOpcode::EndIf:
+      case DxbcOpcode::EndLoop:
+      case DxbcOpcode::EndSwitch:
+        if (m_controlFlowDepth)
+          m_controlFlowDepth -= 1;
+        break;
+      
+      case DxbcOpcode::Ret:
+        // A return outside of control flow ends the function
+        if (!m_controlFlowDepth)
+          m_functionId += 1;
+        break;
+      
+      default:
+        break;
+    }
+  }
+  
+  
+  void DxbcAnalyzer::processOperand(
+    const DxbcRegister&       reg,
+          bool                isDst) {
+    // Relative indices are always read
+    for (uint32_t i = 0; i < reg.idxDim; i++) {
+      if (reg.idx[i].relReg != nullptr)
+        this->processOperand(*reg.idx[i].relReg, false);
+    }
+    
+    switch (reg.type) {
+      case DxbcOperandType::Temp:
+        this->processTempAccess(reg, isDst);
+        break;
+      
+      case DxbcOperandType::IndexableTemp:
+        this->processXregAccess(reg, isDst);
+        break;
+      
+      default:
+        break;
+    }
+  }
+  
+  
+  void DxbcAnalyzer::processTempAccess(
+    const DxbcRegister&       reg,
+          bool                isDst) {
+    const uint32_t regIdx = reg.idx[0].offset;
+    
+    if (regIdx >= m_tempUsage.size()) {
+      m_tempUsage.resize(regIdx + 1);
+      m_analysis->rRegSsaMasks.resize(regIdx + 1);
+    }
+    
+    DxbcTempUsage& usage = m_tempUsage[regIdx];
+    
+    // The compiler only reads components selected by both
+    // the swizzle and the write mask of the instruction,
+    // but taking the entire swizzle is good enough here.
+    uint32_t mask = 0;
+    
+    for (uint32_t i = 0; i < 4; i++) {
+      mask |= isDst
+        ? (reg.mask[i] ? 1u << i : 0u)
+        : (1u << reg.swizzle[i]);
+    }
+    
+    for (uint32_t i = 0; i < 4; i++) {
+      const uint32_t bit = 1u << i;
+      
+      if (!(mask & bit))
+        continue;
+      
+      if (isDst) {
+        // Only values that are written once in straight-line
+        // code dominate all subsequent reads in the function
+        if ((usage.written & bit) || m_controlFlowDepth)
+          usage.invalid |= bit;
+        
+        usage.written |= bit;
+        usage.function[i] = m_functionId;
+      } else {
+        if (!(usage.written & bit) || usage.function[i] != m_functionId)
+          usage.invalid |= bit;
       }
     }
+    
+    m_analysis->rRegSsaMasks[regIdx] = DxbcRegMask(
+      uint32_t(usage.written & ~usage.invalid));
+  }
+  
+  
+  void DxbcAnalyzer::processXregAccess(
+    const DxbcRegister&       reg,
+          bool                isDst) {
+    const uint32_t regIdx = reg.idx[0].offset;
+    
+    if (regIdx >= m_analysis->xRegInfos.size())
+      m_analysis->xRegInfos.resize(regIdx + 1);
+    
+    DxbcXregInfo& info = m_analysis->xRegInfos[regIdx];
+    
+    if (reg.idx[1].relReg != nullptr)
+      info.dynamicIndex = true;
+    
+    if (isDst)
+      info.componentMask |= reg.mask;
   }
   
   
@@ -30,12 +30,43 @@ namespace dxvk {
     uint32_t numCullPlanes = 0;
   };
   
+  /**
+   * \brief Info about indexable temp arrays
+   * 
+   * Stores which components of an x# array are
+   * written, and whether the array is ever accessed
+   * with a dynamic index. If not, the array can be
+   * replaced with one variable per element.
+   */
+  struct DxbcXregInfo {
+    DxbcRegMask componentMask;
+    bool        dynamicIndex = false;
+  };
+  
+  /**
+   * \brief Temp register usage
+   * 
+   * Tracks component writes to an r# register. A
+   * component becomes invalid for SSA if it is written
+   * more than once or inside a control flow block, or
+   * read before being written in the same function.
+   */
+  struct DxbcTempUsage {
+    uint8_t written = 0;
+    uint8_t invalid = 0;
+    std::array<uint32_t, 4> function = { };
+  };
+  
   /**
    * \brief Shader analysis info
    */
   struct DxbcAnalysisInfo {
     std::array<DxbcUavInfo, 64> uavInfos;
-    std::array<DxbcRegMask, 4096> xRegMasks;
+    std::vector<DxbcXregInfo> xRegInfos;
+    
+    /// Components of r# registers that can
+    /// be emitted as SSA values, per register
+    std::vector<DxbcRegMask> rRegSsaMasks;
     
     DxbcClipCullInfo clipCullIn;
     DxbcClipCullInfo clipCullOut;
@@ -80,6 +111,23 @@ namespace dxvk {
     
     DxbcAnalysisInfo* m_analysis = nullptr;
     
+    std::vector<DxbcTempUsage> m_tempUsage;
+    
+    uint32_t m_functionId       = 0;
+    uint32_t m_controlFlowDepth = 0;
+    
+    void processOperand(
+      const DxbcRegister&       reg,
+            bool                isDst);
+    
+    void processTempAccess(
+      const DxbcRegister&       reg,
+            bool                isDst);
+    
+    void processXregAccess(
+      const DxbcRegister&       reg,
+            bool                isDst);
+    
     DxbcClipCullInfo getClipCullInfo(
       const Rc<DxbcIsgn>& sgn) const;
     
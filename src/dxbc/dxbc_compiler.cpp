@@ -255,6 +255,7 @@ namespace dxvk {
     info.outputMask = m_outputMask;
     info.uniformSize = m_immConstData.size();
     info.uniformData = m_immConstData.data();
+    info.optimize = m_moduleInfo.options.optimizeSpirv;
 
     if (m_programInfo.type() == DxbcProgramType::PixelShader && m_ps.pushConstantId)
       info.pushConstSize = sizeof(DxbcPushConstants);
@@ -386,21 +387,38 @@ namespace dxvk {
     //    always 4 in fxc-generated binaries and therefore useless.
     const uint32_t regId = ins.imm[0].u32;
 
+    DxbcXregInfo xRegInfo;
+
+    if (regId < m_analysis->xRegInfos.size())
+      xRegInfo = m_analysis->xRegInfos[regId];
+
     DxbcRegisterInfo info;
     info.type.ctype   = DxbcScalarType::Float32;
-    info.type.ccount  = m_analysis->xRegMasks.at(regId).minComponents();
+    info.type.ccount  = xRegInfo.componentMask.minComponents();
     info.type.alength = ins.imm[1].u32;
     info.sclass       = spv::StorageClassPrivate;
 
     if (regId >= m_xRegs.size())
       m_xRegs.resize(regId + 1);
     
-    m_xRegs.at(regId).ccount = info.type.ccount;
-    m_xRegs.at(regId).alength = info.type.alength;
-    m_xRegs.at(regId).varId  = emitNewVariable(info);
-    
-    m_module.setDebugName(m_xRegs.at(regId).varId,
-      str::format("x", regId).c_str());
+    DxbcXreg& xReg = m_xRegs.at(regId);
+    xReg.ccount  = info.type.ccount;
+    xReg.alength = info.type.alength;
+    xReg.varId   = 0;
+
+    // Arrays that are only accessed with constant indices
+    // are declared as one variable per element, which are
+    // created on demand when the element is accessed.
+    xReg.scalarized = m_moduleInfo.options.promoteRegisters
+                   && !xRegInfo.dynamicIndex;
+    xReg.elementIds.clear();
+
+    if (!xReg.scalarized) {
+      xReg.varId = emitNewVariable(info);
+
+      m_module.setDebugName(xReg.varId,
+        str::format("x", regId).c_str());
+    }
   }
   
   
@@ -5584,11 +5602,11 @@ namespace dxvk {
     } else if (reg.type == DxbcOperandType::ConstantBuffer) {
       return emitConstantBufferLoad(reg, writeMask);
     } else {
-      // Load operand from the operand pointer
-      DxbcRegisterValue result = emitRegisterLoadRaw(reg);
-      
-      // Apply operand swizzle to the operand value
-      result = emitRegisterSwizzle(result, reg.swizzle, writeMask);
+      // Load operand from the operand pointer and apply the operand
+      // swizzle. Temps may have components stored as SSA values.
+      DxbcRegisterValue result = reg.type == DxbcOperandType::Temp
+        ? emitTempLoad(reg, writeMask)
+        : emitRegisterSwizzle(emitRegisterLoadRaw(reg), reg.swizzle, writeMask);
       
       // Cast it to the requested type. We need to do
       // this after the swizzling for 64-bit types.
@@ -5629,12 +5647,132 @@ namespace dxvk {
       } else {
         emitValueStore(getIndexableTempPtr(reg, vectorId), value, reg.mask);
       }
+    } else if (reg.type == DxbcOperandType::Temp) {
+      emitTempStore(reg, value);
     } else {
       emitValueStore(emitGetOperandPtr(reg), value, reg.mask);
     }
   }
   
   
+  DxbcRegisterValue DxbcCompiler::emitTempLoad(
+    const DxbcRegister&           reg,
+          DxbcRegMask             writeMask) {
+    const uint32_t regIdx = reg.idx[0].offset;
+    const DxbcRegMask ssaMask = getTempSsaMask(regIdx);
+    
+    if (!ssaMask) {
+      return emitRegisterSwizzle(
+        emitValueLoad(emitGetTempPtr(reg)),
+        reg.swizzle, writeMask);
+    }
+    
+    // Gather the selected components from SSA values where
+    // possible, and only load the variable if necessary.
+    DxbcRegisterValue varValue;
+    varValue.id = 0;
+    
+    std::array<uint32_t, 4> ids;
+    uint32_t count = 0;
+    
+    for (uint32_t i = 0; i < 4; i++) {
+      if (!writeMask[i])
+        continue;
+      
+      const uint32_t component = reg.swizzle[i];
+      uint32_t id = 0;
+      
+      if (ssaMask[component] && regIdx < m_rSsaIds.size())
+        id = m_rSsaIds[regIdx][component];
+      
+      if (!id) {
+        if (!varValue.id)
+          varValue = emitValueLoad(emitGetTempPtr(reg));
+        
+        id = emitRegisterExtract(varValue,
+          DxbcRegMask::select(component)).id;
+      }
+      
+      ids[count++] = id;
+    }
+    
+    DxbcRegisterValue result;
+    result.type.ctype  = DxbcScalarType::Float32;
+    result.type.ccount = count;
+    result.id = count > 1
+      ? m_module.opCompositeConstruct(
+          getVectorTypeId(result.type),
+          count, ids.data())
+      : ids[0];
+    return result;
+  }
+  
+  
+  void DxbcCompiler::emitTempStore(
+    const DxbcRegister&           reg,
+          DxbcRegisterValue       value) {
+    const uint32_t regIdx = reg.idx[0].offset;
+    const DxbcRegMask ssaMask = getTempSsaMask(regIdx);
+    
+    bool hasSsaComponents = false;
+    
+    for (uint32_t i = 0; i < 4; i++)
+      hasSsaComponents |= reg.mask[i] && ssaMask[i];
+    
+    if (!hasSsaComponents) {
+      emitValueStore(emitGetTempPtr(reg), value, reg.mask);
+      return;
+    }
+    
+    // Same conversions as emitValueStore
+    // would perform on the source value
+    if (value.type.ctype != DxbcScalarType::Float32)
+      value = emitRegisterBitcast(value, DxbcScalarType::Float32);
+    
+    if (value.type.ccount == 1)
+      value = emitRegisterExtend(value, reg.mask.popCount());
+    
+    if (regIdx >= m_rSsaIds.size())
+      m_rSsaIds.resize(regIdx + 1, std::array<uint32_t, 4>());
+    
+    // Record SSA components and store the
+    // remaining ones to the register variable
+    std::array<uint32_t, 4> varIds;
+    uint32_t varCount = 0;
+    uint32_t srcIndex = 0;
+    
+    DxbcRegMask varMask;
+    
+    for (uint32_t i = 0; i < 4; i++) {
+      if (!reg.mask[i])
+        continue;
+      
+      uint32_t id = emitRegisterExtract(value,
+        DxbcRegMask::select(srcIndex++)).id;
+      
+      if (ssaMask[i]) {
+        m_rSsaIds[regIdx][i] = id;
+      } else {
+        varIds[varCount++] = id;
+        varMask |= DxbcRegMask::select(i);
+      }
+    }
+    
+    if (varCount) {
+      DxbcRegisterValue varValue;
+      varValue.type.ctype  = DxbcScalarType::Float32;
+      varValue.type.ccount = varCount;
+      varValue.id = varCount > 1
+        ? m_module.opCompositeConstruct(
+            getVectorTypeId(varValue.type),
+            varCount, varIds.data())
+        : varIds[0];
+      
+      emitValueStore(emitGetTempPtr(reg), varValue, varMask);
+    }
+  }
+  
+  
   void DxbcCompiler::emitInputSetup() {
     m_module.setLateConst(m_vArrayLengthId, &m_vArrayLength);
 
@@ -7636,23 +7774,53 @@ namespace dxvk {
     //    (1) element index (relative)
     const uint32_t regId = operand.idx[0].offset;
     
+    DxbcXreg& xReg = m_xRegs.at(regId);
+
     DxbcRegisterInfo info;
     info.type.ctype   = DxbcScalarType::Float32;
-    info.type.ccount  = m_xRegs[regId].ccount;
+    info.type.ccount  = xReg.ccount;
     info.type.alength = 0;
     info.sclass       = spv::StorageClassPrivate;
     
     DxbcRegisterPointer result;
     result.type.ctype  = info.type.ctype;
     result.type.ccount = info.type.ccount;
-    result.id = m_module.opAccessChain(
-      getPointerTypeId(info),
-      m_xRegs.at(regId).varId,
-      1, &vectorId.id);
+
+    if (xReg.scalarized) {
+      // The analyzer guarantees that the index is constant
+      const uint32_t elementId = operand.idx[1].offset;
+
+      if (elementId >= xReg.elementIds.size())
+        xReg.elementIds.resize(elementId + 1, 0u);
+
+      if (!xReg.elementIds[elementId]) {
+        xReg.elementIds[elementId] = emitNewVariable(info);
+
+        m_module.setDebugName(xReg.elementIds[elementId],
+          str::format("x", regId, "_", elementId).c_str());
+      }
+
+      result.id = xReg.elementIds[elementId];
+    } else {
+      result.id = m_module.opAccessChain(
+        getPointerTypeId(info), xReg.varId,
+        1, &vectorId.id);
+    }
 
     return result;
   }
 
+
+  DxbcRegMask DxbcCompiler::getTempSsaMask(
+          uint32_t                regIdx) const {
+    if (!m_moduleInfo.options.promoteRegisters)
+      return DxbcRegMask();
+
+    return regIdx < m_analysis->rRegSsaMasks.size()
+      ? m_analysis->rRegSsaMasks[regIdx]
+      : DxbcRegMask();
+  }
+
   bool DxbcCompiler::caseBlockIsFallthrough() const {
     return m_lastOp != DxbcOpcode::Case
         && m_lastOp != DxbcOpcode::Default
@@ -86,6 +86,11 @@ namespace dxvk {
     uint32_t ccount  = 0;
     uint32_t alength = 0;
     uint32_t varId   = 0;
+    
+    /// Per-element variables for arrays that
+    /// are never accessed with dynamic indices
+    bool                  scalarized = false;
+    std::vector<uint32_t> elementIds;
   };
   
   
@@ -419,6 +424,11 @@ namespace dxvk {
     std::vector<uint32_t> m_rRegs;
     std::vector<DxbcXreg> m_xRegs;
     
+    /////////////////////////////////////////////////
+    // SSA value IDs for r# register components that
+    // are only written once, see DxbcAnalysisInfo.
+    std::vector<std::array<uint32_t, 4>> m_rSsaIds;
+    
     /////////////////////////////////////////////
     // Thread group shared memory (g#) registers
     std::vector<DxbcGreg> m_gRegs;
@@ -999,6 +1009,14 @@ namespace dxvk {
       const DxbcRegister&           reg,
             DxbcRegisterValue       value);
     
+    DxbcRegisterValue emitTempLoad(
+      const DxbcRegister&           reg,
+            DxbcRegMask             writeMask);
+    
+    void emitTempStore(
+      const DxbcRegister&           reg,
+            DxbcRegisterValue       value);
+    
     ////////////////////////////
     // Input/output preparation
     void emitInputSetup();
@@ -1213,6 +1231,9 @@ namespace dxvk {
     DxbcRegisterPointer getIndexableTempPtr(
       const DxbcRegister&           operand,
             DxbcRegisterValue       vectorId);
+    
+    DxbcRegMask getTempSsaMask(
+            uint32_t                regIdx) const;
 
     bool caseBlockIsFallthrough() const;
 
@@ -40,11 +40,18 @@ namespace dxvk {
   }
   
   
-  Rc<DxvkShader> DxbcModule::compile(
-    const DxbcModuleInfo& moduleInfo,
-    const std::string&    fileName) const {
+  DxbcCodeSlice DxbcModule::code() const {
     if (m_shexChunk == nullptr)
-      throw DxvkError("DxbcModule::compile: No SHDR/SHEX chunk");
+      throw DxvkError("DxbcModule::code: No SHDR/SHEX chunk");
+    
+    return m_shexChunk->slice();
+  }
+  
+  
+  DxbcAnalysisInfo DxbcModule::analyze(
+    const DxbcModuleInfo& moduleInfo) const {
+    if (m_shexChunk == nullptr)
+      throw DxvkError("DxbcModule::analyze: No SHDR/SHEX chunk");
     
     DxbcAnalysisInfo analysisInfo;
     
@@ -54,6 +61,17 @@ namespace dxvk {
       m_psgnChunk, analysisInfo);
     
     this->runAnalyzer(analyzer, m_shexChunk->slice());
+    return analysisInfo;
+  }
+  
+  
+  Rc<DxvkShader> DxbcModule::compile(
+    const DxbcModuleInfo& moduleInfo,
+    const std::string&    fileName) const {
+    if (m_shexChunk == nullptr)
+      throw DxvkError("DxbcModule::compile: No SHDR/SHEX chunk");
+    
+    DxbcAnalysisInfo analysisInfo = this->analyze(moduleInfo);
     
     DxbcCompiler compiler(
       fileName, moduleInfo,
@@ -17,6 +17,8 @@ namespace dxvk {
   class DxbcAnalyzer;
   class DxbcCompiler;
   
+  struct DxbcAnalysisInfo;
+  
   /**
    * \brief DXBC shader module
    * 
@@ -48,6 +50,26 @@ namespace dxvk {
     Rc<DxbcIsgn> isgn() const { return m_isgnChunk; }
     Rc<DxbcIsgn> osgn() const { return m_osgnChunk; }
     
+    /**
+     * \brief Instruction stream
+     * 
+     * Raw tokens of the SHDR/SHEX chunk. The
+     * slice must not outlive the module.
+     * \returns Instruction tokens
+     */
+    DxbcCodeSlice code() const;
+    
+    /**
+     * \brief Runs the analysis pass
+     * 
+     * Called internally by \c compile. Exposed
+     * so that tests can inspect the results.
+     * \param [in] moduleInfo DXBC module info
+     * \returns Analysis info
+     */
+    DxbcAnalysisInfo analyze(
+      const DxbcModuleInfo& moduleInfo) const;
+    
     /**
      * \brief Compiles DXBC shader to SPIR-V module
      * 
@@ -40,6 +40,8 @@ namespace dxvk {
     zeroInitWorkgroupMemory  = options.zeroInitWorkgroupMemory;
     forceTgsmBarriers        = options.forceTgsmBarriers;
     disableMsaa              = options.disableMsaa;
+    optimizeSpirv            = device->config().optimizeSpirv;
+    promoteRegisters         = options.promoteShaderRegisters;
 
     // Figure out float control flags to match D3D11 rules
     if (options.floatControls) {
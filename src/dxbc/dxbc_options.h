@@ -52,6 +52,13 @@ namespace dxvk {
     /// Replace ld_ms with ld
     bool disableMsaa = false;
 
+    /// Run the SPIR-V optimizer on the generated code
+    bool optimizeSpirv = false;
+
+    /// Emit single-assignment temps as SSA values and
+    /// split x# arrays that use constant indices only
+    bool promoteRegisters = false;
+
     /// Float control flags
     DxbcFloatControlFlags floatControl;
 
@@ -1,13 +1,12 @@
 #include "dxso_compiler.h"
 
 #include "dxso_analysis.h"
+#include "dxso_util.h"
 
 #include "../d3d9/d3d9_caps.h"
 #include "../d3d9/d3d9_constant_set.h"
 #include "../d3d9/d3d9_state.h"
 #include "../d3d9/d3d9_spec_constants.h"
-#include "../d3d9/d3d9_fixed_function.h"
-#include "dxso_util.h"
 
 #include "../dxvk/dxvk_spec_const.h"
 
@@ -50,6 +49,9 @@ namespace dxvk {
     for (uint32_t i = 0; i < m_cFloat.size(); i++)
       m_cFloat.at(i) = 0;
 
+    for (uint32_t i = 0; i < m_cFloatIndex.size(); i++)
+      m_cFloatIndex.at(i) = 0;
+
     for (uint32_t i = 0; i < m_cInt.size(); i++)
       m_cInt.at(i)   = 0;
 
@@ -213,6 +215,8 @@ namespace dxvk {
     else
       this->emitPsFinalize();
 
+    this->emitConstantIndicesF();
+
     // Declare the entry point, we now have all the
     // information we need, including the interfaces
     m_module.addEntryPoint(m_entryPointId,
@@ -252,6 +256,8 @@ namespace dxvk {
     info.outputMask = m_outputMask;
     info.pushConstOffset = m_pushConstOffset;
     info.pushConstSize = m_pushConstSize;
+    info.pushConstStages = VK_SHADER_STAGE_ALL_GRAPHICS;
+    info.optimize = m_moduleInfo.options.optimizeSpirv;
 
     return new DxvkShader(info, m_module.compile());
   }
@@ -269,14 +275,6 @@ namespace dxvk {
       this->emitDclConstantBuffer();
     }
 
-    m_nullSpecConstant = m_module.specConst32(m_module.defIntType(32, 0), 0);
-    m_module.decorateSpecId(m_nullSpecConstant, D3D9SpecConstantId::SamplerNull);
-    m_module.setDebugName(m_nullSpecConstant, "nullSamplers");
-
-    m_depthSpecConstant = m_module.specConst32(m_module.defIntType(32, 0), 0);
-    m_module.decorateSpecId(m_depthSpecConstant, D3D9SpecConstantId::SamplerDepthMode);
-    m_module.setDebugName(m_depthSpecConstant, "depthSamplers");
-
     this->emitDclInputArray();
 
     // Initialize the shader module with capabilities
@@ -337,13 +335,6 @@ namespace dxvk {
     binding.viewType        = VK_IMAGE_VIEW_TYPE_MAX_ENUM;
     binding.access          = VK_ACCESS_UNIFORM_READ_BIT;
     m_bindings.push_back(binding);
-
-    m_boolSpecConstant = m_module.specConst32(m_module.defIntType(32, 0), 0);
-    m_module.decorateSpecId(m_boolSpecConstant,
-      m_programInfo.type() == DxsoProgramType::VertexShader
-      ? D3D9SpecConstantId::VertexShaderBools
-      : D3D9SpecConstantId::PixelShaderBools);
-    m_module.setDebugName(m_boolSpecConstant, "boolConstants");
   }
 
   template<DxsoConstantBufferType ConstantBufferType>
@@ -532,22 +523,6 @@ namespace dxvk {
     m_ps.functionId = m_module.allocateId();
     m_module.setDebugName(m_ps.functionId, "ps_main");
 
-    if (m_programInfo.majorVersion() < 2 || m_moduleInfo.options.forceSamplerTypeSpecConstants) {
-      m_ps.samplerTypeSpec = m_module.specConst32(m_module.defIntType(32, 0), 0);
-      m_module.decorateSpecId(m_ps.samplerTypeSpec, D3D9SpecConstantId::SamplerType);
-      m_module.setDebugName(m_ps.samplerTypeSpec, "s_sampler_types");
-
-      if (m_programInfo.majorVersion() < 2) {
-        m_ps.projectionSpec = m_module.specConst32(m_module.defIntType(32, 0), 0);
-        m_module.decorateSpecId(m_ps.projectionSpec, D3D9SpecConstantId::ProjectionType);
-        m_module.setDebugName(m_ps.projectionSpec, "s_projections");
-      }
-    }
-
-    m_ps.fetch4Spec = m_module.specConst32(m_module.defIntType(32, 0), 0);
-    m_module.decorateSpecId(m_ps.fetch4Spec, D3D9SpecConstantId::Fetch4);
-    m_module.setDebugName(m_ps.fetch4Spec, "s_fetch4");
-
     this->setupRenderStateInfo();
     this->emitPsSharedConstants();
 
@@ -873,6 +848,49 @@ namespace dxvk {
   }
 
 
+  uint32_t DxsoCompiler::getConstantIndexF(
+            uint32_t          idx) {
+    // Constants outside the range of the shader stage are never
+    // uploaded. Disable packing so that they remain out of bounds
+    // of the buffer, and let robustness handle the access.
+    if (idx >= m_layout->floatCount || idx >= m_cFloatIndex.size()) {
+      m_cFloatPackable = false;
+      return this->emitArrayIndex(idx, nullptr);
+    }
+
+    // The final buffer index depends on which other constants
+    // the shader reads, so use a placeholder for the time being
+    uint32_t& indexId = m_cFloatIndex[idx];
+
+    if (!indexId) {
+      indexId = m_module.lateConst32(getScalarTypeId(DxsoScalarType::Sint32));
+      m_meta.constantMaskF.set(idx, true);
+    }
+
+    return indexId;
+  }
+
+
+  void DxsoCompiler::emitConstantIndicesF() {
+    // If no float constant is indexed dynamically, we can pack all
+    // constants that the shader reads into a contiguous range, so
+    // that the frontend only needs to upload the data we need.
+    m_meta.packedConstantsF     = m_cFloatPackable && !isSwvp();
+    m_meta.packedConstantCountF = 0;
+
+    for (uint32_t i = 0; i < m_cFloatIndex.size(); i++) {
+      if (!m_cFloatIndex[i])
+        continue;
+
+      uint32_t index = m_meta.packedConstantsF
+        ? m_meta.packedConstantCountF++
+        : i;
+
+      m_module.setLateConst(m_cFloatIndex[i], &index);
+    }
+  }
+
+
   DxsoRegisterPointer DxsoCompiler::emitInputPtr(
             bool              texture,
       const DxsoBaseRegister& reg,
@@ -970,9 +988,13 @@ namespace dxvk {
           m_meta.maxConstIndexF = std::max(m_meta.maxConstIndexF, reg.id.num + 1);
           m_meta.maxConstIndexF = std::min(m_meta.maxConstIndexF, m_layout->floatCount);
         } else {
+          // a0 and aL are only known at run time and are not bounded,
+          // so a relative read may hit any constant of the stage. We
+          // cannot pack anything then, and upload the entire range.
           m_meta.maxConstIndexF = m_layout->floatCount;
           m_meta.needsConstantCopies |= m_moduleInfo.options.strictConstantCopies
                                      || m_cFloat.at(reg.id.num) != 0;
+          m_cFloatPackable = false;
         }
         break;
       
@@ -990,7 +1012,9 @@ namespace dxvk {
       default: break;
     }
 
-    uint32_t relativeIdx = this->emitArrayIndex(reg.id.num, relative);
+    uint32_t relativeIdx = reg.id.type == DxsoRegisterType::Const && !relative && !isSwvp()
+      ? this->getConstantIndexF(reg.id.num)
+      : this->emitArrayIndex(reg.id.num, relative);
 
     if (reg.id.type != DxsoRegisterType::ConstBool) {
       uint32_t structIdx;
@@ -1058,8 +1082,12 @@ namespace dxvk {
 
         bitfield = m_module.opLoad(accessType, ptrId);
       }
-      else
-        bitfield = m_boolSpecConstant;
+      else {
+        bitfield = m_spec.get(m_module, m_rsBlock,
+          m_programInfo.type() == DxsoProgramType::VertexShader
+            ? D3D9SpecConstantId::VertexShaderBools
+            : D3D9SpecConstantId::PixelShaderBools);
+      }
 
       uint32_t bitIdx = m_module.consti32(reg.id.num % 32);
 
@@ -2789,7 +2817,7 @@ void DxsoCompiler::emitControlFlowGenericLoop(
       uint32_t bool_t = m_module.defBoolType();
 
       uint32_t shouldProj = m_module.opBitFieldUExtract(
-        m_module.defIntType(32, 0), m_ps.projectionSpec,
+        m_module.defIntType(32, 0), m_spec.get(m_module, m_rsBlock, D3D9SpecConstantId::ProjectionType),
         m_module.consti32(samplerIdx), m_module.consti32(1));
 
       shouldProj = m_module.opIEqual(bool_t, shouldProj, m_module.constu32(1));
@@ -2956,7 +2984,7 @@ void DxsoCompiler::emitControlFlowGenericLoop(
       uint32_t fetch4 = 0;
       if (m_programInfo.type() == DxsoProgramType::PixelShader && samplerType != SamplerTypeTexture3D) {
         fetch4 = m_module.opBitFieldUExtract(
-          m_module.defIntType(32, 0), m_ps.fetch4Spec,
+          m_module.defIntType(32, 0), m_spec.get(m_module, m_rsBlock, D3D9SpecConstantId::Fetch4),
           m_module.consti32(samplerIdx), m_module.consti32(1));
 
         uint32_t bool_t = m_module.defBoolType();
@@ -2989,7 +3017,7 @@ void DxsoCompiler::emitControlFlowGenericLoop(
           imageOperands);
 
         uint32_t shouldProj = m_module.opBitFieldUExtract(
-          m_module.defIntType(32, 0), m_ps.projectionSpec,
+          m_module.defIntType(32, 0), m_spec.get(m_module, m_rsBlock, D3D9SpecConstantId::ProjectionType),
           m_module.consti32(samplerIdx), m_module.consti32(1));
 
         shouldProj = m_module.opIEqual(m_module.defBoolType(), shouldProj, m_module.constu32(1));
@@ -3052,7 +3080,8 @@ void DxsoCompiler::emitControlFlowGenericLoop(
       uint32_t offset  = m_module.consti32(m_programInfo.type() == DxsoProgramTypes::VertexShader ? samplerIdx + 17 : samplerIdx);
       uint32_t bitCnt  = m_module.consti32(1);
 
-      uint32_t isNull = m_module.opBitFieldUExtract(typeId, m_nullSpecConstant, offset, bitCnt);
+      uint32_t isNull = m_module.opBitFieldUExtract(typeId,
+        m_spec.get(m_module, m_rsBlock, D3D9SpecConstantId::SamplerNull), offset, bitCnt);
       isNull = m_module.opIEqual(m_module.defBoolType(), isNull, m_module.constu32(1));
 
       // Only do the check for depth comp. samplers
@@ -3062,7 +3091,8 @@ void DxsoCompiler::emitControlFlowGenericLoop(
         uint32_t depthLabel  = m_module.allocateId();
         uint32_t endLabel    = m_module.allocateId();
 
-        uint32_t isDepth = m_module.opBitFieldUExtract(typeId, m_depthSpecConstant, offset, bitCnt);
+        uint32_t isDepth = m_module.opBitFieldUExtract(typeId,
+          m_spec.get(m_module, m_rsBlock, D3D9SpecConstantId::SamplerDepthMode), offset, bitCnt);
         isDepth = m_module.opIEqual(m_module.defBoolType(), isDepth, m_module.constu32(1));
 
         m_module.opSelectionMerge(endLabel, spv::SelectionControlMaskNone);
@@ -3102,7 +3132,8 @@ void DxsoCompiler::emitControlFlowGenericLoop(
 
       uint32_t offset  = m_module.consti32(samplerIdx * 2);
       uint32_t bitCnt  = m_module.consti32(2);
-      uint32_t type    = m_module.opBitFieldUExtract(typeId, m_ps.samplerTypeSpec, offset, bitCnt);
+      uint32_t type    = m_module.opBitFieldUExtract(typeId,
+        m_spec.get(m_module, m_rsBlock, D3D9SpecConstantId::SamplerType), offset, bitCnt);
 
       m_module.opSelectionMerge(switchEndLabel, spv::SelectionControlMaskNone);
       m_module.opSwitch(type,
@@ -3366,7 +3397,7 @@ void DxsoCompiler::emitControlFlowGenericLoop(
 
     if (m_programInfo.type() == DxsoProgramType::PixelShader) {
       pointCoord = GetPointCoord(m_module);
-      pointInfo  = GetPointSizeInfoPS(m_module, m_rsBlock);
+      pointInfo  = GetPointSizeInfoPS(m_module, m_spec, m_rsBlock);
     }
 
     for (uint32_t i = 0; i < m_isgn.elemCount; i++) {
@@ -3596,7 +3627,7 @@ void DxsoCompiler::emitControlFlowGenericLoop(
     if (!outputtedColor1)
       OutputDefault(DxsoSemantic{ DxsoUsage::Color, 1 });
 
-    auto pointInfo = GetPointSizeInfoVS(m_module, m_vs.oPos.id, 0, 0, m_rsBlock, false);
+    auto pointInfo = GetPointSizeInfoVS(m_module, m_spec, m_vs.oPos.id, 0, 0, m_rsBlock, false);
 
     if (m_vs.oPSize.id == 0) {
       m_vs.oPSize = this->emitRegisterPtr(
@@ -3696,30 +3727,13 @@ void DxsoCompiler::emitControlFlowGenericLoop(
 
 
   void DxsoCompiler::setupRenderStateInfo() {
-    uint32_t count;
-
-    // Only need alpha ref for PS 3.
-    // No FF fog component.
-    if (m_programInfo.type() == DxsoProgramType::PixelShader) {
-      if (m_programInfo.majorVersion() == 3) {
-        m_pushConstOffset = offsetof(D3D9RenderStateInfo, alphaRef);
-        m_pushConstSize   = sizeof(float);
-      }
-      else {
-        m_pushConstOffset = 0;
-        m_pushConstSize   = offsetof(D3D9RenderStateInfo, pointSize);
-      }
-
-      count = 5;
-    }
-    else {
-      m_pushConstOffset = offsetof(D3D9RenderStateInfo, pointSize);
-      // Point scale never triggers on programmable
-      m_pushConstSize   = sizeof(float) * 3;
-      count = 8;
-    }
+    // All stages must declare the same push constant range in order to
+    // be usable as pipeline libraries, and spec constant values may be
+    // read from the end of the block in any stage.
+    m_pushConstOffset = 0;
+    m_pushConstSize   = sizeof(D3D9RenderStateInfo);
 
-    m_rsBlock = SetupRenderStateBlock(m_module, count);
+    m_rsBlock = SetupRenderStateBlock(m_module);
   }
 
 
@@ -3748,7 +3762,7 @@ void DxsoCompiler::emitControlFlowGenericLoop(
     fogCtx.HasSpecular = false;
     fogCtx.Specular    = 0;
 
-    m_module.opStore(oColor0Ptr.id, DoFixedFunctionFog(m_module, fogCtx));
+    m_module.opStore(oColor0Ptr.id, DoFixedFunctionFog(m_module, m_spec, fogCtx));
   }
 
   
@@ -3757,9 +3771,7 @@ void DxsoCompiler::emitControlFlowGenericLoop(
     uint32_t floatType = m_module.defFloatType(32);
     uint32_t floatPtr  = m_module.defPointerType(floatType, spv::StorageClassPushConstant);
     
-    uint32_t alphaFuncId = m_module.specConst32(m_module.defIntType(32, 0), 0);
-    m_module.setDebugName   (alphaFuncId, "alpha_func");
-    m_module.decorateSpecId (alphaFuncId, D3D9SpecConstantId::AlphaCompareOp);
+    uint32_t alphaFuncId = m_spec.get(m_module, m_rsBlock, D3D9SpecConstantId::AlphaCompareOp);
 
     // Implement alpha test and fog
     DxsoRegister color0;
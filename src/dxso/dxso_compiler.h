@@ -1,6 +1,7 @@
 #pragma once
 
 #include "dxso_decoder.h"
+#include "dxso_fixed_function.h"
 #include "dxso_header.h"
 #include "dxso_modinfo.h"
 #include "dxso_isgn.h"
@@ -155,9 +156,6 @@ namespace dxvk {
    */
   struct DxsoCompilerPsPart {
     uint32_t functionId         = 0;
-    uint32_t samplerTypeSpec    = 0;
-    uint32_t projectionSpec     = 0;
-    uint32_t fetch4Spec         = 0;
 
     //////////////
     // Misc Types
@@ -269,9 +267,7 @@ namespace dxvk {
 
     SpirvModule                m_module;
 
-    uint32_t                   m_boolSpecConstant;
-    uint32_t                   m_nullSpecConstant;
-    uint32_t                   m_depthSpecConstant;
+    D3D9ShaderSpecConstantManager m_spec;
 
     ///////////////////////////////////////////////////////
     // Resource slot description for the shader. This will
@@ -315,6 +311,12 @@ namespace dxvk {
     std::array<uint32_t, caps::MaxOtherConstantsSoftware> m_cInt;
     std::array<uint32_t, caps::MaxOtherConstantsSoftware> m_cBool;
 
+    ////////////////////////////////////////////////
+    // Buffer indices of float constants, resolved
+    // once we know which constants get packed
+    std::array<uint32_t, caps::MaxFloatConstantsVS> m_cFloatIndex;
+    bool m_cFloatPackable = true;
+
     //////////////////////
     // Loop counter
     DxsoRegisterPointer m_loopCounter;
@@ -715,6 +717,11 @@ namespace dxvk {
       return m_layout->bitmaskCount != 1;
     }
 
+    uint32_t getConstantIndexF(
+            uint32_t          idx);
+
+    void emitConstantIndicesF();
+
   };
 
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../d3d9/d3d9_spec_constants.h"
+
+#include "../dxvk/dxvk_limits.h"
+
+#include <array>
+#include <cstdint>
+
+namespace dxvk {
+
+  class SpirvModule;
+
+  // SPIR-V helpers for D3D9 render state, shared by the DXSO
+  // compiler and the fixed-function shader compiler. These are
+  // part of the DXSO library so that it can be linked without
+  // the rest of the D3D9 frontend.
+
+  struct D3D9FogContext {
+    // General inputs...
+    bool     IsPixel;
+    bool     RangeFog;
+    uint32_t RenderState;
+    uint32_t vPos;
+    uint32_t vFog;
+
+    uint32_t oColor;
+
+    bool     HasFogInput;
+
+    bool     IsFixedFunction;
+    bool     IsPositionT;
+    bool     HasSpecular;
+    uint32_t Specular;
+  };
+
+  /**
+   * \brief Specialization constant loader
+   *
+   * Optimized pipelines use the specialization constant
+   * values directly, whereas pipeline libraries are not
+   * specialized and read the values from the render state
+   * push constant block instead. Values must be loaded in
+   * the function that uses them.
+   */
+  class D3D9ShaderSpecConstantManager {
+
+  public:
+
+    uint32_t get(SpirvModule& spvModule, uint32_t rsBlock, D3D9SpecConstantId id);
+
+  private:
+
+    uint32_t m_specEnabled = 0;
+
+    std::array<uint32_t, MaxNumSpecConstants> m_specConstants = { };
+
+  };
+
+  // Returns new oFog if VS
+  // Returns new oColor if PS
+  uint32_t DoFixedFunctionFog(SpirvModule& spvModule, D3D9ShaderSpecConstantManager& spec, const D3D9FogContext& fogCtx);
+
+  // Returns a render state block
+  uint32_t SetupRenderStateBlock(SpirvModule& spvModule);
+
+  struct D3D9PointSizeInfoVS {
+    uint32_t defaultValue;
+    uint32_t min;
+    uint32_t max;
+  };
+
+  // Default point size and point scale magic!
+  D3D9PointSizeInfoVS GetPointSizeInfoVS(SpirvModule& spvModule, D3D9ShaderSpecConstantManager& spec, uint32_t vPos, uint32_t vtx, uint32_t perVertPointSize, uint32_t rsBlock, bool isFixedFunction);
+
+  struct D3D9PointSizeInfoPS {
+    uint32_t isSprite;
+  };
+
+  D3D9PointSizeInfoPS GetPointSizeInfoPS(SpirvModule& spvModule, D3D9ShaderSpecConstantManager& spec, uint32_t rsBlock);
+
+  uint32_t GetPointCoord(SpirvModule& spvModule);
+
+  uint32_t GetSharedConstants(SpirvModule& spvModule);
+
+}
@@ -2,6 +2,8 @@
 
 #include "dxso_decoder.h"
 
+#include "../d3d9/d3d9_caps.h"
+
 namespace dxvk {
 
   struct DxsoIsgnEntry {
@@ -36,6 +38,14 @@ namespace dxvk {
     uint32_t maxConstIndexB = 0;
 
     uint32_t boolConstantMask = 0;
+
+    // Float constants read with immediate indices. Unless
+    // the shader uses relative addressing, these are packed
+    // into consecutive registers in ascending order. A single
+    // relative read disables packing for the whole shader.
+    bool     packedConstantsF     = false;
+    uint32_t packedConstantCountF = 0;
+    bit::bitset<caps::MaxFloatConstantsVS> constantMaskF;
   };
 
 }
\ No newline at end of file
@@ -34,14 +34,14 @@ namespace dxvk {
     this->runCompiler(*compiler, m_code.iter());
     m_isgn = compiler->isgn();
 
+    compiler->finalize();
+
     m_meta            = compiler->meta();
     m_constants       = compiler->constants();
     m_maxDefinedConst = compiler->maxDefinedConstant();
     m_usedSamplers    = compiler->usedSamplers();
     m_usedRTs         = compiler->usedRTs();
 
-    compiler->finalize();
-
     return compiler->compile();
   }
 
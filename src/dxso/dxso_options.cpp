@@ -45,6 +45,8 @@ namespace dxvk {
     alphaTestWiggleRoom = options.alphaTestWiggleRoom;
 
     robustness2Supported = devFeatures.extRobustness2.robustBufferAccess2;
+
+    optimizeSpirv = device->config().optimizeSpirv;
   }
 
 }
\ No newline at end of file
@@ -57,6 +57,9 @@ namespace dxvk {
 
     /// Whether or not we can rely on robustness2 to handle oob constant access
     bool robustness2Supported;
+
+    /// Run the SPIR-V optimizer on the generated code
+    bool optimizeSpirv;
   };
 
 }
\ No newline at end of file
@@ -188,6 +188,10 @@ namespace dxvk {
   
   
   void DxvkCommandList::reset() {
+    // Return query handles and publish remaining results
+    // first, since releasing resources may recycle queries
+    m_gpuQueryTracker.reset();
+
     // Free resources and other objects
     // that are no longer in use
     m_resources.reset();
@@ -195,8 +199,10 @@ namespace dxvk {
     // Return buffer memory slices
     m_bufferTracker.reset();
 
-    // Return query and event handles
-    m_gpuQueryTracker.reset();
+    // Return renamed backing images
+    m_imageTracker.reset();
+
+    // Return event handles
     m_gpuEventTracker.reset();
 
     // Less important stuff
@@ -7,6 +7,7 @@
 #include "dxvk_descriptor.h"
 #include "dxvk_gpu_event.h"
 #include "dxvk_gpu_query.h"
+#include "dxvk_image.h"
 #include "dxvk_lifetime.h"
 #include "dxvk_limits.h"
 #include "dxvk_pipelayout.h"
@@ -137,6 +138,21 @@ namespace dxvk {
       m_bufferTracker.freeBufferSlice(buffer, slice);
     }
     
+    /**
+     * \brief Frees a backing image
+     * 
+     * After the command buffer execution has finished,
+     * the given backing image will be released to the
+     * image object so that it can be reused.
+     * \param [in] image The image object
+     * \param [in] physImage The backing image
+     */
+    void freePhysicalImage(
+      const Rc<DxvkImage>&            image,
+            DxvkPhysicalImage&&       physImage) {
+      m_imageTracker.freePhysicalImage(image, std::move(physImage));
+    }
+    
     /**
      * \brief Adds a resource to track
      * 
@@ -171,6 +187,20 @@ namespace dxvk {
     void trackGpuQuery(DxvkGpuQueryHandle handle) {
       m_gpuQueryTracker.trackQuery(handle);
     }
+
+    /**
+     * \brief Tracks copied query results
+     * 
+     * Marks the given queries as available once the
+     * command buffer has finished executing.
+     * \param [in] block Query block
+     * \param [in] mask Queries within the block
+     */
+    void trackGpuQueryResults(
+            DxvkGpuQueryBlock*  block,
+            uint64_t            mask) {
+      m_gpuQueryTracker.trackResults(block, mask);
+    }
     
     /**
      * \brief Queues signal
@@ -185,9 +215,10 @@ namespace dxvk {
     }
 
     /**
-     * \brief Notifies resources and signals
+     * \brief Notifies queries, resources and signals
      */
     void notifyObjects() {
+      m_gpuQueryTracker.notify();
       m_resources.notify();
       m_signalTracker.notify();
     }
@@ -751,13 +782,6 @@ namespace dxvk {
 
     void cmdInsertDebugUtilsLabel(VkDebugUtilsLabelEXT *pLabelInfo);
 
-    void resetQuery(
-            VkQueryPool             queryPool,
-            uint32_t                queryId) {
-      m_vkd->vkResetQueryPool(
-        m_vkd->device(), queryPool, queryId, 1);
-    }
-
     void trackDescriptorPool(
       const Rc<DxvkDescriptorPool>&       pool,
       const Rc<DxvkDescriptorManager>&    manager) {
@@ -788,6 +812,7 @@ namespace dxvk {
     DxvkGpuEventTracker m_gpuEventTracker;
     DxvkGpuQueryTracker m_gpuQueryTracker;
     DxvkBufferTracker   m_bufferTracker;
+    DxvkImageTracker    m_imageTracker;
     DxvkStatCounters    m_statCounters;
 
     std::vector<std::pair<
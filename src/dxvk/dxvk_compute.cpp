@@ -19,6 +19,7 @@ namespace dxvk {
   : m_device        (device),
     m_stateCache    (&pipeMgr->m_stateCache),
     m_stats         (&pipeMgr->m_stats),
+    m_codeCache     (&pipeMgr->m_codeCache),
     m_library       (library),
     m_libraryHandle (VK_NULL_HANDLE),
     m_shaders       (std::move(shaders)),
@@ -111,11 +112,15 @@ namespace dxvk {
     for (uint32_t i = 0; i < MaxNumSpecConstants; i++)
       specData.set(i, state.sc.specConstants[i], 0u);
 
+    // Shaders that also support pipeline libraries must
+    // use the actual spec constant values in this case
+    specData.set(DxvkSpecConstantEnableId, 1u);
+
     VkSpecializationInfo specInfo = specData.getSpecInfo();
     
     DxvkShaderStageInfo stageInfo(m_device);
     stageInfo.addStage(VK_SHADER_STAGE_COMPUTE_BIT, 
-      m_shaders.cs->getCode(m_bindings, DxvkShaderModuleCreateInfo()),
+      m_shaders.cs->getCode(m_bindings, DxvkShaderModuleCreateInfo(), m_codeCache),
       &specInfo);
 
     VkComputePipelineCreateInfo info = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
@@ -115,6 +115,7 @@ namespace dxvk {
     DxvkDevice*                 m_device;    
     DxvkStateCache*             m_stateCache;
     DxvkPipelineStats*          m_stats;
+    DxvkShaderCodeCache*        m_codeCache;
 
     DxvkShaderPipelineLibrary*  m_library;
     VkPipeline                  m_libraryHandle;
@@ -116,6 +116,16 @@ namespace dxvk {
     this->spillRenderPass(true);
     this->flushSharedImages();
 
+    // Copy results of all queries that ended in this
+    // command list to the host-visible result buffers
+    if (m_queryManager.copyQueryResults(m_cmd)) {
+      m_execBarriers.accessMemory(
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        VK_ACCESS_HOST_READ_BIT);
+    }
+
     m_sdmaBarriers.recordCommands(m_cmd);
     m_initBarriers.recordCommands(m_cmd);
     m_execBarriers.recordCommands(m_cmd);
@@ -541,8 +551,15 @@ namespace dxvk {
           VkDeviceSize          srcOffset,
           VkDeviceSize          rowAlignment,
           VkDeviceSize          sliceAlignment) {
-    this->spillRenderPass(true);
-    this->prepareImage(dstImage, vk::makeSubresourceRange(dstSubresource));
+    // If the image has not been used in the current command list, we can
+    // perform the upload in the init command buffer in order to avoid
+    // splitting the current render pass into two.
+    bool useInitBuffer = this->canCopyBufferToImageOutOfOrder(dstImage, srcBuffer);
+
+    if (!useInitBuffer) {
+      this->spillRenderPass(true);
+      this->prepareImage(dstImage, vk::makeSubresourceRange(dstSubresource));
+    }
 
     auto srcSlice = srcBuffer->getSliceHandle(srcOffset, 0);
 
@@ -553,10 +570,18 @@ namespace dxvk {
     auto dstSubresourceRange = vk::makeSubresourceRange(dstSubresource);
     dstSubresourceRange.aspectMask = dstFormatInfo->aspectMask;
     
-    if (m_execBarriers.isImageDirty(dstImage, dstSubresourceRange, DxvkAccess::Write)
-     || m_execBarriers.isBufferDirty(srcSlice, DxvkAccess::Read))
+    if (!useInitBuffer
+     && (m_execBarriers.isImageDirty(dstImage, dstSubresourceRange, DxvkAccess::Write)
+      || m_execBarriers.isBufferDirty(srcSlice, DxvkAccess::Read)))
       m_execBarriers.recordCommands(m_cmd);
 
+    DxvkCmdBuffer cmdBuffer = useInitBuffer
+      ? DxvkCmdBuffer::InitBuffer
+      : DxvkCmdBuffer::ExecBuffer;
+
+    auto& acquires = useInitBuffer ? m_initBarriers : m_execAcquires;
+    auto& barriers = useInitBuffer ? m_initBarriers : m_execBarriers;
+
     // Initialize the image if the entire subresource is covered
     VkImageLayout dstImageLayoutInitial  = dstImage->info().layout;
     VkImageLayout dstImageLayoutTransfer = dstImage->pickLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
@@ -565,7 +590,7 @@ namespace dxvk {
       dstImageLayoutInitial = VK_IMAGE_LAYOUT_UNDEFINED;
 
     if (dstImageLayoutTransfer != dstImageLayoutInitial) {
-      m_execAcquires.accessImage(
+      acquires.accessImage(
         dstImage, dstSubresourceRange,
         dstImageLayoutInitial,
         VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
@@ -574,12 +599,12 @@ namespace dxvk {
         VK_ACCESS_TRANSFER_WRITE_BIT);
     }
       
-    m_execAcquires.recordCommands(m_cmd);
+    acquires.recordCommands(m_cmd);
 
-    this->copyImageBufferData<true>(DxvkCmdBuffer::ExecBuffer, dstImage, dstSubresource,
+    this->copyImageBufferData<true>(cmdBuffer, dstImage, dstSubresource,
       dstOffset, dstExtent, dstImageLayoutTransfer, srcSlice, rowAlignment, sliceAlignment);
 
-    m_execBarriers.accessImage(
+    barriers.accessImage(
       dstImage, dstSubresourceRange,
       dstImageLayoutTransfer,
       VK_PIPELINE_STAGE_TRANSFER_BIT,
@@ -588,7 +613,7 @@ namespace dxvk {
       dstImage->info().stages,
       dstImage->info().access);
 
-    m_execBarriers.accessBuffer(srcSlice,
+    barriers.accessBuffer(srcSlice,
       VK_PIPELINE_STAGE_TRANSFER_BIT,
       VK_ACCESS_TRANSFER_READ_BIT,
       srcBuffer->info().stages,
@@ -1587,6 +1612,13 @@ namespace dxvk {
     if (imageView->info().numLevels <= 1)
       return;
     
+    // Use the compute path if possible, since it only needs
+    // one dispatch and barrier per six mip levels
+    if (canGenerateMipmapsCs(imageView, filter)) {
+      this->generateMipmapsCs(imageView);
+      return;
+    }
+
     this->spillRenderPass(false);
     this->invalidateState();
 
@@ -1790,6 +1822,34 @@ namespace dxvk {
   }
 
 
+  void DxvkContext::invalidateImage(
+    const Rc<DxvkImage>&            image,
+          DxvkPhysicalImage&&       physImage,
+          VkImageLayout             layout) {
+    DxvkPhysicalImage prevImage = image->rename(std::move(physImage));
+    m_cmd->freePhysicalImage(image, std::move(prevImage));
+
+    // Newly created backing images are still in their initial
+    // layout. Transitioning out of the preinitialized layout
+    // preserves any data that the host has written.
+    if (layout != image->info().layout) {
+      m_initBarriers.accessImage(image,
+        image->getAvailableSubresources(),
+        layout,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+        image->info().layout,
+        image->info().stages,
+        image->info().access);
+    }
+
+    // Views of the image need to be re-created, which
+    // happens when descriptors are written next time.
+    m_descriptorState.dirtyViews(util::shaderStages(image->info().stages));
+
+    m_cmd->trackResource<DxvkAccess::None>(image);
+  }
+
+
   void DxvkContext::pushConstants(
           uint32_t                  offset,
           uint32_t                  size,
@@ -3276,6 +3336,147 @@ namespace dxvk {
     m_cmd->trackResource<DxvkAccess::Write>(imageView->image());
   }
 
+
+  bool DxvkContext::canGenerateMipmapsCs(
+    const Rc<DxvkImageView>&    imageView,
+          VkFilter              filter) const {
+    if (filter != VK_FILTER_LINEAR
+     || imageView->info().aspect != VK_IMAGE_ASPECT_COLOR_BIT)
+      return false;
+
+    return DxvkMetaMipGenObjects::checkImageSupport(
+      m_device.ptr(), imageView->imageInfo(), imageView->info().format);
+  }
+
+
+  void DxvkContext::generateMipmapsCs(
+    const Rc<DxvkImageView>&    imageView) {
+    this->spillRenderPass(false);
+    this->invalidateState();
+
+    Rc<DxvkMetaMipGenViews> mipGenViews = new DxvkMetaMipGenViews(m_device->vkd(), imageView);
+
+    if (m_execBarriers.isImageDirty(imageView->image(), imageView->imageSubresources(), DxvkAccess::Write))
+      m_execBarriers.recordCommands(m_cmd);
+
+    // Keep all levels in the general layout while generating
+    // mips, so that no layout transitions between passes are
+    // required. Target levels get discarded.
+    VkImageSubresourceRange targetSubresources = imageView->imageSubresources();
+    targetSubresources.baseMipLevel += 1;
+    targetSubresources.levelCount -= 1;
+
+    m_execAcquires.accessImage(imageView->image(),
+      mipGenViews->getLevelSubresource(0),
+      imageView->imageInfo().layout,
+      imageView->imageInfo().stages,
+      imageView->imageInfo().access,
+      VK_IMAGE_LAYOUT_GENERAL,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_ACCESS_SHADER_READ_BIT);
+
+    m_execAcquires.accessImage(imageView->image(),
+      targetSubresources,
+      VK_IMAGE_LAYOUT_UNDEFINED,
+      imageView->imageInfo().stages, 0,
+      VK_IMAGE_LAYOUT_GENERAL,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_ACCESS_SHADER_WRITE_BIT);
+
+    m_execAcquires.recordCommands(m_cmd);
+
+    DxvkMetaMipGenPipeline pipeInfo = m_common->metaMipGen().getPipeline();
+
+    std::array<VkDescriptorImageInfo, DxvkMetaMipGenViews::MaxLevelsPerPass + 1> descriptorImages;
+
+    for (auto& descriptorImage : descriptorImages) {
+      descriptorImage.sampler     = VK_NULL_HANDLE;
+      descriptorImage.imageView   = VK_NULL_HANDLE;
+      descriptorImage.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    }
+
+    std::array<VkWriteDescriptorSet, 2> descriptorWrites;
+
+    for (uint32_t i = 0; i < descriptorWrites.size(); i++) {
+      descriptorWrites[i] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+      descriptorWrites[i].dstBinding      = i;
+      descriptorWrites[i].dstArrayElement = 0;
+      descriptorWrites[i].descriptorCount = i ? DxvkMetaMipGenViews::MaxLevelsPerPass : 1;
+      descriptorWrites[i].descriptorType  = i ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+      descriptorWrites[i].pImageInfo      = &descriptorImages[i];
+    }
+
+    m_cmd->cmdBindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, pipeInfo.pipeHandle);
+
+    for (uint32_t i = 0; i < mipGenViews->getPassCount(); i++) {
+      uint32_t baseLevel  = mipGenViews->getPassBaseLevel(i);
+      uint32_t levelCount = mipGenViews->getPassLevelCount(i);
+
+      // The last level written by the previous pass is the source
+      if (i) {
+        m_execAcquires.accessImage(imageView->image(),
+          mipGenViews->getLevelSubresource(baseLevel - 1),
+          VK_IMAGE_LAYOUT_GENERAL,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          VK_ACCESS_SHADER_WRITE_BIT,
+          VK_IMAGE_LAYOUT_GENERAL,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          VK_ACCESS_SHADER_READ_BIT);
+        m_execAcquires.recordCommands(m_cmd);
+      }
+
+      // Unused storage descriptors point to the last level that
+      // is actually written, the shader never accesses them
+      descriptorImages[0].imageView = mipGenViews->getSrcView(i);
+
+      for (uint32_t j = 0; j < DxvkMetaMipGenViews::MaxLevelsPerPass; j++)
+        descriptorImages[j + 1].imageView = mipGenViews->getDstView(baseLevel + std::min(j, levelCount - 1));
+
+      VkDescriptorSet descriptorSet = m_descriptorPool->alloc(pipeInfo.dsetLayout);
+
+      for (auto& descriptorWrite : descriptorWrites)
+        descriptorWrite.dstSet = descriptorSet;
+
+      m_cmd->updateDescriptorSets(descriptorWrites.size(), descriptorWrites.data());
+
+      VkExtent3D srcExtent = imageView->mipLevelExtent(baseLevel - 1);
+      VkExtent3D dstExtent = imageView->mipLevelExtent(baseLevel);
+
+      DxvkMetaMipGenPushConstants pushConstants;
+      pushConstants.srcExtent  = { srcExtent.width, srcExtent.height };
+      pushConstants.levelCount = levelCount;
+
+      VkExtent3D workgroups = util::computeBlockCount(dstExtent, pipeInfo.tileSize);
+
+      m_cmd->cmdBindDescriptorSet(VK_PIPELINE_BIND_POINT_COMPUTE,
+        pipeInfo.pipeLayout, descriptorSet, 0, nullptr);
+
+      m_cmd->cmdPushConstants(
+        pipeInfo.pipeLayout,
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0, sizeof(pushConstants),
+        &pushConstants);
+
+      m_cmd->cmdDispatch(
+        workgroups.width,
+        workgroups.height,
+        imageView->info().numLayers);
+    }
+
+    m_execBarriers.accessImage(imageView->image(),
+      imageView->imageSubresources(),
+      VK_IMAGE_LAYOUT_GENERAL,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_ACCESS_SHADER_READ_BIT |
+      VK_ACCESS_SHADER_WRITE_BIT,
+      imageView->imageInfo().layout,
+      imageView->imageInfo().stages,
+      imageView->imageInfo().access);
+
+    m_cmd->trackResource<DxvkAccess::None>(mipGenViews);
+    m_cmd->trackResource<DxvkAccess::Write>(imageView->image());
+  }
+
   
   void DxvkContext::copyImageHw(
     const Rc<DxvkImage>&        dstImage,
@@ -5802,6 +6003,26 @@ namespace dxvk {
   }
   
 
+  bool DxvkContext::canCopyBufferToImageOutOfOrder(
+      const Rc<DxvkImage>&            image,
+      const Rc<DxvkBuffer>&           buffer) const {
+    // The image must not be used by any command list, including the
+    // current one, and the source buffer must not be written by the
+    // GPU, since otherwise we would change the order of operations.
+    if (image->isInUse(DxvkAccess::Read) || buffer->isInUse(DxvkAccess::Write))
+      return false;
+
+    // Deferred clears are not tracked yet, but will be executed
+    // later, so they must not overwrite the uploaded data.
+    for (const auto& entry : m_deferredClears) {
+      if (entry.imageView->image() == image)
+        return false;
+    }
+
+    return true;
+  }
+
+
   DxvkGraphicsPipeline* DxvkContext::lookupGraphicsPipeline(
     const DxvkGraphicsPipelineShaders&  shaders) {
     auto idx = shaders.hash() % m_gpLookupCache.size();
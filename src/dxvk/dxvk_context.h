@@ -782,6 +782,25 @@ namespace dxvk {
       const Rc<DxvkBuffer>&           buffer,
       const DxvkBufferSliceHandle&    slice);
     
+    /**
+     * \brief Invalidates an image's contents
+     * 
+     * Discards an image's contents by replacing the
+     * backing image. This allows the host to write to
+     * a linear image while the GPU is still accessing
+     * the original backing image.
+     * 
+     * \warning If the image is used by another context,
+     * invalidating it will result in undefined behaviour.
+     * \param [in] image The image to invalidate
+     * \param [in] physImage New backing image
+     * \param [in] layout Current layout of the backing image
+     */
+    void invalidateImage(
+      const Rc<DxvkImage>&            image,
+            DxvkPhysicalImage&&       physImage,
+            VkImageLayout             layout);
+    
     /**
      * \brief Updates push constants
      * 
@@ -1220,6 +1239,13 @@ namespace dxvk {
             VkExtent3D            extent,
             VkClearValue          value);
     
+    bool canGenerateMipmapsCs(
+      const Rc<DxvkImageView>&    imageView,
+            VkFilter              filter) const;
+
+    void generateMipmapsCs(
+      const Rc<DxvkImageView>&    imageView);
+
     void copyImageHw(
       const Rc<DxvkImage>&        dstImage,
             VkImageSubresourceLayers dstSubresource,
@@ -1411,6 +1437,10 @@ namespace dxvk {
       const Rc<DxvkBuffer>&           buffer,
             VkDeviceSize              copySize);
 
+    bool canCopyBufferToImageOutOfOrder(
+      const Rc<DxvkImage>&            image,
+      const Rc<DxvkBuffer>&           buffer) const;
+
     DxvkGraphicsPipeline* lookupGraphicsPipeline(
       const DxvkGraphicsPipelineShaders&  shaders);
 
@@ -22,6 +22,7 @@ namespace dxvk {
     
     if (m_flags.test(DxvkCsChunkFlag::SingleUse)) {
       m_commandOffset = 0;
+      m_commandCount = 0;
       
       while (cmd != nullptr) {
         auto next = cmd->next();
@@ -54,6 +55,7 @@ namespace dxvk {
     m_tail = nullptr;
 
     m_commandOffset = 0;
+    m_commandCount = 0;
   }
   
   
@@ -127,6 +129,27 @@ namespace dxvk {
   }
   
   
+  uint64_t DxvkCsThread::dispatchChunks(
+          size_t            count,
+    const DxvkCsChunkRef*   chunks) {
+    if (!count)
+      return 0;
+
+    uint64_t seq;
+
+    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+      for (size_t i = 0; i < count; i++)
+        m_chunksQueued.push(chunks[i]);
+
+      seq = (m_chunksDispatched += count);
+    }
+
+    m_condOnAdd.notify_one();
+    return seq;
+  }
+  
+  
   void DxvkCsThread::synchronize(uint64_t seq) {
     // Avoid locking if we know the sync is a no-op, may
     // reduce overhead if this is being called frequently
@@ -179,6 +202,7 @@ namespace dxvk {
         
         if (chunk) {
           m_context->addStatCtr(DxvkStatCounter::CsChunkCount, 1);
+          m_context->addStatCtr(DxvkStatCounter::CsCommandCount, chunk->commandCount());
           chunk->executeAll(m_context.ptr());
         }
       }
@@ -152,6 +152,14 @@ namespace dxvk {
       return m_commandOffset == 0;
     }
 
+    /**
+     * \brief Number of recorded commands
+     * \returns Command count
+     */
+    uint32_t commandCount() const {
+      return m_commandCount;
+    }
+
     /**
      * \brief Tries to add a command to the chunk
      * 
@@ -180,6 +188,7 @@ namespace dxvk {
         m_head = m_tail;
       
       m_commandOffset += sizeof(FuncType);
+      m_commandCount += 1;
       return true;
     }
 
@@ -207,6 +216,7 @@ namespace dxvk {
       m_tail = func;
 
       m_commandOffset += sizeof(FuncType);
+      m_commandCount += 1;
       return func->data();
     }
     
@@ -237,6 +247,7 @@ namespace dxvk {
   private:
     
     size_t m_commandOffset = 0;
+    uint32_t m_commandCount = 0;
     
     DxvkCsCmd* m_head = nullptr;
     DxvkCsCmd* m_tail = nullptr;
@@ -399,6 +410,21 @@ namespace dxvk {
      */
     uint64_t dispatchChunk(DxvkCsChunkRef&& chunk);
     
+    /**
+     * \brief Dispatches multiple chunks
+     * 
+     * Queues all chunks at once, which is cheaper than
+     * dispatching them one by one when replaying command
+     * lists. The chunks are referenced, not consumed.
+     * \param [in] count Number of chunks
+     * \param [in] chunks The chunks to dispatch
+     * \returns Sequence number of the last chunk, or
+     *    \c 0 if no chunks were dispatched
+     */
+    uint64_t dispatchChunks(
+            size_t            count,
+      const DxvkCsChunkRef*   chunks);
+    
     /**
      * \brief Synchronizes with the thread
      * 
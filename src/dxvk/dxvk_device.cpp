@@ -125,7 +125,7 @@ namespace dxvk {
           VkQueryType           type,
           VkQueryControlFlags   flags,
           uint32_t              index) {
-    return new DxvkGpuQuery(m_vkd, type, flags, index);
+    return new DxvkGpuQuery(type, flags, index);
   }
   
   
@@ -165,12 +165,13 @@ namespace dxvk {
   
   Rc<DxvkSampler> DxvkDevice::createSampler(
     const DxvkSamplerCreateInfo&  createInfo) {
-    return new DxvkSampler(this, createInfo);
+    return m_objects.samplerPool().createSampler(createInfo);
   }
   
   
   DxvkStatCounters DxvkDevice::getStatCounters() {
     DxvkPipelineCount pipe = m_objects.pipelineManager().getPipelineCount();
+    DxvkShaderCodeCacheStats code = m_objects.pipelineManager().getShaderCodeCacheStats();
     
     DxvkStatCounters result;
     result.setCtr(DxvkStatCounter::PipeCountGraphics, pipe.numGraphicsPipelines);
@@ -178,6 +179,10 @@ namespace dxvk {
     result.setCtr(DxvkStatCounter::PipeCountCompute,  pipe.numComputePipelines);
     result.setCtr(DxvkStatCounter::PipeCompilerBusy,  m_objects.pipelineManager().isCompilingShaders());
     result.setCtr(DxvkStatCounter::GpuIdleTicks,      m_submissionQueue.gpuIdleTicks());
+    result.setCtr(DxvkStatCounter::SamplerCount,      m_objects.samplerPool().getSamplerCount());
+    result.setCtr(DxvkStatCounter::ShaderCodeCacheHits,   code.numHits);
+    result.setCtr(DxvkStatCounter::ShaderCodeCacheMisses, code.numMisses);
+    result.setCtr(DxvkStatCounter::ShaderCodeCacheSize,   code.memorySize);
 
     std::lock_guard<sync::Spinlock> lock(m_statLock);
     result.merge(m_statCounters);
@@ -200,6 +205,11 @@ namespace dxvk {
   }
   
   
+  void DxvkDevice::compileShader(const Rc<DxvkShaderCompileTask>& task) {
+    m_objects.pipelineManager().compileShader(task);
+  }
+  
+  
   void DxvkDevice::presentImage(
     const Rc<vk::Presenter>&        presenter,
           DxvkSubmitStatus*         status) {
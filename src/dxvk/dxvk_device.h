@@ -327,8 +327,10 @@ namespace dxvk {
     /**
      * \brief Creates a sampler object
      * 
+     * Samplers are cached, so this may return an
+     * existing object with identical properties.
      * \param [in] createInfo Sampler parameters
-     * \returns Newly created sampler object
+     * \returns Sampler object
      */
     Rc<DxvkSampler> createSampler(
       const DxvkSamplerCreateInfo&  createInfo);
@@ -363,6 +365,16 @@ namespace dxvk {
     void registerShader(
       const Rc<DxvkShader>&         shader);
     
+    /**
+     * \brief Compiles a shader on a worker thread
+     *
+     * Uses the same worker threads as pipeline
+     * compilation, see \ref DxvkShaderCompileTask.
+     * \param [in] task Shader compile task
+     */
+    void compileShader(
+      const Rc<DxvkShaderCompileTask>& task);
+    
     /**
      * \brief Presents a swap chain image
      * 
@@ -423,6 +435,16 @@ namespace dxvk {
       return m_submissionQueue.pendingSubmissions();
     }
 
+    /**
+     * \brief Total GPU idle time
+     *
+     * Only updated once the GPU stops being idle.
+     * \returns GPU idle time in microseconds
+     */
+    uint64_t gpuIdleTicks() const {
+      return m_submissionQueue.gpuIdleTicks();
+    }
+
     /**
      * \brief Increments a given stat counter
      *
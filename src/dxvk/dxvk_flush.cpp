@@ -0,0 +1,135 @@
+#include "dxvk_flush.h"
+
+namespace dxvk {
+
+  DxvkFlushTracker::DxvkFlushTracker(const Rc<DxvkDevice>& device)
+  : m_device(device), m_lastIdleTicks(device->gpuIdleTicks()) {
+
+  }
+
+
+  DxvkFlushTracker::~DxvkFlushTracker() {
+
+  }
+
+
+  bool DxvkFlushTracker::considerFlush(
+          bool                      strongHint,
+          uint64_t                  csQueueDepth) {
+    uint32_t pending = m_device->pendingSubmissions();
+
+    // The base policy only flushes if the GPU is about to go
+    // idle, and prevents flushing too often in short intervals.
+    uint32_t baseDelay = MinFlushIntervalUs
+                       + IncFlushIntervalUs * pending;
+    bool baseAllow = strongHint || pending <= MaxPendingSubmits;
+
+    DxvkFlushState state = determineState(pending);
+
+    uint32_t delay = baseDelay;
+    bool allow = baseAllow;
+
+    switch (state) {
+      case DxvkFlushState::Starving:
+        delay /= 2;
+        break;
+
+      case DxvkFlushState::Saturated:
+        delay *= 2;
+
+        if (!strongHint)
+          allow = pending <= MaxPendingSubmits / 2;
+        break;
+
+      case DxvkFlushState::Balanced:
+        // If the CS thread is lagging behind, the flush would
+        // not reach the GPU any sooner, so keep batching.
+        if (!strongHint && csQueueDepth > MaxCsQueueDepth)
+          allow = false;
+        break;
+    }
+
+    auto elapsed = dxvk::high_resolution_clock::now() - m_lastFlush;
+
+    bool flush = allow && elapsed >= std::chrono::microseconds(delay);
+    bool baseFlush = baseAllow && elapsed >= std::chrono::microseconds(baseDelay);
+
+    if (flush) {
+      m_device->addStatCtr(DxvkStatCounter::FlushImplicitCount, 1);
+
+      if (!baseFlush)
+        m_device->addStatCtr(DxvkStatCounter::FlushEarlyCount, 1);
+
+      logDecision(baseFlush ? "submit" : "submit early",
+        state, pending, csQueueDepth, delay);
+    } else if (baseFlush && !m_deferred) {
+      // Only count each deferred flush once, rather
+      // than once per call until we actually flush
+      m_device->addStatCtr(DxvkStatCounter::FlushDeferCount, 1);
+      m_deferred = true;
+
+      logDecision("defer", state, pending, csQueueDepth, delay);
+    }
+
+    return flush;
+  }
+
+
+  void DxvkFlushTracker::notifyFlush() {
+    auto now = dxvk::high_resolution_clock::now();
+
+    uint64_t idleTicks = m_device->gpuIdleTicks();
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastFlush).count();
+
+    // Idle time is only accounted for once the GPU receives
+    // new work, so a single idle period may be attributed
+    // to a later interval. Smooth this out over a few flushes.
+    if (elapsed) {
+      float fraction = std::min(1.0f, float(idleTicks - m_lastIdleTicks) / float(elapsed));
+      m_idleFraction = 0.75f * m_idleFraction + 0.25f * fraction;
+    }
+
+    m_lastIdleTicks = idleTicks;
+    m_lastFlush = now;
+    m_deferred = false;
+  }
+
+
+  DxvkFlushState DxvkFlushTracker::determineState(
+          uint32_t                  pending) const {
+    if (!pending || (pending == 1 && m_idleFraction >= StarvingIdleFraction))
+      return DxvkFlushState::Starving;
+
+    if (pending >= 2 && m_idleFraction <= SaturatedIdleFraction)
+      return DxvkFlushState::Saturated;
+
+    return DxvkFlushState::Balanced;
+  }
+
+
+  void DxvkFlushTracker::logDecision(
+          const char*               decision,
+          DxvkFlushState            state,
+          uint32_t                  pending,
+          uint64_t                  csQueueDepth,
+          uint32_t                  delay) const {
+    if (Logger::logLevel() > LogLevel::Trace)
+      return;
+
+    const char* stateName = "balanced";
+
+    switch (state) {
+      case DxvkFlushState::Balanced:  stateName = "balanced";  break;
+      case DxvkFlushState::Starving:  stateName = "starving";  break;
+      case DxvkFlushState::Saturated: stateName = "saturated"; break;
+    }
+
+    Logger::trace(str::format("Flush: ", decision,
+      " (GPU ", stateName,
+      ", idle: ", uint32_t(100.0f * m_idleFraction), "%",
+      ", pending: ", pending,
+      ", CS chunks: ", csQueueDepth,
+      ", interval: ", delay, " us)"));
+  }
+
+}
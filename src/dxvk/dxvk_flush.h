@@ -0,0 +1,94 @@
+#pragma once
+
+#include "dxvk_device.h"
+
+namespace dxvk {
+
+  /**
+   * \brief GPU utilization state
+   *
+   * Derived from the number of pending submissions
+   * and the measured GPU idle time between flushes.
+   */
+  enum class DxvkFlushState : uint32_t {
+    Balanced,   ///< Use default flush interval
+    Starving,   ///< GPU is or has been idle, flush early
+    Saturated,  ///< GPU is busy, batch more work
+  };
+
+
+  /**
+   * \brief Implicit flush tracker
+   *
+   * Implements the heuristic used to decide whether an
+   * immediate context should submit its command list
+   * when an implicit flush opportunity arises.
+   *
+   * The base flush interval grows with the number of
+   * pending submissions. It is reduced while the GPU
+   * is starving for work, and increased while the GPU
+   * is saturated or while the CS thread is lagging
+   * behind, in which case submitting early would not
+   * get any work to the GPU sooner anyway.
+   */
+  class DxvkFlushTracker {
+    constexpr static uint32_t MinFlushIntervalUs = 750;
+    constexpr static uint32_t IncFlushIntervalUs = 250;
+    constexpr static uint32_t MaxPendingSubmits  = 6;
+    constexpr static uint32_t MaxCsQueueDepth    = 8;
+
+    constexpr static float StarvingIdleFraction  = 0.05f;
+    constexpr static float SaturatedIdleFraction = 0.01f;
+  public:
+
+    DxvkFlushTracker(const Rc<DxvkDevice>& device);
+
+    ~DxvkFlushTracker();
+
+    /**
+     * \brief Checks whether to flush
+     *
+     * \param [in] strongHint Whether the caller is likely
+     *    going to wait for GPU work to complete soon
+     * \param [in] csQueueDepth Number of CS chunks that
+     *    have been dispatched but not yet executed
+     * \returns \c true if the context should be flushed
+     */
+    bool considerFlush(
+            bool                      strongHint,
+            uint64_t                  csQueueDepth);
+
+    /**
+     * \brief Notifies tracker about a flush
+     *
+     * Must be called whenever the context submits its
+     * command list, regardless of the reason. Resets
+     * the flush timer and samples GPU idle time.
+     */
+    void notifyFlush();
+
+  private:
+
+    Rc<DxvkDevice>  m_device;
+
+    uint64_t        m_lastIdleTicks = 0;
+    float           m_idleFraction  = 0.0f;
+
+    bool            m_deferred = false;
+
+    dxvk::high_resolution_clock::time_point m_lastFlush
+      = dxvk::high_resolution_clock::now();
+
+    DxvkFlushState determineState(
+            uint32_t                  pending) const;
+
+    void logDecision(
+            const char*               decision,
+            DxvkFlushState            state,
+            uint32_t                  pending,
+            uint64_t                  csQueueDepth,
+            uint32_t                  delay) const;
+
+  };
+
+}
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstring>
 
 #include "dxvk_cmdlist.h"
 #include "dxvk_device.h"
@@ -7,11 +8,10 @@
 namespace dxvk {
 
   DxvkGpuQuery::DxvkGpuQuery(
-    const Rc<vk::DeviceFn>&   vkd,
           VkQueryType         type,
           VkQueryControlFlags flags,
           uint32_t            index)
-  : m_vkd(vkd), m_type(type), m_flags(flags),
+  : m_type(type), m_flags(flags),
     m_index(index), m_ended(false) {
     
   }
@@ -88,18 +88,23 @@ namespace dxvk {
   DxvkGpuQueryStatus DxvkGpuQuery::getDataForHandle(
           DxvkQueryData&      queryData,
     const DxvkGpuQueryHandle& handle) const {
-    DxvkQueryData tmpData;
+    const DxvkGpuQueryBlock* block = handle.block;
 
-    // Try to copy query data to temporary structure
-    VkResult result = m_vkd->vkGetQueryPoolResults(m_vkd->device(),
-      handle.queryPool, handle.queryId, 1,
-      sizeof(DxvkQueryData), &tmpData,
-      sizeof(DxvkQueryData), VK_QUERY_RESULT_64_BIT);
-    
-    if (result == VK_NOT_READY)
-      return DxvkGpuQueryStatus::Pending;
-    else if (result != VK_SUCCESS)
+    // Query allocation may have failed to allocate a result block,
+    // in which case there is no way to ever retrieve the data
+    if (!block)
       return DxvkGpuQueryStatus::Failed;
+
+    uint32_t index = handle.queryId - block->queryIndex;
+
+    // Results only become visible to the host once the
+    // command list that copied them has completed
+    if (!(block->readyMask.load() & (1ull << index)))
+      return DxvkGpuQueryStatus::Pending;
+
+    DxvkQueryData tmpData;
+    std::memcpy(&tmpData, block->resultData + index * block->resultStride,
+      block->resultStride);
     
     // Add numbers to the destination structure
     switch (m_type) {
@@ -161,24 +166,36 @@ namespace dxvk {
   }
 
   
-  DxvkGpuQueryHandle DxvkGpuQueryAllocator::allocQuery() {
+  DxvkGpuQueryBlock* DxvkGpuQueryAllocator::allocBlock() {
     std::lock_guard<dxvk::mutex> lock(m_mutex);
 
-    if (m_handles.size() == 0)
+    if (m_freeBlocks.size() == 0)
       this->createQueryPool();
 
-    if (m_handles.size() == 0)
-      return DxvkGpuQueryHandle();
+    if (m_freeBlocks.size() == 0)
+      return nullptr;
     
-    DxvkGpuQueryHandle result = m_handles.back();
-    m_handles.pop_back();
-    return result;
+    DxvkGpuQueryBlock* block = m_freeBlocks.back();
+    m_freeBlocks.pop_back();
+
+    // None of the queries are in use by the GPU
+    // anymore, so we can reset them all at once
+    m_vkd->vkResetQueryPool(m_vkd->device(), block->queryPool,
+      block->queryIndex, DxvkGpuQueryBlock::QueryCount);
+
+    block->useCount.store(DxvkGpuQueryBlock::QueryCount);
+    block->readyMask.store(0ull);
+    return block;
   }
 
 
-  void DxvkGpuQueryAllocator::freeQuery(DxvkGpuQueryHandle handle) {
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
-    m_handles.push_back(handle);
+  void DxvkGpuQueryAllocator::freeQueries(
+          DxvkGpuQueryBlock*  block,
+          uint32_t            count) {
+    if (block->useCount.fetch_sub(count) == count) {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_freeBlocks.push_back(block);
+    }
   }
 
   
@@ -211,8 +228,53 @@ namespace dxvk {
 
     m_pools.push_back(queryPool);
 
-    for (uint32_t i = 0; i < m_queryPoolSize; i++)
-      m_handles.push_back({ this, queryPool, i });
+    // Create host-visible buffer for query results
+    VkDeviceSize resultSize = getResultSize();
+
+    DxvkBufferCreateInfo bufferInfo;
+    bufferInfo.size   = resultSize * m_queryPoolSize;
+    bufferInfo.usage  = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.stages = VK_PIPELINE_STAGE_TRANSFER_BIT
+                      | VK_PIPELINE_STAGE_HOST_BIT;
+    bufferInfo.access = VK_ACCESS_TRANSFER_WRITE_BIT
+                      | VK_ACCESS_HOST_READ_BIT;
+
+    Rc<DxvkBuffer> buffer = m_device->createBuffer(bufferInfo,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+      VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+
+    DxvkBufferSliceHandle bufferSlice = buffer->getSliceHandle();
+    m_buffers.push_back(buffer);
+
+    for (uint32_t i = 0; i < m_queryPoolSize; i += DxvkGpuQueryBlock::QueryCount) {
+      auto block = std::make_unique<DxvkGpuQueryBlock>();
+      block->queryPool    = queryPool;
+      block->queryIndex   = i;
+      block->resultBuffer = bufferSlice.handle;
+      block->resultOffset = bufferSlice.offset + resultSize * i;
+      block->resultStride = resultSize;
+      block->resultData   = reinterpret_cast<const char*>(buffer->mapPtr(resultSize * i));
+
+      m_freeBlocks.push_back(block.get());
+      m_blocks.push_back(std::move(block));
+    }
+  }
+
+
+  VkDeviceSize DxvkGpuQueryAllocator::getResultSize() const {
+    switch (m_queryType) {
+      case VK_QUERY_TYPE_OCCLUSION:
+        return sizeof(DxvkQueryOcclusionData);
+      case VK_QUERY_TYPE_PIPELINE_STATISTICS:
+        return sizeof(DxvkQueryStatisticData);
+      case VK_QUERY_TYPE_TIMESTAMP:
+        return sizeof(DxvkQueryTimestampData);
+      case VK_QUERY_TYPE_TRANSFORM_FEEDBACK_STREAM_EXT:
+        return sizeof(DxvkQueryXfbStreamData);
+      default:
+        return sizeof(DxvkQueryData);
+    }
   }
 
 
@@ -232,19 +294,19 @@ namespace dxvk {
   }
 
   
-  DxvkGpuQueryHandle DxvkGpuQueryPool::allocQuery(VkQueryType type) {
+  DxvkGpuQueryAllocator* DxvkGpuQueryPool::getAllocator(VkQueryType type) {
     switch (type) {
       case VK_QUERY_TYPE_OCCLUSION:
-        return m_occlusion.allocQuery();
+        return &m_occlusion;
       case VK_QUERY_TYPE_PIPELINE_STATISTICS:
-        return m_statistic.allocQuery();
+        return &m_statistic;
       case VK_QUERY_TYPE_TIMESTAMP:
-        return m_timestamp.allocQuery();
+        return &m_timestamp;
       case VK_QUERY_TYPE_TRANSFORM_FEEDBACK_STREAM_EXT:
-        return m_xfbStream.allocQuery();
+        return &m_xfbStream;
       default:
         Logger::err(str::format("DXVK: Unhandled query type: ", type));
-        return DxvkGpuQueryHandle();
+        return nullptr;
     }
   }
 
@@ -258,7 +320,11 @@ namespace dxvk {
 
   
   DxvkGpuQueryManager::~DxvkGpuQueryManager() {
-
+    // Return queries that were never handed out
+    for (const auto& range : m_ranges) {
+      if (range.block && range.next < DxvkGpuQueryBlock::QueryCount)
+        range.allocator->freeQueries(range.block, DxvkGpuQueryBlock::QueryCount - range.next);
+    }
   }
 
 
@@ -295,22 +361,21 @@ namespace dxvk {
   void DxvkGpuQueryManager::writeTimestamp(
     const Rc<DxvkCommandList>&  cmd,
     const Rc<DxvkGpuQuery>&     query) {
-    DxvkGpuQueryHandle handle = m_pool->allocQuery(query->type());
+    DxvkGpuQueryHandle handle = allocQuery(query->type());
     
     query->begin(cmd);
     query->addQueryHandle(handle);
     query->end();
 
-    cmd->resetQuery(
-      handle.queryPool,
-      handle.queryId);
-    
     cmd->cmdWriteTimestamp(
       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
       handle.queryPool,
       handle.queryId);
     
     cmd->trackResource<DxvkAccess::None>(query);
+
+    if (handle.block)
+      m_results.push_back(handle);
   }
 
 
@@ -341,11 +406,7 @@ namespace dxvk {
   void DxvkGpuQueryManager::beginSingleQuery(
     const Rc<DxvkCommandList>&  cmd,
     const Rc<DxvkGpuQuery>&     query) {
-    DxvkGpuQueryHandle handle = m_pool->allocQuery(query->type());
-    
-    cmd->resetQuery(
-      handle.queryPool,
-      handle.queryId);
+    DxvkGpuQueryHandle handle = allocQuery(query->type());
     
     if (query->isIndexed()) {
       cmd->cmdBeginQueryIndexed(
@@ -381,6 +442,86 @@ namespace dxvk {
     }
 
     cmd->trackResource<DxvkAccess::None>(query);
+
+    if (handle.block)
+      m_results.push_back(handle);
+  }
+
+
+  bool DxvkGpuQueryManager::copyQueryResults(
+    const Rc<DxvkCommandList>&  cmd) {
+    if (m_results.empty())
+      return false;
+
+    std::sort(m_results.begin(), m_results.end(),
+      [] (const DxvkGpuQueryHandle& a, const DxvkGpuQueryHandle& b) {
+        return a.block != b.block
+          ? std::less<DxvkGpuQueryBlock*>()(a.block, b.block)
+          : a.queryId < b.queryId;
+      });
+
+    size_t i = 0;
+
+    while (i < m_results.size()) {
+      const DxvkGpuQueryHandle& first = m_results[i];
+      DxvkGpuQueryBlock* block = first.block;
+
+      uint32_t count = 1;
+
+      while (i + count < m_results.size()
+          && m_results[i + count].block   == block
+          && m_results[i + count].queryId == first.queryId + count)
+        count += 1;
+
+      uint32_t index = first.queryId - block->queryIndex;
+
+      cmd->cmdCopyQueryPoolResults(block->queryPool,
+        first.queryId, count, block->resultBuffer,
+        block->resultOffset + block->resultStride * index,
+        block->resultStride,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+      uint64_t mask = count < 64 ? (1ull << count) - 1 : ~0ull;
+      cmd->trackGpuQueryResults(block, mask << index);
+
+      i += count;
+    }
+
+    m_results.clear();
+    return true;
+  }
+
+
+  DxvkGpuQueryHandle DxvkGpuQueryManager::allocQuery(
+          VkQueryType           type) {
+    uint32_t typeBit = getQueryTypeBit(type);
+
+    if (!typeBit) {
+      Logger::err(str::format("DXVK: Unhandled query type: ", type));
+      return DxvkGpuQueryHandle();
+    }
+
+    // Hand out queries from the current block in order, so
+    // that results can be copied with as few calls as possible
+    QueryRange& range = m_ranges[bit::tzcnt(typeBit)];
+
+    if (!range.block || range.next == DxvkGpuQueryBlock::QueryCount) {
+      if (!range.allocator)
+        range.allocator = m_pool->getAllocator(type);
+
+      range.block = range.allocator->allocBlock();
+      range.next  = 0;
+
+      if (!range.block)
+        return DxvkGpuQueryHandle();
+    }
+
+    DxvkGpuQueryHandle handle;
+    handle.allocator = range.allocator;
+    handle.block     = range.block;
+    handle.queryPool = range.block->queryPool;
+    handle.queryId   = range.block->queryIndex + range.next++;
+    return handle;
   }
   
   
@@ -408,7 +549,29 @@ namespace dxvk {
   }
 
 
+  void DxvkGpuQueryTracker::trackResults(
+          DxvkGpuQueryBlock*    block,
+          uint64_t              mask) {
+    m_results.push_back({ block, mask });
+  }
+
+
+  void DxvkGpuQueryTracker::notify() {
+    // Must happen before the submission is signaled as complete,
+    // otherwise threads waiting on it may still see stale data
+    for (const auto& result : m_results)
+      result.first->readyMask.fetch_or(result.second);
+
+    m_results.clear();
+  }
+
+
   void DxvkGpuQueryTracker::reset() {
+    // Make results available before recycling any queries in
+    // case the command list was never notified, since freeing
+    // the handles may reset the query block
+    notify();
+
     for (DxvkGpuQueryHandle handle : m_handles)
       handle.allocator->freeQuery(handle);
     
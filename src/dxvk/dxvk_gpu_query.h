@@ -1,8 +1,12 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <vector>
 
+#include "dxvk_buffer.h"
 #include "dxvk_resource.h"
 
 namespace dxvk {
@@ -92,16 +96,43 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Query block
+   *
+   * A contiguous range of queries within a Vulkan query
+   * pool. Blocks are handed out to contexts as a whole
+   * so that all queries can be reset with a single call.
+   *
+   * Each query has a slot in a host-visible buffer, which
+   * query results are copied to in bulk at the end of each
+   * command list. Once the command list has completed,
+   * the corresponding bit in the ready mask gets set.
+   */
+  struct DxvkGpuQueryBlock {
+    constexpr static uint32_t QueryCount = 64;
+
+    VkQueryPool           queryPool     = VK_NULL_HANDLE;
+    uint32_t              queryIndex    = 0;
+
+    VkBuffer              resultBuffer  = VK_NULL_HANDLE;
+    VkDeviceSize          resultOffset  = 0;
+    VkDeviceSize          resultStride  = 0;
+    const char*           resultData    = nullptr;
+
+    std::atomic<uint32_t> useCount      = { 0u };
+    std::atomic<uint64_t> readyMask     = { 0ull };
+  };
+
+
   /**
    * \brief Query handle
    * 
-   * Stores the query allocator, as well as
-   * the actual pool and query index. Since
-   * query pools have to be reset on the GPU,
-   * this also comes with a reset event.
+   * Stores the query allocator and block, as
+   * well as the actual pool and query index.
    */
   struct DxvkGpuQueryHandle {
     DxvkGpuQueryAllocator* allocator  = nullptr;
+    DxvkGpuQueryBlock*     block      = nullptr;
     VkQueryPool            queryPool  = VK_NULL_HANDLE;
     uint32_t               queryId    = 0;
   };
@@ -118,7 +149,6 @@ namespace dxvk {
   public:
 
     DxvkGpuQuery(
-      const Rc<vk::DeviceFn>&   vkd,
             VkQueryType         type,
             VkQueryControlFlags flags,
             uint32_t            index);
@@ -177,7 +207,9 @@ namespace dxvk {
      * return \c DxvkGpuQueryStatus::Signaled, and
      * the destination structure will be filled
      * with the data retrieved from all associated
-     * query handles.
+     * query handles. Data is read from the query
+     * result buffers, so this does not need to
+     * call into Vulkan.
      * \param [out] queryData Query data
      * \returns Current query status
      */
@@ -217,8 +249,6 @@ namespace dxvk {
 
   private:
 
-    Rc<vk::DeviceFn>    m_vkd;
-
     VkQueryType         m_type;
     VkQueryControlFlags m_flags;
     uint32_t            m_index;
@@ -239,7 +269,7 @@ namespace dxvk {
    * \brief Query allocator
    * 
    * Creates query pools and allocates
-   * queries for a single query type. 
+   * query blocks for a single query type.
    */
   class DxvkGpuQueryAllocator {
 
@@ -253,24 +283,38 @@ namespace dxvk {
     ~DxvkGpuQueryAllocator();
 
     /**
-     * \brief Allocates a query
+     * \brief Allocates a query block
      * 
-     * If possible, this returns a free query
+     * If possible, this returns a free block
      * from an existing query pool. Otherwise,
-     * a new query pool will be created.
-     * \returns Query handle
+     * a new query pool will be created. All
+     * queries in the block will be reset, and
+     * must be returned to the allocator.
+     * \returns Query block, or \c nullptr
      */
-    DxvkGpuQueryHandle allocQuery();
+    DxvkGpuQueryBlock* allocBlock();
 
     /**
-     * \brief Recycles a query
+     * \brief Recycles queries
      * 
-     * Returns a query back to the allocator
-     * so that it can be reused. The query
-     * must not be in pending state.
-     * \param [in] handle Query to reset
+     * Returns queries back to the allocator. Once
+     * all queries of a block have been returned,
+     * the block can be reused. The queries must
+     * not be in pending state.
+     * \param [in] block Query block
+     * \param [in] count Number of queries
      */
-    void freeQuery(DxvkGpuQueryHandle handle);
+    void freeQueries(
+            DxvkGpuQueryBlock*  block,
+            uint32_t            count);
+
+    /**
+     * \brief Recycles a query
+     * \param [in] handle Query to recycle
+     */
+    void freeQuery(DxvkGpuQueryHandle handle) {
+      freeQueries(handle.block, 1);
+    }
 
   private:
 
@@ -280,11 +324,16 @@ namespace dxvk {
     uint32_t          m_queryPoolSize;
     
     dxvk::mutex                     m_mutex;
-    std::vector<DxvkGpuQueryHandle> m_handles;
     std::vector<VkQueryPool>        m_pools;
+    std::vector<Rc<DxvkBuffer>>     m_buffers;
+
+    std::vector<std::unique_ptr<DxvkGpuQueryBlock>> m_blocks;
+    std::vector<DxvkGpuQueryBlock*>                 m_freeBlocks;
 
     void createQueryPool();
 
+    VkDeviceSize getResultSize() const;
+
   };
 
 
@@ -303,12 +352,13 @@ namespace dxvk {
     ~DxvkGpuQueryPool();
     
     /**
-     * \brief Allocates a single query
+     * \brief Retrieves allocator for a query type
      * 
      * \param [in] type Query type
-     * \returns Handle to the allocated query
+     * \returns Query allocator, or \c nullptr
+     *    if the query type is not supported
      */
-    DxvkGpuQueryHandle allocQuery(VkQueryType type);
+    DxvkGpuQueryAllocator* getAllocator(VkQueryType type);
 
   private:
 
@@ -393,12 +443,38 @@ namespace dxvk {
       const Rc<DxvkCommandList>&  cmd,
             VkQueryType           type);
 
+    /**
+     * \brief Copies query results
+     * 
+     * Copies the results of all queries that ended in
+     * the given command list to the query result buffers,
+     * merging queries with consecutive indices into a
+     * single copy. Must be called outside of a render
+     * pass before the command list gets submitted.
+     * \param [in] cmd Command list
+     * \returns \c true if any copies were recorded
+     */
+    bool copyQueryResults(
+      const Rc<DxvkCommandList>&  cmd);
+
   private:
 
+    struct QueryRange {
+      DxvkGpuQueryAllocator* allocator = nullptr;
+      DxvkGpuQueryBlock*     block     = nullptr;
+      uint32_t               next      = 0;
+    };
+
     DxvkGpuQueryPool*             m_pool;
     uint32_t                      m_activeTypes;
     std::vector<Rc<DxvkGpuQuery>> m_activeQueries;
 
+    std::array<QueryRange, 4>       m_ranges;
+    std::vector<DxvkGpuQueryHandle> m_results;
+
+    DxvkGpuQueryHandle allocQuery(
+            VkQueryType           type);
+
     void beginSingleQuery(
       const Rc<DxvkCommandList>&  cmd,
       const Rc<DxvkGpuQuery>&     query);
@@ -416,7 +492,8 @@ namespace dxvk {
   /**
    * \brief Query tracker
    * 
-   * Returns queries to their allocators after
+   * Marks copied query results as available and
+   * returns queries to their allocators after
    * the command buffer has finished executing.
    */
   class DxvkGpuQueryTracker {
@@ -432,17 +509,37 @@ namespace dxvk {
      */
     void trackQuery(DxvkGpuQueryHandle handle);
 
+    /**
+     * \brief Tracks copied query results
+     * 
+     * \param [in] block Query block
+     * \param [in] mask Queries within the block
+     */
+    void trackResults(
+            DxvkGpuQueryBlock*    block,
+            uint64_t              mask);
+
+    /**
+     * \brief Publishes tracked query results
+     * 
+     * Marks tracked query results as available. Must
+     * be called once the command list has completed.
+     */
+    void notify();
+
     /**
      * \brief Recycles all tracked handles
      * 
-     * Releases all tracked query handles
-     * to their respective query allocator.
+     * Publishes any remaining query results, and then
+     * releases all tracked query handles to their
+     * respective query allocator.
      */
     void reset();
 
   private:
 
     std::vector<DxvkGpuQueryHandle> m_handles;
+    std::vector<std::pair<DxvkGpuQueryBlock*, uint64_t>> m_results;
 
   };
 }
\ No newline at end of file
@@ -507,6 +507,7 @@ namespace dxvk {
     m_workers       (&pipeMgr->m_workers),
     m_stateCache    (&pipeMgr->m_stateCache),
     m_stats         (&pipeMgr->m_stats),
+    m_codeCache     (&pipeMgr->m_codeCache),
     m_shaders       (std::move(shaders)),
     m_bindings      (layout),
     m_barrier       (layout->getGlobalBarrier()),
@@ -816,6 +817,10 @@ namespace dxvk {
 
     for (uint32_t i = 0; i < MaxNumSpecConstants; i++)
       specData.set(i, state.sc.specConstants[i], 0u);
+
+    // Shaders that also support pipeline libraries must
+    // use the actual spec constant values in this case
+    specData.set(DxvkSpecConstantEnableId, 1u);
     
     VkSpecializationInfo specInfo = specData.getSpecInfo();
 
@@ -926,7 +931,7 @@ namespace dxvk {
     }
 
     info.undefinedInputs = (providedInputs & consumedInputs) ^ consumedInputs;
-    return shader->getCode(m_bindings, info);
+    return shader->getCode(m_bindings, info, m_codeCache);
   }
 
 
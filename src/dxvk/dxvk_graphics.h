@@ -384,6 +384,7 @@ namespace dxvk {
     DxvkPipelineWorkers*        m_workers;
     DxvkStateCache*             m_stateCache;
     DxvkPipelineStats*          m_stats;
+    DxvkShaderCodeCache*        m_codeCache;
 
     DxvkGraphicsPipelineShaders m_shaders;
     DxvkBindingLayoutObjects*   m_bindings;
@@ -12,7 +12,7 @@ namespace dxvk {
     const DxvkImageCreateInfo&  createInfo,
           DxvkMemoryAllocator&  memAlloc,
           VkMemoryPropertyFlags memFlags)
-  : m_vkd(device->vkd()), m_device(device), m_info(createInfo), m_memFlags(memFlags) {
+  : m_vkd(device->vkd()), m_device(device), m_info(createInfo), m_memFlags(memFlags), m_memAlloc(&memAlloc) {
 
     // Copy the compatible view formats to a persistent array
     m_viewFormats.resize(createInfo.viewFormatCount);
@@ -20,36 +20,94 @@ namespace dxvk {
       m_viewFormats[i] = createInfo.viewFormats[i];
     m_info.viewFormats = m_viewFormats.data();
 
+    m_shared = canShareImage(createInfo);
+    m_image = createPhysicalImage();
+  }
+  
+  
+  DxvkImage::DxvkImage(
+    const DxvkDevice*           device,
+    const DxvkImageCreateInfo&  info,
+          VkImage               image)
+  : m_vkd(device->vkd()), m_device(device), m_info(info), m_image({ image }) {
+    
+    m_viewFormats.resize(info.viewFormatCount);
+    for (uint32_t i = 0; i < info.viewFormatCount; i++)
+      m_viewFormats[i] = info.viewFormats[i];
+    m_info.viewFormats = m_viewFormats.data();
+  }
+  
+  
+  DxvkImage::~DxvkImage() {
+    // This is a bit of a hack to determine whether
+    // the image is implementation-handled or not
+    if (m_image.memory.memory() != VK_NULL_HANDLE)
+      m_vkd->vkDestroyImage(m_vkd->device(), m_image.image, nullptr);
+
+    for (const auto& image : m_freeImages)
+      m_vkd->vkDestroyImage(m_vkd->device(), image.image, nullptr);
+  }
+
+
+  DxvkPhysicalImage DxvkImage::allocPhysicalImage(
+          VkImageLayout*        pLayout) {
+    std::unique_lock<sync::Spinlock> freeLock(m_freeMutex);
+
+    // Images returned by the GPU are in the default layout,
+    // newly created ones are still in their initial layout
+    if (likely(!m_freeImages.empty())) {
+      DxvkPhysicalImage result = std::move(m_freeImages.back());
+      m_freeImages.pop_back();
+
+      *pLayout = m_info.layout;
+      return result;
+    }
+
+    freeLock.unlock();
+
+    *pLayout = m_info.initialLayout;
+    return createPhysicalImage();
+  }
+
+
+  void DxvkImage::freePhysicalImage(
+          DxvkPhysicalImage&&   image) {
+    std::unique_lock<sync::Spinlock> freeLock(m_freeMutex);
+    m_freeImages.push_back(std::move(image));
+  }
+
+
+  DxvkPhysicalImage DxvkImage::createPhysicalImage() {
+    DxvkPhysicalImage result;
+
     // If defined, we should provide a format list, which
     // allows some drivers to enable image compression
     VkImageFormatListCreateInfo formatList = { VK_STRUCTURE_TYPE_IMAGE_FORMAT_LIST_CREATE_INFO };
-    formatList.viewFormatCount = createInfo.viewFormatCount;
-    formatList.pViewFormats    = createInfo.viewFormats;
+    formatList.viewFormatCount = m_info.viewFormatCount;
+    formatList.pViewFormats    = m_info.viewFormats;
     
     VkImageCreateInfo info = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO, &formatList };
-    info.flags                 = createInfo.flags;
-    info.imageType             = createInfo.type;
-    info.format                = createInfo.format;
-    info.extent                = createInfo.extent;
-    info.mipLevels             = createInfo.mipLevels;
-    info.arrayLayers           = createInfo.numLayers;
-    info.samples               = createInfo.sampleCount;
-    info.tiling                = createInfo.tiling;
-    info.usage                 = createInfo.usage;
+    info.flags                 = m_info.flags;
+    info.imageType             = m_info.type;
+    info.format                = m_info.format;
+    info.extent                = m_info.extent;
+    info.mipLevels             = m_info.mipLevels;
+    info.arrayLayers           = m_info.numLayers;
+    info.samples               = m_info.sampleCount;
+    info.tiling                = m_info.tiling;
+    info.usage                 = m_info.usage;
     info.sharingMode           = VK_SHARING_MODE_EXCLUSIVE;
-    info.initialLayout         = createInfo.initialLayout;
-
-    m_shared = canShareImage(info, createInfo.sharing);
+    info.initialLayout         = m_info.initialLayout;
 
     VkExternalMemoryImageCreateInfo externalInfo = { VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO };
 
     if (m_shared) {
       externalInfo.pNext = std::exchange(info.pNext, &externalInfo);
-      externalInfo.handleTypes = createInfo.sharing.type;
+      externalInfo.handleTypes = m_info.sharing.type;
     }
     
     if (m_vkd->vkCreateImage(m_vkd->device(),
-          &info, nullptr, &m_image.image) != VK_SUCCESS) {
+          &info, nullptr, &result.image) != VK_SUCCESS) {
       throw DxvkError(str::format(
         "DxvkImage: Failed to create image:",
         "\n  Type:            ", info.imageType,
@@ -72,23 +130,23 @@ namespace dxvk {
     VkMemoryRequirements2 memReq = { VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2, &dedicatedRequirements };
     
     VkImageMemoryRequirementsInfo2 memReqInfo = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2 };
-    memReqInfo.image = m_image.image;
+    memReqInfo.image = result.image;
 
     VkMemoryDedicatedAllocateInfo dedMemoryAllocInfo = { VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO };
-    dedMemoryAllocInfo.image  = m_image.image;
+    dedMemoryAllocInfo.image  = result.image;
 
     VkExportMemoryAllocateInfo exportInfo = { VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO };
-    if (m_shared && createInfo.sharing.mode == DxvkSharedHandleMode::Export) {
+    if (m_shared && m_info.sharing.mode == DxvkSharedHandleMode::Export) {
       exportInfo.pNext = std::exchange(dedMemoryAllocInfo.pNext, &exportInfo);
-      exportInfo.handleTypes = createInfo.sharing.type;
+      exportInfo.handleTypes = m_info.sharing.type;
     }
 
 #ifdef _WIN32
     VkImportMemoryWin32HandleInfoKHR importInfo = { VK_STRUCTURE_TYPE_IMPORT_MEMORY_WIN32_HANDLE_INFO_KHR };
-    if (m_shared && createInfo.sharing.mode == DxvkSharedHandleMode::Import) {
+    if (m_shared && m_info.sharing.mode == DxvkSharedHandleMode::Import) {
       importInfo.pNext = std::exchange(dedMemoryAllocInfo.pNext, &importInfo);
-      importInfo.handleType = createInfo.sharing.type;
-      importInfo.handle = createInfo.sharing.handle;
+      importInfo.handleType = m_info.sharing.type;
+      importInfo.handle = m_info.sharing.handle;
     }
 #endif
 
@@ -96,8 +154,8 @@ namespace dxvk {
       m_vkd->device(), &memReqInfo, &memReq);
 
     if (info.tiling != VK_IMAGE_TILING_LINEAR && !dedicatedRequirements.prefersDedicatedAllocation) {
-      memReq.memoryRequirements.size      = align(memReq.memoryRequirements.size,       memAlloc.bufferImageGranularity());
-      memReq.memoryRequirements.alignment = align(memReq.memoryRequirements.alignment , memAlloc.bufferImageGranularity());
+      memReq.memoryRequirements.size      = align(memReq.memoryRequirements.size,       m_memAlloc->bufferImageGranularity());
+      memReq.memoryRequirements.alignment = align(memReq.memoryRequirements.alignment , m_memAlloc->bufferImageGranularity());
     }
 
     // Use high memory priority for GPU-writable resources
@@ -119,38 +177,21 @@ namespace dxvk {
     }
 
     // Ask driver whether we should be using a dedicated allocation
-    m_image.memory = memAlloc.alloc(&memReq.memoryRequirements,
-      dedicatedRequirements, dedMemoryAllocInfo, memFlags, hints);
+    result.memory = m_memAlloc->alloc(&memReq.memoryRequirements,
+      dedicatedRequirements, dedMemoryAllocInfo, m_memFlags, hints);
     
     // Try to bind the allocated memory slice to the image
-    if (m_vkd->vkBindImageMemory(m_vkd->device(), m_image.image,
-          m_image.memory.memory(), m_image.memory.offset()) != VK_SUCCESS)
+    if (m_vkd->vkBindImageMemory(m_vkd->device(), result.image,
+          result.memory.memory(), result.memory.offset()) != VK_SUCCESS)
       throw DxvkError("DxvkImage::DxvkImage: Failed to bind device memory");
+
+    return result;
   }
-  
-  
-  DxvkImage::DxvkImage(
-    const DxvkDevice*           device,
-    const DxvkImageCreateInfo&  info,
-          VkImage               image)
-  : m_vkd(device->vkd()), m_device(device), m_info(info), m_image({ image }) {
-    
-    m_viewFormats.resize(info.viewFormatCount);
-    for (uint32_t i = 0; i < info.viewFormatCount; i++)
-      m_viewFormats[i] = info.viewFormats[i];
-    m_info.viewFormats = m_viewFormats.data();
-  }
-  
-  
-  DxvkImage::~DxvkImage() {
-    // This is a bit of a hack to determine whether
-    // the image is implementation-handled or not
-    if (m_image.memory.memory() != VK_NULL_HANDLE)
-      m_vkd->vkDestroyImage(m_vkd->device(), m_image.image, nullptr);
-  }
 
 
-  bool DxvkImage::canShareImage(const VkImageCreateInfo&  createInfo, const DxvkSharedHandleInfo& sharingInfo) const {
+  bool DxvkImage::canShareImage(const DxvkImageCreateInfo& createInfo) const {
+    const DxvkSharedHandleInfo& sharingInfo = createInfo.sharing;
+
     if (sharingInfo.mode == DxvkSharedHandleMode::None)
       return false;
 
@@ -164,7 +205,7 @@ namespace dxvk {
 
     VkPhysicalDeviceImageFormatInfo2 imageFormatInfo = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2, &externalImageFormatInfo };
     imageFormatInfo.format = createInfo.format;
-    imageFormatInfo.type = createInfo.imageType;
+    imageFormatInfo.type = createInfo.type;
     imageFormatInfo.tiling = createInfo.tiling;
     imageFormatInfo.usage = createInfo.usage;
     imageFormatInfo.flags = createInfo.flags;
@@ -221,6 +262,27 @@ namespace dxvk {
     const Rc<DxvkImage>&            image,
     const DxvkImageViewCreateInfo&  info)
   : m_vkd(vkd), m_image(image), m_info(info), m_cookie(++s_cookie) {
+    this->createViews();
+  }
+  
+  
+  DxvkImageView::~DxvkImageView() {
+    for (uint32_t i = 0; i < ViewCount; i++)
+      m_vkd->vkDestroyImageView(m_vkd->device(), m_views[i], nullptr);
+
+    for (const auto& views : m_renamedViews) {
+      if (views.first == m_viewImage)
+        continue;
+
+      for (uint32_t i = 0; i < ViewCount; i++)
+        m_vkd->vkDestroyImageView(m_vkd->device(), views.second[i], nullptr);
+    }
+  }
+
+
+  void DxvkImageView::createViews() const {
+    m_viewImage = m_image->handle();
+
     for (uint32_t i = 0; i < ViewCount; i++)
       m_views[i] = VK_NULL_HANDLE;
     
@@ -263,15 +325,31 @@ namespace dxvk {
         throw DxvkError(str::format("DxvkImageView: Invalid view type: ", m_info.type));
     }
   }
-  
-  
-  DxvkImageView::~DxvkImageView() {
+
+
+  void DxvkImageView::updateViews() const {
+    // Keep the handles for the previous image around since
+    // the image may cycle back to it, and the GPU may still
+    // be using them in any case.
+    ViewSet& prevViews = m_renamedViews[m_viewImage];
+
     for (uint32_t i = 0; i < ViewCount; i++)
-      m_vkd->vkDestroyImageView(m_vkd->device(), m_views[i], nullptr);
+      prevViews[i] = m_views[i];
+
+    auto entry = m_renamedViews.find(m_image->handle());
+
+    if (entry != m_renamedViews.end()) {
+      m_viewImage = entry->first;
+
+      for (uint32_t i = 0; i < ViewCount; i++)
+        m_views[i] = entry->second[i];
+    } else {
+      this->createViews();
+    }
   }
 
   
-  void DxvkImageView::createView(VkImageViewType type, uint32_t numLayers) {
+  void DxvkImageView::createView(VkImageViewType type, uint32_t numLayers) const {
     VkImageSubresourceRange subresourceRange;
     subresourceRange.aspectMask     = m_info.aspect;
     subresourceRange.baseMipLevel   = m_info.minLevel;
@@ -320,5 +398,17 @@ namespace dxvk {
         "\n    Tiling:        ", m_image->info().tiling));
     }
   }
+
+
+  DxvkImageTracker:: DxvkImageTracker() { }
+  DxvkImageTracker::~DxvkImageTracker() { }
+  
+  
+  void DxvkImageTracker::reset() {
+    for (auto& e : m_entries)
+      e.image->freePhysicalImage(std::move(e.physImage));
+      
+    m_entries.clear();
+  }
   
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <unordered_map>
+#include <vector>
+
 #include "dxvk_descriptor.h"
 #include "dxvk_format.h"
 #include "dxvk_memory.h"
@@ -322,6 +326,43 @@ namespace dxvk {
      * \returns The shared handle with the type given by DxvkSharedHandleInfo::type
      */
     HANDLE sharedHandle() const;
+
+    /**
+     * \brief Allocates new backing image
+     *
+     * Returns a backing image that the GPU no longer uses, or
+     * creates a new one with the same properties. Only valid
+     * for images that own their memory and are not shared.
+     * \param [out] pLayout Layout that the backing image is in
+     * \returns The new backing image
+     */
+    DxvkPhysicalImage allocPhysicalImage(
+            VkImageLayout*        pLayout);
+
+    /**
+     * \brief Frees a backing image
+     *
+     * Marks the image as free so that it can be used for
+     * subsequent allocations. Called automatically when
+     * the image is no longer needed by the GPU.
+     * \param [in] image The backing image to free
+     */
+    void freePhysicalImage(
+            DxvkPhysicalImage&&   image);
+
+    /**
+     * \brief Replaces backing image
+     * 
+     * Replaces the underlying image and memory with the given
+     * backing image. Views will pick up the new image the
+     * next time their handles are queried.
+     * \param [in] image The new backing image
+     * \returns The previous backing image
+     */
+    DxvkPhysicalImage rename(
+            DxvkPhysicalImage&&   image) {
+      return std::exchange(m_image, std::move(image));
+    }
     
   private:
     
@@ -329,12 +370,18 @@ namespace dxvk {
     const DxvkDevice*     m_device;
     DxvkImageCreateInfo   m_info;
     VkMemoryPropertyFlags m_memFlags;
+    DxvkMemoryAllocator*  m_memAlloc = nullptr;
     DxvkPhysicalImage     m_image;
     bool m_shared = false;
 
     small_vector<VkFormat, 4> m_viewFormats;
+
+    sync::Spinlock                  m_freeMutex;
+    std::vector<DxvkPhysicalImage>  m_freeImages;
     
-    bool canShareImage(const VkImageCreateInfo&  createInfo, const DxvkSharedHandleInfo& sharingInfo) const;
+    bool canShareImage(const DxvkImageCreateInfo& createInfo) const;
+
+    DxvkPhysicalImage createPhysicalImage();
 
   };
   
@@ -377,6 +424,7 @@ namespace dxvk {
     VkImageView handle(VkImageViewType viewType) const {
       if (unlikely(viewType == VK_IMAGE_VIEW_TYPE_MAX_ENUM))
         viewType = m_info.type;
+      updateView();
       return m_views[viewType];
     }
     
@@ -552,19 +600,86 @@ namespace dxvk {
         view->imageSubresources());
     }
 
+    /**
+     * \brief Updates the image view
+     * 
+     * If the image has been renamed ever since the view
+     * handles were created, they are invalid and need to
+     * be replaced. Called implicitly when querying view
+     * handles, so that render targets, clears and meta
+     * operations never use views of a previous image.
+     */
+    void updateView() const {
+      if (unlikely(m_viewImage != m_image->handle()))
+        this->updateViews();
+    }
+
   private:
     
+    using ViewSet = std::array<VkImageView, ViewCount>;
+
     Rc<vk::DeviceFn>  m_vkd;
     Rc<DxvkImage>     m_image;
     
     DxvkImageViewCreateInfo m_info;
-    VkImageView             m_views[ViewCount];
+
+    mutable VkImageView     m_views[ViewCount];
+    mutable VkImage         m_viewImage;
+
+    mutable std::unordered_map<VkImage, ViewSet> m_renamedViews;
 
     uint64_t          m_cookie;
 
     static std::atomic<uint64_t> s_cookie;
 
-    void createView(VkImageViewType type, uint32_t numLayers);
+    void createViews() const;
+
+    void createView(VkImageViewType type, uint32_t numLayers) const;
+
+    void updateViews() const;
+    
+  };
+
+
+  /**
+   * \brief Image tracker
+   * 
+   * Stores a list of backing images that can be
+   * freed. Useful when images have been renamed
+   * and the original image is no longer needed.
+   */
+  class DxvkImageTracker {
+    
+  public:
+    
+    DxvkImageTracker();
+    ~DxvkImageTracker();
+    
+    /**
+     * \brief Add backing image for tracking
+     *
+     * The backing image will be returned to the
+     * image on the next call to \c reset.
+     * \param [in] image The parent image
+     * \param [in] physImage The backing image
+     */
+    void freePhysicalImage(const Rc<DxvkImage>& image, DxvkPhysicalImage&& physImage) {
+      m_entries.push_back({ image, std::move(physImage) });
+    }
+    
+    /**
+     * \brief Returns tracked backing images
+     */
+    void reset();
+    
+  private:
+    
+    struct Entry {
+      Rc<DxvkImage>     image;
+      DxvkPhysicalImage physImage;
+    };
+    
+    std::vector<Entry> m_entries;
     
   };
   
@@ -1,5 +1,8 @@
+#include "dxvk_device.h"
 #include "dxvk_meta_mipgen.h"
 
+#include <dxvk_mipgen_2darr.h>
+
 namespace dxvk {
 
   DxvkMetaMipGenRenderPass::DxvkMetaMipGenRenderPass(
@@ -94,4 +97,200 @@ namespace dxvk {
     return result;
   }
   
+
+
+  DxvkMetaMipGenViews::DxvkMetaMipGenViews(
+    const Rc<vk::DeviceFn>&   vkd,
+    const Rc<DxvkImageView>&  view)
+  : m_vkd(vkd), m_view(view) {
+    m_dstViews.resize(view->info().numLevels - 1);
+
+    for (uint32_t i = 0; i < m_dstViews.size(); i++)
+      m_dstViews[i] = createView(i + 1, VK_IMAGE_USAGE_STORAGE_BIT);
+
+    // Each pass only needs to read the last level
+    // that was written by the previous pass
+    uint32_t passCount = (m_dstViews.size() + MaxLevelsPerPass - 1) / MaxLevelsPerPass;
+    m_srcViews.resize(passCount);
+
+    for (uint32_t i = 0; i < m_srcViews.size(); i++)
+      m_srcViews[i] = createView(getPassBaseLevel(i) - 1, VK_IMAGE_USAGE_SAMPLED_BIT);
+  }
+
+
+  DxvkMetaMipGenViews::~DxvkMetaMipGenViews() {
+    for (VkImageView view : m_srcViews)
+      m_vkd->vkDestroyImageView(m_vkd->device(), view, nullptr);
+
+    for (VkImageView view : m_dstViews)
+      m_vkd->vkDestroyImageView(m_vkd->device(), view, nullptr);
+  }
+
+
+  VkImageView DxvkMetaMipGenViews::createView(
+          uint32_t            level,
+          VkImageUsageFlags   usage) const {
+    VkImageViewUsageCreateInfo usageInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO };
+    usageInfo.usage = usage;
+
+    VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO, &usageInfo };
+    viewInfo.image            = m_view->imageHandle();
+    viewInfo.viewType         = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    viewInfo.format           = m_view->info().format;
+    viewInfo.subresourceRange = getLevelSubresource(level);
+
+    VkImageView result = VK_NULL_HANDLE;
+
+    if (m_vkd->vkCreateImageView(m_vkd->device(), &viewInfo, nullptr, &result) != VK_SUCCESS)
+      throw DxvkError("DxvkMetaMipGenViews: Failed to create image view");
+
+    return result;
+  }
+
+
+  DxvkMetaMipGenObjects::DxvkMetaMipGenObjects(const DxvkDevice* device)
+  : m_vkd(device->vkd()) {
+    m_dsetLayout = createDescriptorSetLayout();
+    m_pipeLayout = createPipelineLayout();
+    m_pipeline   = createPipeline();
+  }
+
+
+  DxvkMetaMipGenObjects::~DxvkMetaMipGenObjects() {
+    m_vkd->vkDestroyPipeline(m_vkd->device(), m_pipeline, nullptr);
+    m_vkd->vkDestroyPipelineLayout(m_vkd->device(), m_pipeLayout, nullptr);
+    m_vkd->vkDestroyDescriptorSetLayout(m_vkd->device(), m_dsetLayout, nullptr);
+  }
+
+
+  bool DxvkMetaMipGenObjects::checkImageSupport(
+    const DxvkDevice*           device,
+    const DxvkImageCreateInfo&  imageInfo,
+          VkFormat              format) {
+    // The shader averages 2x2 blocks, which only matches
+    // a bilinear blit if every level halves the size
+    if (imageInfo.type != VK_IMAGE_TYPE_2D
+     || imageInfo.tiling != VK_IMAGE_TILING_OPTIMAL
+     || imageInfo.sampleCount != VK_SAMPLE_COUNT_1_BIT
+     || imageInfo.mipLevels < 2
+     || !(imageInfo.usage & VK_IMAGE_USAGE_STORAGE_BIT)
+     || (imageInfo.extent.width  & (imageInfo.extent.width  - 1))
+     || (imageInfo.extent.height & (imageInfo.extent.height - 1)))
+      return false;
+
+    if (!device->features().core.features.shaderStorageImageWriteWithoutFormat)
+      return false;
+
+    VkFormatFeatureFlags features = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT
+                                  | VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT;
+
+    VkFormatProperties formatProps = device->adapter()->formatProperties(format);
+    return (formatProps.optimalTilingFeatures & features) == features;
+  }
+
+
+  bool DxvkMetaMipGenObjects::enableStorageUsage(
+    const DxvkDevice*           device,
+          DxvkImageCreateInfo&  imageInfo) {
+    if (imageInfo.usage & VK_IMAGE_USAGE_STORAGE_BIT)
+      return false;
+
+    DxvkImageCreateInfo mipGenInfo = imageInfo;
+    mipGenInfo.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+
+    if (mipGenInfo.flags & VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT)
+      mipGenInfo.flags |= VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+
+    if (!checkImageSupport(device, mipGenInfo, mipGenInfo.format))
+      return false;
+
+    VkImageFormatProperties formatProps = { };
+
+    VkResult status = device->adapter()->imageFormatProperties(
+      mipGenInfo.format, mipGenInfo.type, mipGenInfo.tiling,
+      mipGenInfo.usage, mipGenInfo.flags, formatProps);
+
+    if (status != VK_SUCCESS
+     || mipGenInfo.extent.width  > formatProps.maxExtent.width
+     || mipGenInfo.extent.height > formatProps.maxExtent.height
+     || mipGenInfo.numLayers     > formatProps.maxArrayLayers
+     || mipGenInfo.mipLevels     > formatProps.maxMipLevels
+     || !(mipGenInfo.sampleCount & formatProps.sampleCounts))
+      return false;
+
+    imageInfo = mipGenInfo;
+    return true;
+  }
+
+
+  VkDescriptorSetLayout DxvkMetaMipGenObjects::createDescriptorSetLayout() {
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {{
+      { 0, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1,                                    VK_SHADER_STAGE_COMPUTE_BIT },
+      { 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, DxvkMetaMipGenViews::MaxLevelsPerPass, VK_SHADER_STAGE_COMPUTE_BIT },
+    }};
+
+    VkDescriptorSetLayoutCreateInfo dsetInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    dsetInfo.bindingCount       = bindings.size();
+    dsetInfo.pBindings          = bindings.data();
+
+    VkDescriptorSetLayout result = VK_NULL_HANDLE;
+    if (m_vkd->vkCreateDescriptorSetLayout(m_vkd->device(),
+          &dsetInfo, nullptr, &result) != VK_SUCCESS)
+      throw DxvkError("Dxvk: Failed to create meta mipgen descriptor set layout");
+    return result;
+  }
+
+
+  VkPipelineLayout DxvkMetaMipGenObjects::createPipelineLayout() {
+    VkPushConstantRange pushInfo = { VK_SHADER_STAGE_COMPUTE_BIT, 0, uint32_t(sizeof(DxvkMetaMipGenPushConstants)) };
+
+    VkPipelineLayoutCreateInfo pipeInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    pipeInfo.setLayoutCount         = 1;
+    pipeInfo.pSetLayouts            = &m_dsetLayout;
+    pipeInfo.pushConstantRangeCount = 1;
+    pipeInfo.pPushConstantRanges    = &pushInfo;
+
+    VkPipelineLayout result = VK_NULL_HANDLE;
+    if (m_vkd->vkCreatePipelineLayout(m_vkd->device(),
+          &pipeInfo, nullptr, &result) != VK_SUCCESS)
+      throw DxvkError("Dxvk: Failed to create meta mipgen pipeline layout");
+    return result;
+  }
+
+
+  VkPipeline DxvkMetaMipGenObjects::createPipeline() {
+    SpirvCodeBuffer spirvCode(dxvk_mipgen_2darr);
+
+    VkShaderModuleCreateInfo shaderInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+    shaderInfo.codeSize           = spirvCode.size();
+    shaderInfo.pCode              = spirvCode.data();
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    if (m_vkd->vkCreateShaderModule(m_vkd->device(),
+          &shaderInfo, nullptr, &shaderModule) != VK_SUCCESS)
+      throw DxvkError("Dxvk: Failed to create meta mipgen shader module");
+
+    VkPipelineShaderStageCreateInfo stageInfo = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+    stageInfo.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
+    stageInfo.module              = shaderModule;
+    stageInfo.pName               = "main";
+    stageInfo.pSpecializationInfo = nullptr;
+
+    VkComputePipelineCreateInfo pipeInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+    pipeInfo.stage                = stageInfo;
+    pipeInfo.layout               = m_pipeLayout;
+    pipeInfo.basePipelineIndex    = -1;
+
+    VkPipeline result = VK_NULL_HANDLE;
+
+    const VkResult status = m_vkd->vkCreateComputePipelines(
+      m_vkd->device(), VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &result);
+
+    m_vkd->vkDestroyShaderModule(m_vkd->device(), shaderModule, nullptr);
+
+    if (status != VK_SUCCESS)
+      throw DxvkError("Dxvk: Failed to create meta mipgen compute pipeline");
+    return result;
+  }
+
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 
 #include "dxvk_meta_blit.h"
@@ -145,5 +146,195 @@ namespace dxvk {
     PassViews createViews(uint32_t pass) const;
     
   };
+
+
+  /**
+   * \brief Push constants for compute mip generation
+   */
+  struct DxvkMetaMipGenPushConstants {
+    VkExtent2D srcExtent;
+    uint32_t   levelCount;
+  };
+
+
+  /**
+   * \brief Compute mip generation pipeline
+   */
+  struct DxvkMetaMipGenPipeline {
+    VkDescriptorSetLayout dsetLayout;
+    VkPipelineLayout      pipeLayout;
+    VkPipeline            pipeHandle;
+    VkExtent3D            tileSize;
+  };
+
+
+  /**
+   * \brief Image views for compute mip generation
+   *
+   * Stores one sampled view for the first level of
+   * each pass, and one storage view for every level
+   * that will be written. Like the render pass, this
+   * must be created per image view.
+   */
+  class DxvkMetaMipGenViews : public DxvkResource {
+
+  public:
+
+    /// Number of levels written by a single pass
+    constexpr static uint32_t MaxLevelsPerPass = 6;
+
+    DxvkMetaMipGenViews(
+      const Rc<vk::DeviceFn>&   vkd,
+      const Rc<DxvkImageView>&  view);
+
+    ~DxvkMetaMipGenViews();
+
+    /**
+     * \brief Pass count
+     *
+     * Each pass generates up to \c MaxLevelsPerPass
+     * mip levels from the first level of the pass.
+     * \returns Number of dispatches to perform
+     */
+    uint32_t getPassCount() const {
+      return m_srcViews.size();
+    }
+
+    /**
+     * \brief First level written by a pass
+     *
+     * \param [in] passId Pass index
+     * \returns Level index, relative to the view
+     */
+    uint32_t getPassBaseLevel(uint32_t passId) const {
+      return passId * MaxLevelsPerPass + 1;
+    }
+
+    /**
+     * \brief Number of levels written by a pass
+     *
+     * \param [in] passId Pass index
+     * \returns Number of levels to generate
+     */
+    uint32_t getPassLevelCount(uint32_t passId) const {
+      return std::min(MaxLevelsPerPass,
+        uint32_t(m_dstViews.size()) - passId * MaxLevelsPerPass);
+    }
+
+    /**
+     * \brief Source image view
+     *
+     * \param [in] passId Pass index
+     * \returns Sampled view of the level read by the pass
+     */
+    VkImageView getSrcView(uint32_t passId) const {
+      return m_srcViews.at(passId);
+    }
+
+    /**
+     * \brief Destination image view
+     *
+     * \param [in] level Level index, relative to the view
+     * \returns Storage view of the given level
+     */
+    VkImageView getDstView(uint32_t level) const {
+      return m_dstViews.at(level - 1);
+    }
+
+    /**
+     * \brief Returns subresource of a single level
+     *
+     * \param [in] level Level index, relative to the view
+     * \returns The subresource range
+     */
+    VkImageSubresourceRange getLevelSubresource(uint32_t level) const {
+      VkImageSubresourceRange sr = m_view->imageSubresources();
+      sr.baseMipLevel += level;
+      sr.levelCount = 1;
+      return sr;
+    }
+
+  private:
+
+    Rc<vk::DeviceFn>  m_vkd;
+    Rc<DxvkImageView> m_view;
+
+    std::vector<VkImageView> m_srcViews;
+    std::vector<VkImageView> m_dstViews;
+
+    VkImageView createView(
+            uint32_t            level,
+            VkImageUsageFlags   usage) const;
+
+  };
+
+
+  /**
+   * \brief Compute mip generation objects
+   *
+   * Stores the compute pipeline that generates up to
+   * six mip levels of a 2D or 2D array image in one
+   * dispatch. Only used for images with power-of-two
+   * sizes and storage image support, other images go
+   * through \ref DxvkMetaMipGenRenderPass.
+   */
+  class DxvkMetaMipGenObjects {
+
+  public:
+
+    DxvkMetaMipGenObjects(const DxvkDevice* device);
+    ~DxvkMetaMipGenObjects();
+
+    /**
+     * \brief Retrieves pipeline objects
+     * \returns Mip generation pipeline
+     */
+    DxvkMetaMipGenPipeline getPipeline() const {
+      return { m_dsetLayout, m_pipeLayout, m_pipeline, { 32, 32, 1 } };
+    }
+
+    /**
+     * \brief Checks whether compute mip generation can be used
+     *
+     * \param [in] device The device
+     * \param [in] imageInfo Image properties
+     * \param [in] format Format of the view to generate mips for
+     * \returns \c true if the compute shader can be used
+     */
+    static bool checkImageSupport(
+      const DxvkDevice*           device,
+      const DxvkImageCreateInfo&  imageInfo,
+            VkFormat              format);
+
+    /**
+     * \brief Enables storage usage for compute mip generation
+     *
+     * Only adds the usage flag if the image would take the
+     * compute path and can still be created with it. Views
+     * of mutable images do not inherit storage usage, since
+     * view formats may not support it.
+     * \param [in] device The device
+     * \param [in,out] imageInfo Image properties
+     * \returns \c true if the image info was changed
+     */
+    static bool enableStorageUsage(
+      const DxvkDevice*           device,
+            DxvkImageCreateInfo&  imageInfo);
+
+  private:
+
+    Rc<vk::DeviceFn> m_vkd;
+
+    VkDescriptorSetLayout m_dsetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout      m_pipeLayout = VK_NULL_HANDLE;
+    VkPipeline            m_pipeline   = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout createDescriptorSetLayout();
+
+    VkPipelineLayout createPipelineLayout();
+
+    VkPipeline createPipeline();
+
+  };
   
 }
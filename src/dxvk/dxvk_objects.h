@@ -11,6 +11,7 @@
 #include "dxvk_meta_resolve.h"
 #include "dxvk_pipemanager.h"
 #include "dxvk_renderpass.h"
+#include "dxvk_sampler.h"
 #include "dxvk_unbound.h"
 
 #include "../util/util_lazy.h"
@@ -27,6 +28,7 @@ namespace dxvk {
       m_pipelineManager (device),
       m_eventPool       (device),
       m_queryPool       (device),
+      m_samplerPool     (device),
       m_dummyResources  (device) {
 
     }
@@ -47,6 +49,10 @@ namespace dxvk {
       return m_queryPool;
     }
 
+    DxvkSamplerPool& samplerPool() {
+      return m_samplerPool;
+    }
+
     DxvkUnboundResources& dummyResources() {
       return m_dummyResources;
     }
@@ -63,6 +69,10 @@ namespace dxvk {
       return m_metaCopy.get(m_device);
     }
 
+    DxvkMetaMipGenObjects& metaMipGen() {
+      return m_metaMipGen.get(m_device);
+    }
+
     DxvkMetaResolveObjects& metaResolve() {
       return m_metaResolve.get(m_device);
     }
@@ -81,11 +91,14 @@ namespace dxvk {
     DxvkGpuEventPool              m_eventPool;
     DxvkGpuQueryPool              m_queryPool;
 
+    DxvkSamplerPool               m_samplerPool;
+
     DxvkUnboundResources          m_dummyResources;
 
     Lazy<DxvkMetaBlitObjects>     m_metaBlit;
     Lazy<DxvkMetaClearObjects>    m_metaClear;
     Lazy<DxvkMetaCopyObjects>     m_metaCopy;
+    Lazy<DxvkMetaMipGenObjects>   m_metaMipGen;
     Lazy<DxvkMetaResolveObjects>  m_metaResolve;
     Lazy<DxvkMetaPackObjects>     m_metaPack;
 
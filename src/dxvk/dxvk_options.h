@@ -24,6 +24,9 @@ namespace dxvk {
     /// Shader-related options
     Tristate useRawSsbo;
 
+    /// Run the SPIR-V optimizer on generated shaders
+    bool optimizeSpirv;
+
     /// Workaround for NVIDIA driver bug 3114283
     bool shrinkNvidiaHvvHeap;
 
@@ -41,6 +41,18 @@ namespace dxvk {
   }
 
 
+  void DxvkPipelineWorkers::compileShader(
+    const Rc<DxvkShaderCompileTask>&      task) {
+    std::unique_lock lock(m_queueLock);
+    this->startWorkers();
+
+    m_pendingTasks += 1;
+
+    m_queuedShaders.push(task);
+    m_queueCond.notify_one();
+  }
+
+
   void DxvkPipelineWorkers::compileComputePipeline(
           DxvkComputePipeline*            pipeline,
     const DxvkComputePipelineStateInfo&   state) {
@@ -118,11 +130,13 @@ namespace dxvk {
     while (true) {
       std::optional<PipelineEntry> p;
       std::optional<PipelineLibraryEntry> l;
+      Rc<DxvkShaderCompileTask> s;
 
       { std::unique_lock lock(m_queueLock);
 
         m_queueCond.wait(lock, [this] {
           return !m_workersRunning
+              || !m_queuedShaders.empty()
               || !m_queuedLibraries.empty()
               || !m_queuedPipelines.empty();
         });
@@ -131,6 +145,9 @@ namespace dxvk {
           // Skip pending work, exiting early is
           // more important in this case.
           break;
+        } else if (!m_queuedShaders.empty()) {
+          s = std::move(m_queuedShaders.front());
+          m_queuedShaders.pop();
         } else if (!m_queuedLibraries.empty()) {
           l = m_queuedLibraries.front();
           m_queuedLibraries.pop();
@@ -140,6 +157,12 @@ namespace dxvk {
         }
       }
 
+      if (s != nullptr) {
+        s->compileShader();
+
+        m_pendingTasks -= 1;
+      }
+
       if (l) {
         if (l->pipelineLibrary)
           l->pipelineLibrary->compilePipeline();
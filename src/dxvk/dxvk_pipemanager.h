@@ -34,11 +34,33 @@ namespace dxvk {
     std::atomic<uint32_t> numComputePipelines   = { 0u };
   };
 
+  /**
+   * \brief Shader compile task
+   *
+   * Lets client APIs translate shaders to SPIR-V
+   * on the pipeline worker threads. Tasks can only
+   * be submitted while the device is alive, and
+   * pending tasks are discarded when it is destroyed.
+   */
+  class DxvkShaderCompileTask : public RcObject {
+
+  public:
+
+    virtual ~DxvkShaderCompileTask() { }
+
+    /**
+     * \brief Compiles the shader
+     */
+    virtual void compileShader() = 0;
+
+  };
+
   /**
    * \brief Pipeline manager worker threads
    *
    * Spawns worker threads to compile shader pipeline
    * libraries and optimized pipelines asynchronously.
+   * Client API shaders are compiled on the same threads.
    */
   class DxvkPipelineWorkers {
 
@@ -60,6 +82,17 @@ namespace dxvk {
     void compilePipelineLibrary(
             DxvkShaderPipelineLibrary*      library);
 
+    /**
+     * \brief Compiles a client API shader
+     *
+     * Shaders are compiled before any pipeline work
+     * since pipelines may depend on them, and the app
+     * may have to wait for the shader when it is used.
+     * \param [in] task The shader compile task
+     */
+    void compileShader(
+      const Rc<DxvkShaderCompileTask>&      task);
+
     /**
      * \brief Compiles an optimized compute pipeline
      *
@@ -112,6 +145,7 @@ namespace dxvk {
     dxvk::mutex                       m_queueLock;
     dxvk::condition_variable          m_queueCond;
 
+    std::queue<Rc<DxvkShaderCompileTask>> m_queuedShaders;
     std::queue<PipelineLibraryEntry>  m_queuedLibraries;
     std::queue<PipelineEntry>         m_queuedPipelines;
 
@@ -199,12 +233,29 @@ namespace dxvk {
     void registerShader(
       const Rc<DxvkShader>&         shader);
     
+    /**
+     * \brief Compiles a client API shader asynchronously
+     * \param [in] task The shader compile task
+     */
+    void compileShader(
+      const Rc<DxvkShaderCompileTask>& task) {
+      m_workers.compileShader(task);
+    }
+
     /**
      * \brief Retrieves total pipeline count
      * \returns Number of compute/graphics pipelines
      */
     DxvkPipelineCount getPipelineCount() const;
 
+    /**
+     * \brief Queries patched shader code cache stats
+     * \returns Code cache stats for this device
+     */
+    DxvkShaderCodeCacheStats getShaderCodeCacheStats() {
+      return m_codeCache.getStats();
+    }
+
     /**
      * \brief Checks whether async compiler is busy
      * \returns \c true if shaders are being compiled
@@ -221,6 +272,7 @@ namespace dxvk {
   private:
     
     DxvkDevice*               m_device;
+    DxvkShaderCodeCache       m_codeCache;
     DxvkPipelineWorkers       m_workers;
     DxvkStateCache            m_stateCache;
     DxvkPipelineStats         m_stats;
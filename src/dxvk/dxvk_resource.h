@@ -72,6 +72,17 @@ namespace dxvk {
       return uint32_t((m_useCount -= getIncrement(access)) & RefcountMask);
     }
 
+    /**
+     * \brief Queries current reference count
+     *
+     * Includes references held by command lists
+     * that are still pending execution.
+     * \returns Current reference count
+     */
+    uint32_t refCount() const {
+      return uint32_t(m_useCount.load() & RefcountMask);
+    }
+
     /**
      * \brief Checks whether resource is in use
      * 
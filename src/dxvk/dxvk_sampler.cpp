@@ -1,8 +1,56 @@
+#include <algorithm>
+#include <cstring>
+
 #include "dxvk_sampler.h"
 #include "dxvk_device.h"
 
 namespace dxvk {
-    
+
+  bool DxvkSamplerCreateInfo::eq(const DxvkSamplerCreateInfo& other) const {
+    return magFilter      == other.magFilter
+        && minFilter      == other.minFilter
+        && mipmapMode     == other.mipmapMode
+        && bit::cast<uint32_t>(mipmapLodBias) == bit::cast<uint32_t>(other.mipmapLodBias)
+        && bit::cast<uint32_t>(mipmapLodMin)  == bit::cast<uint32_t>(other.mipmapLodMin)
+        && bit::cast<uint32_t>(mipmapLodMax)  == bit::cast<uint32_t>(other.mipmapLodMax)
+        && useAnisotropy  == other.useAnisotropy
+        && bit::cast<uint32_t>(maxAnisotropy) == bit::cast<uint32_t>(other.maxAnisotropy)
+        && addressModeU   == other.addressModeU
+        && addressModeV   == other.addressModeV
+        && addressModeW   == other.addressModeW
+        && compareToDepth == other.compareToDepth
+        && compareOp      == other.compareOp
+        && !std::memcmp(&borderColor, &other.borderColor, sizeof(borderColor))
+        && usePixelCoord  == other.usePixelCoord
+        && nonSeamless    == other.nonSeamless;
+  }
+
+
+  size_t DxvkSamplerCreateInfo::hash() const {
+    DxvkHashState state;
+    state.add(uint32_t(magFilter));
+    state.add(uint32_t(minFilter));
+    state.add(uint32_t(mipmapMode));
+    state.add(bit::cast<uint32_t>(mipmapLodBias));
+    state.add(bit::cast<uint32_t>(mipmapLodMin));
+    state.add(bit::cast<uint32_t>(mipmapLodMax));
+    state.add(useAnisotropy);
+    state.add(bit::cast<uint32_t>(maxAnisotropy));
+    state.add(uint32_t(addressModeU));
+    state.add(uint32_t(addressModeV));
+    state.add(uint32_t(addressModeW));
+    state.add(compareToDepth);
+    state.add(uint32_t(compareOp));
+
+    for (uint32_t i = 0; i < 4; i++)
+      state.add(borderColor.uint32[i]);
+
+    state.add(usePixelCoord);
+    state.add(nonSeamless);
+    return state;
+  }
+
+
   DxvkSampler::DxvkSampler(
           DxvkDevice*             device,
     const DxvkSamplerCreateInfo&  info)
@@ -76,4 +124,85 @@ namespace dxvk {
     return VK_BORDER_COLOR_FLOAT_CUSTOM_EXT;
   }
 
+
+
+  DxvkSamplerPool::DxvkSamplerPool(DxvkDevice* device)
+  : m_device(device) {
+    // Leave some headroom below the device limit since we
+    // may not be the only ones allocating sampler objects
+    uint32_t limit = device->properties().core.properties.limits.maxSamplerAllocationCount;
+    m_maxSamplers = std::min(limit - limit / 4, MaxSamplerCount);
+    m_evictionThreshold = m_maxSamplers;
+  }
+
+
+  DxvkSamplerPool::~DxvkSamplerPool() {
+
+  }
+
+
+  Rc<DxvkSampler> DxvkSamplerPool::createSampler(
+    const DxvkSamplerCreateInfo&  info) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    auto entry = m_samplers.find(info);
+
+    if (entry != m_samplers.end()) {
+      entry->second.lastUse = ++m_useCounter;
+      return entry->second.sampler;
+    }
+
+    if (m_samplers.size() >= m_evictionThreshold)
+      evictIdleSamplers();
+
+    Rc<DxvkSampler> sampler = new DxvkSampler(m_device, info);
+
+    Entry newEntry;
+    newEntry.sampler = sampler;
+    newEntry.lastUse = ++m_useCounter;
+
+    m_samplers.insert({ info, std::move(newEntry) });
+    return sampler;
+  }
+
+
+  uint32_t DxvkSamplerPool::getSamplerCount() {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    return uint32_t(m_samplers.size());
+  }
+
+
+  void DxvkSamplerPool::evictIdleSamplers() {
+    // A sampler is idle if the pool holds the only reference to it.
+    // Since new references can only be obtained through the pool,
+    // this cannot change while we are holding the lock.
+    std::vector<std::pair<uint64_t, DxvkSamplerCreateInfo>> idle;
+
+    for (const auto& entry : m_samplers) {
+      if (entry.second.sampler->refCount() == 1)
+        idle.push_back({ entry.second.lastUse, entry.first });
+    }
+
+    std::sort(idle.begin(), idle.end(),
+      [] (const auto& a, const auto& b) {
+        return a.first < b.first;
+      });
+
+    // Free enough samplers to not have to do this again
+    // for a while, oldest first
+    size_t target = m_maxSamplers - m_maxSamplers / 8;
+
+    for (const auto& entry : idle) {
+      if (m_samplers.size() <= target)
+        break;
+
+      m_samplers.erase(entry.second);
+    }
+
+    // If most samplers are still in use, the app genuinely needs them,
+    // so don't scan the whole pool again on every single creation
+    m_evictionThreshold = std::max<size_t>(m_maxSamplers,
+      m_samplers.size() + m_maxSamplers / 8);
+  }
+
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <unordered_map>
+
+#include "dxvk_hash.h"
 #include "dxvk_resource.h"
 
 namespace dxvk {
@@ -41,6 +44,10 @@ namespace dxvk {
 
     /// Enables non seamless cube map filtering
     VkBool32 nonSeamless;
+
+    bool eq(const DxvkSamplerCreateInfo& other) const;
+
+    size_t hash() const;
   };
   
   
@@ -78,5 +85,62 @@ namespace dxvk {
       const DxvkSamplerCreateInfo&  info);
     
   };
+
+
+  /**
+   * \brief Sampler pool
+   *
+   * Deduplicates samplers with identical properties, so that
+   * all frontends share the same sampler objects. Samplers
+   * that are no longer referenced outside the pool stay cached
+   * until the number of samplers approaches the device limit,
+   * at which point the least recently requested ones are freed.
+   */
+  class DxvkSamplerPool {
+    /// Maximum number of samplers to keep around
+    constexpr static uint32_t MaxSamplerCount = 4096;
+  public:
+
+    DxvkSamplerPool(DxvkDevice* device);
+    ~DxvkSamplerPool();
+
+    /**
+     * \brief Retrieves sampler with the given properties
+     *
+     * Returns an existing sampler if one with the given
+     * properties exists, or creates a new one otherwise.
+     * \param [in] info Sampler properties
+     * \returns Sampler object
+     */
+    Rc<DxvkSampler> createSampler(
+      const DxvkSamplerCreateInfo&  info);
+
+    /**
+     * \brief Number of live sampler objects
+     * \returns Sampler count, including idle samplers
+     */
+    uint32_t getSamplerCount();
+
+  private:
+
+    struct Entry {
+      Rc<DxvkSampler> sampler;
+      uint64_t        lastUse;
+    };
+
+    DxvkDevice*       m_device;
+    dxvk::mutex       m_mutex;
+
+    std::unordered_map<
+      DxvkSamplerCreateInfo, Entry,
+      DxvkHash, DxvkEq>   m_samplers;
+
+    uint64_t          m_useCounter  = 0;
+    uint32_t          m_maxSamplers = 0;
+    size_t            m_evictionThreshold = 0;
+
+    void evictIdleSamplers();
+
+  };
   
 }
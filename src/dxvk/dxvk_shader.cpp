@@ -9,11 +9,26 @@
 #include <unordered_set>
 
 namespace dxvk {
-  
+
+  bool DxvkShaderModuleCreateInfo::eq(const DxvkShaderModuleCreateInfo& other) const {
+    bool eq = fsDualSrcBlend  == other.fsDualSrcBlend
+           && undefinedInputs == other.undefinedInputs;
+
+    for (uint32_t i = 0; i < MaxNumRenderTargets && eq; i++) {
+      eq = rtSwizzles[i].r == other.rtSwizzles[i].r
+        && rtSwizzles[i].g == other.rtSwizzles[i].g
+        && rtSwizzles[i].b == other.rtSwizzles[i].b
+        && rtSwizzles[i].a == other.rtSwizzles[i].a;
+    }
+
+    return eq;
+  }
+
+
   DxvkShader::DxvkShader(
     const DxvkShaderCreateInfo&   info,
           SpirvCodeBuffer&&       spirv)
-  : m_info(info), m_code(spirv), m_bindings(info.stage) {
+  : m_info(info), m_bindings(info.stage) {
     m_info.uniformData = nullptr;
     m_info.bindings = nullptr;
 
@@ -26,7 +41,7 @@ namespace dxvk {
 
     if (info.pushConstSize) {
       VkPushConstantRange pushConst;
-      pushConst.stageFlags = info.stage;
+      pushConst.stageFlags = info.pushConstStages ? info.pushConstStages : info.stage;
       pushConst.offset = info.pushConstOffset;
       pushConst.size = info.pushConstSize;
 
@@ -40,12 +55,17 @@ namespace dxvk {
       m_info.uniformData = m_uniformData.data();
     }
 
+    // Optimize the code once up front so that we don't have to
+    // rely on drivers to clean up redundant register accesses.
+    SpirvCodeBuffer code = info.optimize
+      ? SpirvOptimizer(std::move(spirv)).run()
+      : std::move(spirv);
+
     // Run an analysis pass over the SPIR-V code to gather some
     // info that we may need during pipeline compilation.
     std::vector<BindingOffsets> bindingOffsets;
     std::vector<uint32_t> varIds;
 
-    SpirvCodeBuffer code = std::move(spirv);
     uint32_t o1VarId = 0;
     
     for (auto ins : code) {
@@ -64,8 +84,12 @@ namespace dxvk {
           bindingOffsets[varId].setOffset = ins.offset() + 3;
         }
 
-        if (ins.arg(2) == spv::DecorationSpecId && ins.arg(3) < MaxNumSpecConstants)
-          m_flags.set(DxvkShaderFlag::HasSpecConstants);
+        if (ins.arg(2) == spv::DecorationSpecId) {
+          if (ins.arg(3) < MaxNumSpecConstants)
+            m_flags.set(DxvkShaderFlag::HasSpecConstants);
+          else if (ins.arg(3) == DxvkSpecConstantEnableId)
+            m_flags.set(DxvkShaderFlag::HasSpecConstantFallback);
+        }
 
         if (ins.arg(2) == spv::DecorationLocation && ins.arg(3) == 1) {
           m_o1LocOffset = ins.offset() + 3;
@@ -98,6 +122,8 @@ namespace dxvk {
         break;
     }
 
+    m_code = SpirvCompressedBuffer(code);
+
     // Combine spec constant IDs with other binding info
     for (auto varId : varIds) {
       BindingOffsets info = bindingOffsets[varId];
@@ -109,11 +135,42 @@ namespace dxvk {
 
 
   DxvkShader::~DxvkShader() {
-    
+    DxvkShaderCodeCache* cache = m_codeCache.load();
+
+    if (cache)
+      cache->removeShader(this);
   }
   
   
   SpirvCodeBuffer DxvkShader::getCode(
+    const DxvkBindingLayoutObjects*   layout,
+    const DxvkShaderModuleCreateInfo& state,
+          DxvkShaderCodeCache*        cache) const {
+    // Cache entries need to be removed when the shader gets
+    // destroyed, so only ever register with a single cache.
+    DxvkShaderCodeCache* expected = nullptr;
+
+    if (cache && !m_codeCache.compare_exchange_strong(expected, cache) && expected != cache)
+      cache = nullptr;
+
+    SpirvCodeBuffer code;
+
+    if (cache && cache->lookup(this, layout, state, code))
+      return code;
+
+    // Patch code without holding any locks since this is
+    // relatively expensive and may happen on multiple
+    // compiler threads at once.
+    code = patchCode(layout, state);
+
+    if (cache)
+      cache->insert(this, layout, state, code);
+
+    return code;
+  }
+
+
+  SpirvCodeBuffer DxvkShader::patchCode(
     const DxvkBindingLayoutObjects*   layout,
     const DxvkShaderModuleCreateInfo& state) const {
     SpirvCodeBuffer spirvCode = m_code.decompress();
@@ -157,8 +214,10 @@ namespace dxvk {
      && m_info.stage != VK_SHADER_STAGE_COMPUTE_BIT)
       return false;
 
-    // Ignore shaders that have user-defined spec constants
-    return !m_flags.test(DxvkShaderFlag::HasSpecConstants);
+    // Ignore shaders that have user-defined spec constants,
+    // unless they can read the values from elsewhere
+    return !m_flags.test(DxvkShaderFlag::HasSpecConstants)
+        || m_flags.test(DxvkShaderFlag::HasSpecConstantFallback);
   }
 
 
@@ -645,6 +704,163 @@ namespace dxvk {
   }
 
 
+  DxvkShaderCodeCache::DxvkShaderCodeCache() {
+
+  }
+
+
+  DxvkShaderCodeCache::~DxvkShaderCodeCache() {
+    // Shaders that outlive the cache must not try
+    // to unregister themselves when destroyed.
+    for (const auto& shader : m_shaders)
+      shader.first->m_codeCache.store(nullptr);
+  }
+
+
+  bool DxvkShaderCodeCache::lookup(
+    const DxvkShader*                 shader,
+    const DxvkBindingLayoutObjects*   layout,
+    const DxvkShaderModuleCreateInfo& state,
+          SpirvCodeBuffer&            code) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    auto entry = findEntry(shader, layout, state);
+
+    if (entry == m_entries.end() || !entry->code.dwords()) {
+      m_numMisses += 1;
+      return false;
+    }
+
+    m_entries.splice(m_entries.begin(), m_entries, entry);
+    entry->lastUse = ++m_time;
+
+    m_numHits += 1;
+
+    code = entry->code;
+    return true;
+  }
+
+
+  void DxvkShaderCodeCache::insert(
+    const DxvkShader*                 shader,
+    const DxvkBindingLayoutObjects*   layout,
+    const DxvkShaderModuleCreateInfo& state,
+    const SpirvCodeBuffer&            code) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    auto entry = findEntry(shader, layout, state);
+
+    if (entry == m_entries.end()) {
+      auto& shaderEntries = m_shaders[shader];
+
+      if (shaderEntries.size() >= MaxEntriesPerShader) {
+        // Replace the least recently used entry for this shader
+        auto oldest = shaderEntries[0];
+
+        for (auto e : shaderEntries) {
+          if (e->lastUse < oldest->lastUse)
+            oldest = e;
+        }
+
+        removeEntry(oldest);
+      }
+
+      entry = m_entries.emplace(m_entries.begin());
+      entry->shader = shader;
+      entry->layout = layout;
+      entry->state  = state;
+
+      m_shaders[shader].push_back(entry);
+    } else {
+      m_entries.splice(m_entries.begin(), m_entries, entry);
+    }
+
+    entry->useCount += 1;
+    entry->lastUse   = ++m_time;
+
+    // Only keep code for variants that are requested
+    // repeatedly, others will stay compressed.
+    if (entry->useCount < MinUses || entry->code.dwords())
+      return;
+
+    entry->code = code;
+    m_memorySize += code.size();
+
+    // Evict least recently used variants, possibly from other
+    // shaders, until we're back within the memory budget. This
+    // also drops tracking info for variants without cached code.
+    while (m_memorySize > MaxMemorySize) {
+      auto last = std::prev(m_entries.end());
+
+      if (last == entry)
+        break;
+
+      removeEntry(last);
+    }
+  }
+
+
+  void DxvkShaderCodeCache::removeShader(
+    const DxvkShader*                 shader) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    auto shaderEntries = m_shaders.find(shader);
+
+    if (shaderEntries == m_shaders.end())
+      return;
+
+    for (auto entry : shaderEntries->second) {
+      m_memorySize -= entry->code.size();
+      m_entries.erase(entry);
+    }
+
+    m_shaders.erase(shaderEntries);
+  }
+
+
+  DxvkShaderCodeCacheStats DxvkShaderCodeCache::getStats() {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    DxvkShaderCodeCacheStats result;
+    result.numHits    = m_numHits;
+    result.numMisses  = m_numMisses;
+    result.memorySize = m_memorySize;
+    return result;
+  }
+
+
+  DxvkShaderCodeCache::EntryList::iterator DxvkShaderCodeCache::findEntry(
+    const DxvkShader*                 shader,
+    const DxvkBindingLayoutObjects*   layout,
+    const DxvkShaderModuleCreateInfo& state) {
+    auto shaderEntries = m_shaders.find(shader);
+
+    if (shaderEntries == m_shaders.end())
+      return m_entries.end();
+
+    for (auto entry : shaderEntries->second) {
+      if (entry->layout == layout && entry->state.eq(state))
+        return entry;
+    }
+
+    return m_entries.end();
+  }
+
+
+  void DxvkShaderCodeCache::removeEntry(
+          EntryList::iterator         entry) {
+    auto shaderEntries = m_shaders.find(entry->shader);
+
+    if (shaderEntries != m_shaders.end()) {
+      auto& list = shaderEntries->second;
+      list.erase(std::find(list.begin(), list.end(), entry));
+
+      if (list.empty())
+        m_shaders.erase(shaderEntries);
+    }
+
+    m_memorySize -= entry->code.size();
+    m_entries.erase(entry);
+  }
+
+
   DxvkShaderStageInfo::DxvkShaderStageInfo(const DxvkDevice* device)
   : m_device(device) {
 
@@ -733,6 +949,7 @@ namespace dxvk {
     const DxvkBindingLayoutObjects* layout)
   : m_device      (device),
     m_stats       (&manager->m_stats),
+    m_codeCache   (&manager->m_codeCache),
     m_shader      (shader),
     m_layout      (layout) {
 
@@ -997,7 +1214,7 @@ namespace dxvk {
     if (!m_shader)
       return SpirvCodeBuffer(dxvk_dummy_frag);
 
-    return m_shader->getCode(m_layout, DxvkShaderModuleCreateInfo());
+    return m_shader->getCode(m_layout, DxvkShaderModuleCreateInfo(), m_codeCache);
   }
 
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <list>
+#include <unordered_map>
 #include <vector>
 
 #include "dxvk_include.h"
@@ -10,12 +12,14 @@
 #include "../spirv/spirv_code_buffer.h"
 #include "../spirv/spirv_compression.h"
 #include "../spirv/spirv_module.h"
+#include "../spirv/spirv_optimizer.h"
 
 namespace dxvk {
   
   class DxvkShader;
   class DxvkShaderModule;
   class DxvkPipelineManager;
+  class DxvkShaderCodeCache;
   struct DxvkPipelineStats;
   
   /**
@@ -28,11 +32,24 @@ namespace dxvk {
     HasSampleRateShading,
     HasTransformFeedback,
     HasSpecConstants,
+    HasSpecConstantFallback,
     ExportsStencilRef,
     ExportsViewportIndexLayerFromVertexStage,
   };
 
   using DxvkShaderFlags = Flags<DxvkShaderFlag>;
+
+  /**
+   * \brief Specialization enable constant ID
+   *
+   * Shaders can declare a boolean specialization constant
+   * with this ID in order to read the values of all other
+   * specialization constants from a different source if
+   * the constant is \c false. Such shaders can be used with
+   * pipeline libraries, and the constant is only set to
+   * \c true when compiling optimized pipelines.
+   */
+  constexpr uint32_t DxvkSpecConstantEnableId = MaxNumSpecConstants;
   
   /**
    * \brief Shader info
@@ -49,6 +66,8 @@ namespace dxvk {
     /// Push constant range
     uint32_t pushConstOffset = 0;
     uint32_t pushConstSize = 0;
+    /// Push constant stages, or 0 for the shader stage
+    VkShaderStageFlags pushConstStages = 0;
     /// Uniform buffer data
     uint32_t uniformSize = 0;
     const char* uniformData = nullptr;
@@ -56,6 +75,8 @@ namespace dxvk {
     int32_t xfbRasterizedStream = 0;
     /// Transform feedback vertex strides
     uint32_t xfbStrides[MaxNumXfbBuffers] = { };
+    /// Whether to run the SPIR-V optimizer
+    bool optimize = false;
   };
 
 
@@ -67,6 +88,20 @@ namespace dxvk {
     uint32_t  undefinedInputs = 0;
 
     std::array<VkComponentMapping, MaxNumRenderTargets> rtSwizzles = { };
+
+    bool eq(const DxvkShaderModuleCreateInfo& other) const;
+  };
+
+
+  /**
+   * \brief Patched shader code cache stats
+   *
+   * Accumulated over all shaders used with a device.
+   */
+  struct DxvkShaderCodeCacheStats {
+    uint64_t numHits;     ///< Lookups served from cache
+    uint64_t numMisses;   ///< Lookups that had to patch code
+    uint64_t memorySize;  ///< Cached code size, in bytes
   };
   
   
@@ -79,7 +114,7 @@ namespace dxvk {
    * needs to be created from he shader object.
    */
   class DxvkShader : public RcObject {
-    
+    friend class DxvkShaderCodeCache;
   public:
     
     DxvkShader(
@@ -116,14 +151,19 @@ namespace dxvk {
      * \brief Patches code using given info
      *
      * Rewrites binding IDs and potentially fixes up other
-     * parts of the code depending on pipeline state.
+     * parts of the code depending on pipeline state. Code
+     * for frequently requested variants is cached, so that
+     * it does not need to be decompressed and patched again.
+     * A shader can only use one code cache at a time.
      * \param [in] layout Biding layout
      * \param [in] state Pipeline state info
+     * \param [in] cache Code cache, may be \c nullptr
      * \returns Uncompressed SPIR-V code buffer
      */
     SpirvCodeBuffer getCode(
       const DxvkBindingLayoutObjects*   layout,
-      const DxvkShaderModuleCreateInfo& state) const;
+      const DxvkShaderModuleCreateInfo& state,
+            DxvkShaderCodeCache*        cache) const;
     
     /**
      * \brief Tests whether this shader supports pipeline libraries
@@ -214,6 +254,12 @@ namespace dxvk {
 
     DxvkBindingLayout             m_bindings;
 
+    mutable std::atomic<DxvkShaderCodeCache*> m_codeCache = { nullptr };
+
+    SpirvCodeBuffer patchCode(
+      const DxvkBindingLayoutObjects*   layout,
+      const DxvkShaderModuleCreateInfo& state) const;
+
     static void eliminateInput(
             SpirvCodeBuffer&          code,
             uint32_t                  location);
@@ -224,6 +270,113 @@ namespace dxvk {
             const VkComponentMapping* swizzles);
 
   };
+
+
+  /**
+   * \brief Patched shader code cache
+   *
+   * Keeps uncompressed, patched code for shader variants
+   * that are requested repeatedly, e.g. when pipelines get
+   * compiled with different render state. The total amount
+   * of cached code is limited per device, and the least
+   * recently used variants are evicted first.
+   */
+  class DxvkShaderCodeCache {
+    // Number of pipeline state variants to track per shader,
+    // and number of requests before the patched code for any
+    // given variant is kept around in uncompressed form.
+    constexpr static uint32_t MaxEntriesPerShader = 4;
+    constexpr static uint32_t MinUses             = 2;
+    // Maximum size of all cached code, in bytes
+    constexpr static size_t   MaxMemorySize       = 16ull << 20;
+  public:
+
+    DxvkShaderCodeCache();
+
+    ~DxvkShaderCodeCache();
+
+    /**
+     * \brief Looks up cached code
+     *
+     * \param [in] shader Shader object
+     * \param [in] layout Binding layout
+     * \param [in] state Pipeline state info
+     * \param [out] code Cached code
+     * \returns \c true if the code was found
+     */
+    bool lookup(
+      const DxvkShader*                 shader,
+      const DxvkBindingLayoutObjects*   layout,
+      const DxvkShaderModuleCreateInfo& state,
+            SpirvCodeBuffer&            code);
+
+    /**
+     * \brief Adds patched code to the cache
+     *
+     * Only keeps the code if the variant has been
+     * requested often enough, and may evict code
+     * for other variants to stay within budget.
+     * \param [in] shader Shader object
+     * \param [in] layout Binding layout
+     * \param [in] state Pipeline state info
+     * \param [in] code Patched code
+     */
+    void insert(
+      const DxvkShader*                 shader,
+      const DxvkBindingLayoutObjects*   layout,
+      const DxvkShaderModuleCreateInfo& state,
+      const SpirvCodeBuffer&            code);
+
+    /**
+     * \brief Removes all entries for a shader
+     *
+     * Must be called when the shader gets destroyed.
+     * \param [in] shader Shader object
+     */
+    void removeShader(
+      const DxvkShader*                 shader);
+
+    /**
+     * \brief Queries cache stats
+     * \returns Cache stats
+     */
+    DxvkShaderCodeCacheStats getStats();
+
+  private:
+
+    struct Entry {
+      const DxvkShader*               shader   = nullptr;
+      const DxvkBindingLayoutObjects* layout   = nullptr;
+      DxvkShaderModuleCreateInfo      state;
+      uint32_t                        useCount = 0;
+      uint64_t                        lastUse  = 0;
+      SpirvCodeBuffer                 code;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    dxvk::mutex       m_mutex;
+
+    // Ordered from most to least recently used
+    EntryList         m_entries;
+
+    std::unordered_map<const DxvkShader*,
+      std::vector<EntryList::iterator>> m_shaders;
+
+    uint64_t          m_time        = 0;
+    uint64_t          m_numHits     = 0;
+    uint64_t          m_numMisses   = 0;
+    uint64_t          m_memorySize  = 0;
+
+    EntryList::iterator findEntry(
+      const DxvkShader*                 shader,
+      const DxvkBindingLayoutObjects*   layout,
+      const DxvkShaderModuleCreateInfo& state);
+
+    void removeEntry(
+            EntryList::iterator         entry);
+
+  };
   
 
   /**
@@ -394,6 +547,7 @@ namespace dxvk {
 
     const DxvkDevice*               m_device;
           DxvkPipelineStats*        m_stats;
+          DxvkShaderCodeCache*      m_codeCache;
     const DxvkShader*               m_shader;
     const DxvkBindingLayoutObjects* m_layout;
 
@@ -27,8 +27,16 @@ namespace dxvk {
     CsSyncCount,              ///< CS thread synchronizations
     CsSyncTicks,              ///< Time spent waiting on CS
     CsChunkCount,             ///< Submitted CS chunks
+    CsCommandCount,           ///< Executed CS commands
+    FlushImplicitCount,       ///< Implicit context flushes
+    FlushEarlyCount,          ///< Implicit flushes issued early
+    FlushDeferCount,          ///< Implicit flushes deferred
     DescriptorPoolCount,      ///< Descriptor pool count
     DescriptorSetCount,       ///< Descriptor sets allocated
+    SamplerCount,             ///< Number of cached sampler objects
+    ShaderCodeCacheHits,      ///< Patched shader code cache hits
+    ShaderCodeCacheMisses,    ///< Patched shader code cache misses
+    ShaderCodeCacheSize,      ///< Patched shader code cache size, in bytes
     NumCounters,              ///< Number of counters available
   };
   
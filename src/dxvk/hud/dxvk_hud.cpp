@@ -46,6 +46,7 @@ namespace dxvk::hud {
     addItem<HudMemoryStatsItem>("memory", -1, device);
     addItem<HudCsThreadItem>("cs", -1, device);
     addItem<HudGpuLoadItem>("gpuload", -1, device);
+    addItem<HudFlushStatsItem>("flushes", -1, device);
     addItem<HudCompilerActivityItem>("compiler", -1, device);
   }
   
@@ -468,6 +468,10 @@ namespace dxvk::hud {
     m_graphicsPipelines = counters.getCtr(DxvkStatCounter::PipeCountGraphics);
     m_graphicsLibraries = counters.getCtr(DxvkStatCounter::PipeCountLibrary);
     m_computePipelines  = counters.getCtr(DxvkStatCounter::PipeCountCompute);
+
+    m_codeCacheHits     = counters.getCtr(DxvkStatCounter::ShaderCodeCacheHits);
+    m_codeCacheMisses   = counters.getCtr(DxvkStatCounter::ShaderCodeCacheMisses);
+    m_codeCacheSize     = counters.getCtr(DxvkStatCounter::ShaderCodeCacheSize);
   }
 
 
@@ -509,6 +513,22 @@ namespace dxvk::hud {
       { 1.0f, 1.0f, 1.0f, 1.0f },
       str::format(m_computePipelines));
 
+    uint64_t codeCacheLookups = m_codeCacheHits + m_codeCacheMisses;
+
+    if (codeCacheLookups) {
+      position.y += 20.0f;
+      renderer.drawText(16.0f,
+        { position.x, position.y },
+        { 1.0f, 0.25f, 1.0f, 1.0f },
+        "Shader code cache:");
+
+      renderer.drawText(16.0f,
+        { position.x + 240.0f, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        str::format((100 * m_codeCacheHits) / codeCacheLookups, "% hits, ",
+          (m_codeCacheSize + 1023) / 1024, " kB"));
+    }
+
     position.y += 8.0f;
     return position;
   }
@@ -645,9 +665,14 @@ namespace dxvk::hud {
       uint64_t diffCsChunks = (currCsChunks - m_prevCsChunks) / m_updateCount;
       m_prevCsChunks = currCsChunks;
 
+      uint64_t currCsCommands = counters.getCtr(DxvkStatCounter::CsCommandCount);
+      uint64_t diffCsCommands = (currCsCommands - m_prevCsCommands) / m_updateCount;
+      m_prevCsCommands = currCsCommands;
+
       uint64_t syncTicks = m_maxCsSyncTicks / 100;
 
       m_csChunkString = str::format(diffCsChunks);
+      m_csCommandString = str::format(diffCsCommands);
       m_csSyncString = m_maxCsSyncCount
         ? str::format(m_maxCsSyncCount, " (", (syncTicks / 10), ".", (syncTicks % 10), " ms)")
         : str::format(m_maxCsSyncCount);
@@ -675,6 +700,17 @@ namespace dxvk::hud {
       { 1.0f, 1.0f, 1.0f, 1.0f },
       m_csChunkString);
 
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.25f, 1.0f, 0.25f, 1.0f },
+      "CS commands:");
+
+    renderer.drawText(16.0f,
+      { position.x + 132.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_csCommandString);
+
     position.y += 20.0f;
     renderer.drawText(16.0f,
       { position.x, position.y },
@@ -742,6 +778,78 @@ namespace dxvk::hud {
   }
 
 
+  HudFlushStatsItem::HudFlushStatsItem(const Rc<DxvkDevice>& device)
+  : m_device(device) {
+
+  }
+
+
+  HudFlushStatsItem::~HudFlushStatsItem() {
+
+  }
+
+
+  void HudFlushStatsItem::update(dxvk::high_resolution_clock::time_point time) {
+    uint64_t ticks = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate).count();
+
+    m_updateCount++;
+
+    if (ticks >= UpdateInterval) {
+      DxvkStatCounters counters = m_device->getStatCounters();
+      uint64_t currFlushCount = counters.getCtr(DxvkStatCounter::FlushImplicitCount);
+      uint64_t currEarlyCount = counters.getCtr(DxvkStatCounter::FlushEarlyCount);
+      uint64_t currDeferCount = counters.getCtr(DxvkStatCounter::FlushDeferCount);
+
+      // Display averages per frame, with one decimal digit
+      uint64_t diffFlushCount = (10 * (currFlushCount - m_prevFlushCount)) / m_updateCount;
+      uint64_t diffEarlyCount = (10 * (currEarlyCount - m_prevEarlyCount)) / m_updateCount;
+      uint64_t diffDeferCount = (10 * (currDeferCount - m_prevDeferCount)) / m_updateCount;
+
+      m_prevFlushCount = currFlushCount;
+      m_prevEarlyCount = currEarlyCount;
+      m_prevDeferCount = currDeferCount;
+
+      m_flushString = str::format(diffFlushCount / 10, ".", diffFlushCount % 10);
+      m_decisionString = str::format(
+        diffEarlyCount / 10, ".", diffEarlyCount % 10, " early, ",
+        diffDeferCount / 10, ".", diffDeferCount % 10, " deferred");
+
+      m_updateCount = 0;
+      m_lastUpdate = time;
+    }
+  }
+
+
+  HudPos HudFlushStatsItem::render(
+          HudRenderer&      renderer,
+          HudPos            position) {
+    position.y += 16.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 1.0f, 0.5f, 0.25f, 1.0f },
+      "Implicit flushes:");
+
+    renderer.drawText(16.0f,
+      { position.x + 228.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_flushString);
+
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 1.0f, 0.5f, 0.25f, 1.0f },
+      "Flush decisions:");
+
+    renderer.drawText(16.0f,
+      { position.x + 228.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_decisionString);
+
+    position.y += 8.0f;
+    return position;
+  }
+
+
   HudCompilerActivityItem::HudCompilerActivityItem(const Rc<DxvkDevice>& device)
   : m_device(device) {
 
@@ -334,6 +334,10 @@ namespace dxvk::hud {
     uint64_t m_graphicsLibraries  = 0;
     uint64_t m_computePipelines   = 0;
 
+    uint64_t m_codeCacheHits      = 0;
+    uint64_t m_codeCacheMisses    = 0;
+    uint64_t m_codeCacheSize      = 0;
+
   };
 
 
@@ -414,6 +418,7 @@ namespace dxvk::hud {
     uint64_t m_prevCsSyncCount  = 0;
     uint64_t m_prevCsSyncTicks  = 0;
     uint64_t m_prevCsChunks     = 0;
+    uint64_t m_prevCsCommands   = 0;
 
     uint64_t m_maxCsSyncCount   = 0;
     uint64_t m_maxCsSyncTicks   = 0;
@@ -422,6 +427,7 @@ namespace dxvk::hud {
 
     std::string m_csSyncString;
     std::string m_csChunkString;
+    std::string m_csCommandString;
 
     dxvk::high_resolution_clock::time_point m_lastUpdate
       = dxvk::high_resolution_clock::now();
@@ -461,6 +467,42 @@ namespace dxvk::hud {
   };
 
 
+  /**
+   * \brief HUD item to display implicit flush decisions
+   */
+  class HudFlushStatsItem : public HudItem {
+    constexpr static int64_t UpdateInterval = 500'000;
+  public:
+
+    HudFlushStatsItem(const Rc<DxvkDevice>& device);
+
+    ~HudFlushStatsItem();
+
+    void update(dxvk::high_resolution_clock::time_point time);
+
+    HudPos render(
+            HudRenderer&      renderer,
+            HudPos            position);
+
+  private:
+
+    Rc<DxvkDevice> m_device;
+
+    uint64_t m_prevFlushCount = 0;
+    uint64_t m_prevEarlyCount = 0;
+    uint64_t m_prevDeferCount = 0;
+
+    uint64_t m_updateCount    = 0;
+
+    std::string m_flushString;
+    std::string m_decisionString;
+
+    dxvk::high_resolution_clock::time_point m_lastUpdate
+      = dxvk::high_resolution_clock::now();
+
+  };
+
+
   /**
    * \brief HUD item to display pipeline compiler activity
    */
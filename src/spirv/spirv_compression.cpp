@@ -1,5 +1,7 @@
 #include "spirv_compression.h"
 
+#include "../util/util_bit.h"
+
 namespace dxvk {
 
   SpirvCompressedBuffer::SpirvCompressedBuffer()
@@ -93,6 +95,15 @@ namespace dxvk {
     uint32_t srcOffset = 0;
     uint32_t dstOffset = 0;
 
+    // Every block but the last one is guaranteed to be complete. The
+    // block decoder writes up to 33 DWORDs, the last one of which may
+    // be garbage that will be overwritten later, so only use it if we
+    // know that there is enough space left in the output buffer.
+    while (dstOffset + 33 <= m_size) {
+      dstOffset += decodeBlock(&m_code[srcOffset], &data[dstOffset]);
+      srcOffset += 17;
+    }
+
     constexpr uint32_t shiftAmounts = 0x0c101420;
 
     while (dstOffset < m_size) {
@@ -120,4 +131,76 @@ namespace dxvk {
     return code;
   }
 
+
+  uint32_t SpirvCompressedBuffer::decodeBlock(
+    const uint32_t*                 src,
+          uint32_t*                 dst) {
+    uint32_t blockMask = src[0];
+
+    // Each DWORD advances the output by two tokens, except
+    // for the 32-bit schema which only encodes one token.
+    uint32_t advance = (blockMask | (blockMask >> 1)) & 0x55555555;
+    uint32_t dstOffset = 0;
+
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    // Decode four DWORDs at a time. Both tokens are always written
+    // as a pair, so that we don't need to branch on the schema.
+    const __m128i schema1 = _mm_set_epi32(0x1 << 6, 0x1 << 4, 0x1 << 2, 0x1);
+    const __m128i schema2 = _mm_set_epi32(0x2 << 6, 0x2 << 4, 0x2 << 2, 0x2);
+    const __m128i schema3 = _mm_set_epi32(0x3 << 6, 0x3 << 4, 0x3 << 2, 0x3);
+
+    for (uint32_t i = 0; i < 16; i += 4) {
+      __m128i encode = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 1));
+      __m128i schema = _mm_and_si128(_mm_set1_epi32(blockMask >> (i << 1)), schema3);
+
+      __m128i is1 = _mm_cmpeq_epi32(schema, schema1);
+      __m128i is2 = _mm_cmpeq_epi32(schema, schema2);
+      __m128i is3 = _mm_cmpeq_epi32(schema, schema3);
+      __m128i is0 = _mm_cmpeq_epi32(schema, _mm_setzero_si128());
+
+      __m128i lo = _mm_and_si128(encode, _mm_or_si128(
+        _mm_or_si128(
+          _mm_and_si128(is1, _mm_set1_epi32(0xfffff)),
+          _mm_and_si128(is2, _mm_set1_epi32(0xffff))),
+        _mm_or_si128(
+          _mm_and_si128(is3, _mm_set1_epi32(0xfff)), is0)));
+
+      __m128i hi = _mm_or_si128(
+        _mm_or_si128(
+          _mm_and_si128(is1, _mm_srli_epi32(encode, 20)),
+          _mm_and_si128(is2, _mm_srli_epi32(encode, 16))),
+        _mm_and_si128(is3, _mm_srli_epi32(encode, 12)));
+
+      __m128i a = _mm_unpacklo_epi32(lo, hi);
+      __m128i b = _mm_unpackhi_epi32(lo, hi);
+
+      uint32_t n = advance >> (i << 1);
+
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + dstOffset), a);
+      dstOffset += 1 + ((n >> 0) & 1);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + dstOffset), _mm_unpackhi_epi64(a, a));
+      dstOffset += 1 + ((n >> 2) & 1);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + dstOffset), b);
+      dstOffset += 1 + ((n >> 4) & 1);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + dstOffset), _mm_unpackhi_epi64(b, b));
+      dstOffset += 1 + ((n >> 6) & 1);
+    }
+    #else
+    constexpr uint32_t shiftAmounts = 0x0c101420;
+
+    for (uint32_t i = 0; i < 16; i++) {
+      uint32_t schema = (blockMask >> (i << 1)) & 0x3;
+      uint32_t shift  = (shiftAmounts >> (schema << 3)) & 0xff;
+      uint64_t encode = src[i + 1];
+
+      dst[dstOffset + 0] = encode & ~(~0ull << shift);
+      dst[dstOffset + 1] = encode >> shift;
+
+      dstOffset += 1 + ((advance >> (i << 1)) & 1);
+    }
+    #endif
+
+    return dstOffset;
+  }
+
 }
\ No newline at end of file
@@ -33,6 +33,10 @@ namespace dxvk {
 
     uint32_t decodeDword(size_t& offset) const;
 
+    static uint32_t decodeBlock(
+      const uint32_t*                 src,
+            uint32_t*                 dst);
+
   };
 
 }
\ No newline at end of file
@@ -511,9 +511,7 @@ namespace dxvk {
       ? spv::OpSpecConstantTrue
       : spv::OpSpecConstantFalse;
     
-    m_typeConstDefs.putIns  (op, 3);
-    m_typeConstDefs.putWord (typeId);
-    m_typeConstDefs.putWord (resultId);
+    this->putTypeConst(op, typeId, resultId, 0, nullptr);
     return resultId;
   }
     
@@ -523,10 +521,8 @@ namespace dxvk {
           uint32_t                value) {
     uint32_t resultId = this->allocateId();
     
-    m_typeConstDefs.putIns  (spv::OpSpecConstant, 4);
-    m_typeConstDefs.putWord (typeId);
-    m_typeConstDefs.putWord (resultId);
-    m_typeConstDefs.putWord (value);
+    this->putTypeConst(spv::OpSpecConstant,
+      typeId, resultId, 1, &value);
     return resultId;
   }
   
@@ -764,12 +760,12 @@ namespace dxvk {
   uint32_t SpirvModule::defArrayTypeUnique(
           uint32_t                typeId,
           uint32_t                length) {
+    std::array<uint32_t, 2> args = {{ typeId, length }};
+    
     uint32_t resultId = this->allocateId();
     
-    m_typeConstDefs.putIns (spv::OpTypeArray, 4);
-    m_typeConstDefs.putWord(resultId);
-    m_typeConstDefs.putWord(typeId);
-    m_typeConstDefs.putWord(length);
+    this->putTypeConst(spv::OpTypeArray, 0,
+      resultId, args.size(), args.data());
     return resultId;
   }
   
@@ -787,9 +783,8 @@ namespace dxvk {
           uint32_t                typeId) {
     uint32_t resultId = this->allocateId();
     
-    m_typeConstDefs.putIns (spv::OpTypeRuntimeArray, 3);
-    m_typeConstDefs.putWord(resultId);
-    m_typeConstDefs.putWord(typeId);
+    this->putTypeConst(spv::OpTypeRuntimeArray, 0,
+      resultId, 1, &typeId);
     return resultId;
   }
   
@@ -822,11 +817,8 @@ namespace dxvk {
     const uint32_t*               memberTypes) {
     uint32_t resultId = this->allocateId();
     
-    m_typeConstDefs.putIns (spv::OpTypeStruct, 2 + memberCount);
-    m_typeConstDefs.putWord(resultId);
-    
-    for (uint32_t i = 0; i < memberCount; i++)
-      m_typeConstDefs.putWord(memberTypes[i]);
+    this->putTypeConst(spv::OpTypeStruct, 0,
+      resultId, memberCount, memberTypes);
     return resultId;
   }
   
@@ -3633,27 +3625,14 @@ namespace dxvk {
           spv::Op                 op, 
           uint32_t                argCount,
     const uint32_t*               argIds) {
-    // Since the type info is stored in the code buffer,
-    // we can use the code buffer to look up type IDs as
-    // well. Result IDs are always stored as argument 1.
-    for (auto ins : m_typeConstDefs) {
-      bool match = ins.opCode() == op
-                && ins.length() == 2 + argCount;
-      
-      for (uint32_t i = 0; i < argCount && match; i++)
-        match &= ins.arg(2 + i) == argIds[i];
-      
-      if (match)
-        return ins.arg(1);
-    }
+    uint32_t resultId = this->findTypeConst(op, 0, argCount, argIds);
+
+    if (resultId)
+      return resultId;
     
     // Type not yet declared, create a new one.
-    uint32_t resultId = this->allocateId();
-    m_typeConstDefs.putIns (op, 2 + argCount);
-    m_typeConstDefs.putWord(resultId);
-    
-    for (uint32_t i = 0; i < argCount; i++)
-      m_typeConstDefs.putWord(argIds[i]);
+    resultId = this->allocateId();
+    this->putTypeConst(op, 0, resultId, argCount, argIds);
     return resultId;
   }
   
@@ -3663,33 +3642,96 @@ namespace dxvk {
           uint32_t                typeId,
           uint32_t                argCount,
     const uint32_t*               argIds) {
-    // Avoid declaring constants multiple times
-    for (auto ins : m_typeConstDefs) {
-      bool match = ins.opCode() == op
-                && ins.length() == 3 + argCount
-                && ins.arg(1)   == typeId;
-      
-      for (uint32_t i = 0; i < argCount && match; i++)
-        match &= ins.arg(3 + i) == argIds[i];
+    // Avoid declaring constants multiple times. Late
+    // constants are never added to the lookup table.
+    uint32_t resultId = this->findTypeConst(op, typeId, argCount, argIds);
+
+    if (resultId)
+      return resultId;
+    
+    // Constant not yet declared, make a new one
+    resultId = this->allocateId();
+    this->putTypeConst(op, typeId, resultId, argCount, argIds);
+    return resultId;
+  }
+  
+  
+  uint32_t SpirvModule::findTypeConst(
+          spv::Op                 op,
+          uint32_t                typeId,
+          uint32_t                argCount,
+    const uint32_t*               argIds) const {
+    // Types do not have a type ID, and since zero is not
+    // a valid ID, we can use that to tell them apart.
+    // Result IDs are stored right before the arguments.
+    uint32_t argIndex = typeId ? 3 : 2;
+    uint32_t opToken = ((argIndex + argCount) << spv::WordCountShift) | op;
+
+    auto range = m_typeConstLookup.equal_range(
+      hashTypeConst(op, typeId, argCount, argIds));
+    
+    for (auto i = range.first; i != range.second; i++) {
+      const uint32_t* ins = m_typeConstDefs.data() + i->second;
+
+      bool match = ins[0] == opToken
+                && (!typeId || ins[1] == typeId);
       
-      if (!match)
-        continue;
+      for (uint32_t j = 0; j < argCount && match; j++)
+        match &= ins[argIndex + j] == argIds[j];
       
-      uint32_t id = ins.arg(2);
+      if (match)
+        return ins[argIndex - 1];
+    }
 
-      if (m_lateConsts.find(id) == m_lateConsts.end())
-        return id;
+    return 0;
+  }
+
+
+  void SpirvModule::putTypeConst(
+          spv::Op                 op,
+          uint32_t                typeId,
+          uint32_t                resultId,
+          uint32_t                argCount,
+    const uint32_t*               argIds) {
+    // Lookups must always return the first matching
+    // declaration, so do not add duplicates that may
+    // have been created by the unique type functions.
+    if (!this->findTypeConst(op, typeId, argCount, argIds)) {
+      m_typeConstLookup.insert({
+        hashTypeConst(op, typeId, argCount, argIds),
+        m_typeConstDefs.dwords() });
     }
-    
-    // Constant not yet declared, make a new one
-    uint32_t resultId = this->allocateId();
-    m_typeConstDefs.putIns (op, 3 + argCount);
-    m_typeConstDefs.putWord(typeId);
+
+    m_typeConstDefs.putIns(op, (typeId ? 3 : 2) + argCount);
+
+    if (typeId)
+      m_typeConstDefs.putWord(typeId);
+
     m_typeConstDefs.putWord(resultId);
-    
+
     for (uint32_t i = 0; i < argCount; i++)
       m_typeConstDefs.putWord(argIds[i]);
-    return resultId;
+  }
+
+
+  size_t SpirvModule::hashTypeConst(
+          spv::Op                 op,
+          uint32_t                typeId,
+          uint32_t                argCount,
+    const uint32_t*               argIds) {
+    size_t hash = size_t(op);
+
+    auto add = [&hash] (uint32_t value) {
+      hash ^= size_t(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+
+    add(typeId);
+    add(argCount);
+
+    for (uint32_t i = 0; i < argCount; i++)
+      add(argIds[i]);
+
+    return hash;
   }
   
   
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <unordered_map>
 #include <unordered_set>
 
 #include "spirv_code_buffer.h"
@@ -1259,6 +1260,8 @@ namespace dxvk {
 
     std::unordered_set<uint32_t> m_lateConsts;
 
+    std::unordered_multimap<size_t, uint32_t> m_typeConstLookup;
+
     std::vector<uint32_t> m_interfaceVars;
 
     uint32_t defType(
@@ -1272,6 +1275,25 @@ namespace dxvk {
             uint32_t                argCount,
       const uint32_t*               argIds);
     
+    uint32_t findTypeConst(
+            spv::Op                 op,
+            uint32_t                typeId,
+            uint32_t                argCount,
+      const uint32_t*               argIds) const;
+    
+    void putTypeConst(
+            spv::Op                 op,
+            uint32_t                typeId,
+            uint32_t                resultId,
+            uint32_t                argCount,
+      const uint32_t*               argIds);
+    
+    static size_t hashTypeConst(
+            spv::Op                 op,
+            uint32_t                typeId,
+            uint32_t                argCount,
+      const uint32_t*               argIds);
+    
     void instImportGlsl450();
     
     uint32_t getImageOperandWordCount(
@@ -0,0 +1,446 @@
+#define SPV_ENABLE_UTILITY_CODE
+
+#include "spirv_optimizer.h"
+
+namespace dxvk {
+
+  SpirvOptimizer::SpirvOptimizer(SpirvCodeBuffer&& code)
+  : m_code(code.data(), code.data() + code.dwords()) {
+
+  }
+
+
+  SpirvOptimizer::~SpirvOptimizer() {
+
+  }
+
+
+  SpirvCodeBuffer SpirvOptimizer::run() {
+    if (validate()) {
+      forwardLoads();
+      removeDeadVariables();
+      foldComposites();
+    }
+
+    return SpirvCodeBuffer(m_code.size(), m_code.data());
+  }
+
+
+  bool SpirvOptimizer::validate() {
+    // Only touch modules with a valid header, and make sure
+    // that we can safely walk all instructions in the module
+    if (m_code.size() < 5 || m_code[0] != spv::MagicNumber)
+      return false;
+
+    m_bound     = m_code[3];
+    m_funcStart = m_code.size();
+
+    for (size_t i = 5; i < m_code.size(); ) {
+      uint32_t len = insLength(m_code[i]);
+
+      if (!len || i + len > m_code.size())
+        return false;
+
+      if (insOpCode(m_code[i]) == spv::OpFunction && m_funcStart == m_code.size())
+        m_funcStart = i;
+
+      i += len;
+    }
+
+    return true;
+  }
+
+
+  void SpirvOptimizer::analyzeVariables() {
+    m_vars.clear();
+    m_vars.resize(m_bound);
+
+    for (size_t i = 5; i < m_code.size(); i += insLength(m_code[i])) {
+      spv::Op  op  = insOpCode(m_code[i]);
+      uint32_t len = insLength(m_code[i]);
+
+      if (op == spv::OpVariable && len >= 4) {
+        uint32_t id = m_code[i + 2];
+
+        if (id < m_bound) {
+          m_vars[id].isVar   = true;
+          m_vars[id].storage = spv::StorageClass(m_code[i + 3]);
+        }
+        continue;
+      }
+
+      // Annotations and debug names do not count as uses,
+      // and nothing else in the global section can legally
+      // reference a variable.
+      if (i < m_funcStart) {
+        if (op == spv::OpDecorate && len >= 3
+         && m_code[i + 2] == spv::DecorationLocation
+         && m_code[i + 1] < m_bound)
+          m_vars[m_code[i + 1]].hasLocation = true;
+        continue;
+      }
+
+      // We don't know which operands are IDs and which ones are
+      // literals, so treat every matching word as a use. This is
+      // conservative since it can only prevent optimizations.
+      for (uint32_t k = 1; k < len; k++) {
+        uint32_t id = m_code[i + k];
+
+        if (id >= m_bound || !m_vars[id].isVar)
+          continue;
+
+        if (op == spv::OpLoad && k == 3)
+          m_vars[id].loadCount += 1;
+        else if (op == spv::OpStore && k == 1)
+          m_vars[id].storeCount += 1;
+        else
+          m_vars[id].otherCount += 1;
+      }
+    }
+  }
+
+
+  void SpirvOptimizer::forwardLoads() {
+    analyzeVariables();
+
+    // Tracks the last known value of each variable. A value is
+    // only valid within the block it was recorded in, and any
+    // function call may modify private variables.
+    std::vector<uint32_t> values(m_bound);
+    std::vector<uint32_t> blocks(m_bound);
+    uint32_t block = 0;
+
+    for (size_t i = m_funcStart; i < m_code.size(); i += insLength(m_code[i])) {
+      spv::Op  op  = insOpCode(m_code[i]);
+      uint32_t len = insLength(m_code[i]);
+
+      if (op == spv::OpLabel || op == spv::OpFunctionCall) {
+        block += 1;
+      } else if (op == spv::OpStore && len >= 3) {
+        uint32_t ptr = m_code[i + 1];
+
+        if (ptr >= m_bound || !m_vars[ptr].isVar || m_vars[ptr].otherCount
+         || (m_vars[ptr].storage != spv::StorageClassPrivate
+          && m_vars[ptr].storage != spv::StorageClassFunction))
+          continue;
+
+        bool isVolatile = len > 3 && (m_code[i + 3] & spv::MemoryAccessVolatileMask);
+
+        values[ptr] = m_code[i + 2];
+        blocks[ptr] = isVolatile ? 0 : block;
+      } else if (op == spv::OpLoad && len >= 4) {
+        uint32_t ptr = m_code[i + 3];
+
+        if (ptr >= m_bound || !m_vars[ptr].isVar || m_vars[ptr].otherCount
+         || (m_vars[ptr].storage != spv::StorageClassPrivate
+          && m_vars[ptr].storage != spv::StorageClassFunction))
+          continue;
+
+        if (len > 4) {
+          blocks[ptr] = 0;
+        } else if (blocks[ptr] == block) {
+          m_code[i + 0] = insWord(spv::OpCopyObject, 4);
+          m_code[i + 3] = values[ptr];
+        } else {
+          values[ptr] = m_code[i + 2];
+          blocks[ptr] = block;
+        }
+      }
+    }
+  }
+
+
+  void SpirvOptimizer::removeDeadVariables() {
+    analyzeVariables();
+
+    std::vector<uint32_t> code;
+    code.reserve(m_code.size());
+    code.insert(code.end(), m_code.begin(), m_code.begin() + 5);
+
+    size_t funcStart = m_code.size();
+
+    for (size_t i = 5; i < m_code.size(); i += insLength(m_code[i])) {
+      spv::Op  op  = insOpCode(m_code[i]);
+      uint32_t len = insLength(m_code[i]);
+
+      if (i == m_funcStart)
+        funcStart = code.size();
+
+      switch (op) {
+        case spv::OpVariable:
+          if (isDeadVariable(m_code[i + 2]))
+            continue;
+          break;
+
+        case spv::OpStore:
+        case spv::OpName:
+        case spv::OpDecorate:
+        case spv::OpDecorateString:
+          if (isDeadVariable(m_code[i + 1]))
+            continue;
+          break;
+
+        case spv::OpEntryPoint: {
+          // Skip the entry point name, which is
+          // a nul-terminated string, then filter
+          // the interface list.
+          uint32_t k = 3;
+
+          while (k < len) {
+            uint32_t word = m_code[i + k++];
+
+            if (!(word & 0x000000FF) || !(word & 0x0000FF00)
+             || !(word & 0x00FF0000) || !(word & 0xFF000000))
+              break;
+          }
+
+          size_t start = code.size();
+          code.insert(code.end(), m_code.begin() + i, m_code.begin() + i + k);
+
+          for ( ; k < len; k++) {
+            if (!isDeadVariable(m_code[i + k]))
+              code.push_back(m_code[i + k]);
+          }
+
+          code[start] = insWord(op, code.size() - start);
+        } continue;
+
+        default:
+          break;
+      }
+
+      code.insert(code.end(), m_code.begin() + i, m_code.begin() + i + len);
+    }
+
+    m_code      = std::move(code);
+    m_funcStart = funcStart;
+  }
+
+
+  void SpirvOptimizer::foldComposites() {
+    std::vector<size_t> defs = getDefinitions();
+
+    std::vector<uint32_t> code;
+    code.reserve(m_code.size());
+    code.insert(code.end(), m_code.begin(), m_code.begin() + m_funcStart);
+
+    for (size_t i = m_funcStart; i < m_code.size(); i += insLength(m_code[i])) {
+      spv::Op  op  = insOpCode(m_code[i]);
+      uint32_t len = insLength(m_code[i]);
+
+      if (op == spv::OpSelect && len == 6) {
+        size_t cond = m_code[i + 3] < m_bound ? defs[m_code[i + 3]] : 0;
+
+        if (cond && (insOpCode(m_code[cond]) == spv::OpConstantTrue
+                  || insOpCode(m_code[cond]) == spv::OpConstantFalse)) {
+          bool value = insOpCode(m_code[cond]) == spv::OpConstantTrue;
+
+          code.push_back(insWord(spv::OpCopyObject, 4));
+          code.push_back(m_code[i + 1]);
+          code.push_back(m_code[i + 2]);
+          code.push_back(m_code[i + (value ? 4 : 5)]);
+          continue;
+        }
+      }
+
+      if (op == spv::OpCompositeExtract && len == 5) {
+        uint32_t index = m_code[i + 4];
+        uint32_t value = resolveExtract(defs, m_code[i + 3], index, 0);
+
+        if (index == ~0u) {
+          code.push_back(insWord(spv::OpCopyObject, 4));
+          code.push_back(m_code[i + 1]);
+          code.push_back(m_code[i + 2]);
+          code.push_back(value);
+          continue;
+        }
+
+        if (value != m_code[i + 3]) {
+          code.push_back(insWord(spv::OpCompositeExtract, 5));
+          code.push_back(m_code[i + 1]);
+          code.push_back(m_code[i + 2]);
+          code.push_back(value);
+          code.push_back(index);
+          continue;
+        }
+      }
+
+      code.insert(code.end(), m_code.begin() + i, m_code.begin() + i + len);
+    }
+
+    m_code = std::move(code);
+  }
+
+
+  bool SpirvOptimizer::isDeadVariable(
+          uint32_t                  id) const {
+    if (id >= m_bound || !m_vars[id].isVar)
+      return false;
+
+    const SpirvOptVariable& var = m_vars[id];
+
+    // Private variables that are never read can be removed along
+    // with any stores. Inputs are only removed if they are not
+    // built-ins, since those may have side effects on their own,
+    // e.g. sample IDs enabling sample rate shading.
+    switch (var.storage) {
+      case spv::StorageClassPrivate:
+      case spv::StorageClassFunction:
+        return !var.loadCount && !var.otherCount;
+
+      case spv::StorageClassInput:
+        return var.hasLocation && !var.loadCount && !var.storeCount && !var.otherCount;
+
+      default:
+        return false;
+    }
+  }
+
+
+  uint32_t SpirvOptimizer::resolveExtract(
+    const std::vector<size_t>&      defs,
+          uint32_t                  compositeId,
+          uint32_t&                 index,
+          uint32_t                  depth) const {
+    // Follows the composite operand of an extract instruction
+    // through instructions that only move components around.
+    // Sets the index to ~0u if the extracted value itself is
+    // known, otherwise returns the composite to extract from.
+    size_t def = compositeId < m_bound ? defs[compositeId] : 0;
+
+    if (!def || depth >= 16)
+      return compositeId;
+
+    spv::Op  op  = insOpCode(m_code[def]);
+    uint32_t len = insLength(m_code[def]);
+
+    switch (op) {
+      case spv::OpCopyObject:
+        return resolveExtract(defs, m_code[def + 3], index, depth + 1);
+
+      case spv::OpCompositeInsert: {
+        if (len != 6)
+          return compositeId;
+
+        if (m_code[def + 5] == index) {
+          index = ~0u;
+          return m_code[def + 3];
+        }
+
+        return resolveExtract(defs, m_code[def + 4], index, depth + 1);
+      }
+
+      case spv::OpVectorShuffle: {
+        if (index >= len - 5)
+          return compositeId;
+
+        uint32_t component = m_code[def + 5 + index];
+        uint32_t sizeA     = getVectorSize(defs, m_code[def + 3]);
+
+        if (component == ~0u || !sizeA)
+          return compositeId;
+
+        if (component < sizeA) {
+          index = component;
+          return resolveExtract(defs, m_code[def + 3], index, depth + 1);
+        } else {
+          index = component - sizeA;
+          return resolveExtract(defs, m_code[def + 4], index, depth + 1);
+        }
+      }
+
+      case spv::OpConstantComposite:
+      case spv::OpCompositeConstruct: {
+        size_t typeDef = m_code[def + 1] < m_bound ? defs[m_code[def + 1]] : 0;
+
+        if (!typeDef)
+          return compositeId;
+
+        // Vectors can be constructed from smaller vectors,
+        // all other composites take one operand per member
+        bool isVector = insOpCode(m_code[typeDef]) == spv::OpTypeVector;
+
+        uint32_t first = 0;
+
+        for (uint32_t k = 3; k < len; k++) {
+          uint32_t operand = m_code[def + k];
+          uint32_t size    = isVector ? getVectorSize(defs, operand) : 1;
+
+          if (!size)
+            return compositeId;
+
+          if (index < first + size) {
+            if (!isVector || getTypeId(defs, operand) == m_code[typeDef + 2]) {
+              index = ~0u;
+              return operand;
+            }
+
+            index -= first;
+            return resolveExtract(defs, operand, index, depth + 1);
+          }
+
+          first += size;
+        }
+
+        return compositeId;
+      }
+
+      default:
+        return compositeId;
+    }
+  }
+
+
+  uint32_t SpirvOptimizer::getVectorSize(
+    const std::vector<size_t>&      defs,
+          uint32_t                  valueId) const {
+    uint32_t typeId = getTypeId(defs, valueId);
+    size_t   def    = typeId < m_bound ? defs[typeId] : 0;
+
+    if (!def)
+      return 0;
+
+    if (insOpCode(m_code[def]) != spv::OpTypeVector)
+      return 1;
+
+    return m_code[def + 3];
+  }
+
+
+  uint32_t SpirvOptimizer::getTypeId(
+    const std::vector<size_t>&      defs,
+          uint32_t                  valueId) const {
+    size_t def = valueId < m_bound ? defs[valueId] : 0;
+
+    if (!def)
+      return 0;
+
+    bool hasResult = false;
+    bool hasType   = false;
+    spv::HasResultAndType(insOpCode(m_code[def]), &hasResult, &hasType);
+
+    return hasType ? m_code[def + 1] : 0;
+  }
+
+
+  std::vector<size_t> SpirvOptimizer::getDefinitions() const {
+    std::vector<size_t> defs(m_bound);
+
+    for (size_t i = 5; i < m_code.size(); i += insLength(m_code[i])) {
+      bool hasResult = false;
+      bool hasType   = false;
+      spv::HasResultAndType(insOpCode(m_code[i]), &hasResult, &hasType);
+
+      if (!hasResult || insLength(m_code[i]) < (hasType ? 3u : 2u))
+        continue;
+
+      uint32_t id = m_code[i + (hasType ? 2 : 1)];
+
+      if (id < m_bound)
+        defs[id] = i;
+    }
+
+    return defs;
+  }
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+
+#include "spirv_code_buffer.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Variable usage info
+   *
+   * Counts how a variable is accessed by function
+   * code. Any use other than being the pointer
+   * operand of a load or store counts as \c other.
+   */
+  struct SpirvOptVariable {
+    bool              isVar       = false;
+    bool              hasLocation = false;
+    spv::StorageClass storage     = spv::StorageClassMax;
+    uint32_t          loadCount   = 0;
+    uint32_t          storeCount  = 0;
+    uint32_t          otherCount  = 0;
+  };
+
+
+  /**
+   * \brief SPIR-V optimizer
+   *
+   * Runs a small set of conservative passes over
+   * the SPIR-V generated by the shader compilers,
+   * mostly to get rid of temporary register traffic
+   * that drivers would otherwise have to clean up
+   * at pipeline compile time:
+   *
+   * - Loads of private and function variables are
+   *   forwarded from preceding loads or stores in
+   *   the same block.
+   * - Variables that are never read, as well as
+   *   user-defined inputs that are never accessed,
+   *   are removed along with all stores to them.
+   * - Composite extracts are resolved through
+   *   shuffles, inserts and composite constructs,
+   *   and selects with a constant condition are
+   *   replaced by the selected operand.
+   *
+   * Passes never renumber IDs. Instructions whose
+   * result may still be used are replaced with an
+   * \c OpCopyObject rather than removed, so that the
+   * module stays valid without having to know the
+   * operand layout of every single instruction.
+   */
+  class SpirvOptimizer {
+
+  public:
+
+    SpirvOptimizer(SpirvCodeBuffer&& code);
+
+    ~SpirvOptimizer();
+
+    /**
+     * \brief Runs all passes
+     * \returns Optimized code
+     */
+    SpirvCodeBuffer run();
+
+  private:
+
+    std::vector<uint32_t>         m_code;
+    std::vector<SpirvOptVariable> m_vars;
+
+    uint32_t m_bound     = 0;
+    size_t   m_funcStart = 0;
+
+    bool validate();
+
+    void analyzeVariables();
+
+    void forwardLoads();
+
+    void removeDeadVariables();
+
+    void foldComposites();
+
+    bool isDeadVariable(
+            uint32_t                  id) const;
+
+    uint32_t resolveExtract(
+      const std::vector<size_t>&      defs,
+            uint32_t                  compositeId,
+            uint32_t&                 index,
+            uint32_t                  depth) const;
+
+    uint32_t getVectorSize(
+      const std::vector<size_t>&      defs,
+            uint32_t                  valueId) const;
+
+    uint32_t getTypeId(
+      const std::vector<size_t>&      defs,
+            uint32_t                  valueId) const;
+
+    std::vector<size_t> getDefinitions() const;
+
+    static uint32_t insLength(uint32_t word) {
+      return word >> spv::WordCountShift;
+    }
+
+    static spv::Op insOpCode(uint32_t word) {
+      return spv::Op(word & spv::OpCodeMask);
+    }
+
+    static uint32_t insWord(spv::Op op, uint32_t length) {
+      return uint32_t(op) | (length << spv::WordCountShift);
+    }
+
+  };
+
+}
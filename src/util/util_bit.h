@@ -315,6 +315,19 @@ namespace dxvk::bit {
       return get(idx);
     }
 
+    constexpr bool operator == (const bitset& other) const {
+      for (size_t i = 0; i < Dwords; i++) {
+        if (m_dwords[i] != other.m_dwords[i])
+          return false;
+      }
+
+      return true;
+    }
+
+    constexpr bool operator != (const bitset& other) const {
+      return !(*this == other);
+    }
+
   private:
 
     uint32_t m_dwords[Dwords];
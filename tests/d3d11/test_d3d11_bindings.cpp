@@ -0,0 +1,208 @@
+#include <d3dcompiler.h>
+#include <d3d11.h>
+
+#include <windows.h>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#include "../test_utils.h"
+
+using namespace dxvk;
+
+// Number of resources bound per stage and per draw,
+// roughly what a heavy material system would use
+constexpr uint32_t g_srvCount     = 16;
+constexpr uint32_t g_samplerCount = 16;
+constexpr uint32_t g_cbCount      = 14;
+
+constexpr uint32_t g_drawCount    = 1000;
+constexpr uint32_t g_frameCount   = 100;
+
+const std::string g_vertexShaderCode =
+  "float4 main(uint vid : SV_VERTEXID) : SV_POSITION {\n"
+  "  return float4(float(vid & 1), float(vid >> 1), 0.0f, 1.0f);\n"
+  "}\n";
+
+const std::string g_pixelShaderCode =
+  "Texture2D<float4> tex[16] : register(t0);\n"
+  "SamplerState samp[16] : register(s0);\n"
+  "cbuffer cb0 : register(b0) { float4 c0; };\n"
+  "cbuffer cb13 : register(b13) { float4 c13; };\n"
+  "float4 main() : SV_TARGET {\n"
+  "  return c0 + c13\n"
+  "    + tex[0].SampleLevel(samp[0], float2(0.5f, 0.5f), 0.0f)\n"
+  "    + tex[15].SampleLevel(samp[15], float2(0.5f, 0.5f), 0.0f);\n"
+  "}\n";
+
+struct BindingSet {
+  std::array<Com<ID3D11ShaderResourceView>, g_srvCount>   srvs;
+  std::array<Com<ID3D11SamplerState>,       g_samplerCount> samplers;
+  std::array<Com<ID3D11Buffer>,             g_cbCount>      cbs;
+};
+
+class BindingApp {
+
+public:
+
+  BindingApp() {
+    HRESULT status = D3D11CreateDevice(
+      nullptr, D3D_DRIVER_TYPE_HARDWARE,
+      nullptr, 0, nullptr, 0, D3D11_SDK_VERSION,
+      &m_device, nullptr, &m_context);
+
+    if (FAILED(status))
+      throw DxvkError("Failed to create D3D11 device");
+
+    Com<ID3DBlob> vsBlob;
+    Com<ID3DBlob> psBlob;
+
+    if (FAILED(D3DCompile(g_vertexShaderCode.data(), g_vertexShaderCode.size(),
+        "Vertex shader", nullptr, nullptr, "main", "vs_5_0", 0, 0, &vsBlob, nullptr))
+     || FAILED(D3DCompile(g_pixelShaderCode.data(), g_pixelShaderCode.size(),
+        "Pixel shader", nullptr, nullptr, "main", "ps_5_0", 0, 0, &psBlob, nullptr)))
+      throw DxvkError("Failed to compile shaders");
+
+    if (FAILED(m_device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &m_vs))
+     || FAILED(m_device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &m_ps)))
+      throw DxvkError("Failed to create shaders");
+
+    D3D11_TEXTURE2D_DESC rtDesc = { };
+    rtDesc.Width          = 64;
+    rtDesc.Height         = 64;
+    rtDesc.MipLevels      = 1;
+    rtDesc.ArraySize      = 1;
+    rtDesc.Format         = DXGI_FORMAT_R8G8B8A8_UNORM;
+    rtDesc.SampleDesc     = { 1, 0 };
+    rtDesc.Usage          = D3D11_USAGE_DEFAULT;
+    rtDesc.BindFlags      = D3D11_BIND_RENDER_TARGET;
+
+    if (FAILED(m_device->CreateTexture2D(&rtDesc, nullptr, &m_rt))
+     || FAILED(m_device->CreateRenderTargetView(m_rt.ptr(), nullptr, &m_rtv)))
+      throw DxvkError("Failed to create render target");
+
+    for (uint32_t i = 0; i < m_sets.size(); i++)
+      createBindingSet(m_sets[i], i);
+  }
+
+  void run() {
+    D3D11_VIEWPORT viewport = { 0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f };
+
+    m_context->OMSetRenderTargets(1, &m_rtv, nullptr);
+    m_context->RSSetViewports(1, &viewport);
+    m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    m_context->VSSetShader(m_vs.ptr(), nullptr, 0);
+    m_context->PSSetShader(m_ps.ptr(), nullptr, 0);
+
+    // Warm up pipelines and resources
+    runFrame();
+    m_context->Flush();
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t i = 0; i < g_frameCount; i++) {
+      runFrame();
+      m_context->Flush();
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    std::cout << "Full rebind: " << (ns / double(g_frameCount * g_drawCount)) << " ns per draw" << std::endl;
+  }
+
+  void runFrame() {
+    for (uint32_t i = 0; i < g_drawCount; i++) {
+      // Alternate between binding sets so that every
+      // single slot actually changes on every draw
+      const BindingSet& set = m_sets[i & 1];
+
+      m_context->PSSetShaderResources(0, g_srvCount, &set.srvs[0]);
+      m_context->PSSetSamplers(0, g_samplerCount, &set.samplers[0]);
+      m_context->PSSetConstantBuffers(0, g_cbCount, &set.cbs[0]);
+      m_context->Draw(4, 0);
+    }
+  }
+
+  void createBindingSet(BindingSet& set, uint32_t index) {
+    D3D11_TEXTURE2D_DESC texDesc = { };
+    texDesc.Width          = 1;
+    texDesc.Height         = 1;
+    texDesc.MipLevels      = 1;
+    texDesc.ArraySize      = 1;
+    texDesc.Format         = DXGI_FORMAT_R8G8B8A8_UNORM;
+    texDesc.SampleDesc     = { 1, 0 };
+    texDesc.Usage          = D3D11_USAGE_IMMUTABLE;
+    texDesc.BindFlags      = D3D11_BIND_SHADER_RESOURCE;
+
+    uint32_t texel = 0xFF000000u | (index * 0x40u);
+
+    D3D11_SUBRESOURCE_DATA texData = { &texel, sizeof(texel), sizeof(texel) };
+
+    for (uint32_t i = 0; i < g_srvCount; i++) {
+      Com<ID3D11Texture2D> texture;
+
+      if (FAILED(m_device->CreateTexture2D(&texDesc, &texData, &texture))
+       || FAILED(m_device->CreateShaderResourceView(texture.ptr(), nullptr, &set.srvs[i])))
+        throw DxvkError("Failed to create shader resource view");
+    }
+
+    D3D11_SAMPLER_DESC samplerDesc = { };
+    samplerDesc.Filter         = index ? D3D11_FILTER_MIN_MAG_MIP_POINT : D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    samplerDesc.AddressU       = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressV       = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressW       = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+    samplerDesc.MaxLOD         = D3D11_FLOAT32_MAX;
+
+    for (uint32_t i = 0; i < g_samplerCount; i++) {
+      // D3D11 deduplicates identical sampler states,
+      // so make sure every slot gets a unique object
+      samplerDesc.MipLODBias = float(i);
+
+      if (FAILED(m_device->CreateSamplerState(&samplerDesc, &set.samplers[i])))
+        throw DxvkError("Failed to create sampler state");
+    }
+
+    D3D11_BUFFER_DESC cbDesc = { };
+    cbDesc.ByteWidth       = 16;
+    cbDesc.Usage           = D3D11_USAGE_DEFAULT;
+    cbDesc.BindFlags       = D3D11_BIND_CONSTANT_BUFFER;
+
+    for (uint32_t i = 0; i < g_cbCount; i++) {
+      if (FAILED(m_device->CreateBuffer(&cbDesc, nullptr, &set.cbs[i])))
+        throw DxvkError("Failed to create constant buffer");
+    }
+  }
+
+private:
+
+  Com<ID3D11Device>             m_device;
+  Com<ID3D11DeviceContext>      m_context;
+
+  Com<ID3D11VertexShader>       m_vs;
+  Com<ID3D11PixelShader>        m_ps;
+
+  Com<ID3D11Texture2D>          m_rt;
+  Com<ID3D11RenderTargetView>   m_rtv;
+
+  std::array<BindingSet, 2>     m_sets;
+
+};
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  try {
+    BindingApp app;
+    app.run();
+  } catch (const dxvk::DxvkError& e) {
+    std::cerr << e.message() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
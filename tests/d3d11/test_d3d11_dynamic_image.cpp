@@ -0,0 +1,202 @@
+#include <d3dcompiler.h>
+#include <d3d11.h>
+
+#include <windows.h>
+
+#include <array>
+#include <cstring>
+#include <string>
+
+#include "../test_utils.h"
+
+using namespace dxvk;
+
+// Maps a dynamic texture with MAP_WRITE_DISCARD several times per
+// frame while previous draws still use it, then checks that every
+// draw sampled the data that was written for it. Set
+// d3d11.renameDynamicImages = True or Auto in dxvk.conf to have the
+// 256 texel wide texture mapped directly and renamed on discard.
+
+constexpr uint32_t g_textureSize = 256;
+constexpr uint32_t g_targetSize  = 64;
+constexpr uint32_t g_drawCount   = 4;
+constexpr uint32_t g_frameCount  = 64;
+
+const std::string g_vertexShaderCode =
+  "float4 main(uint vid : SV_VERTEXID) : SV_POSITION {\n"
+  "  return float4(float(vid & 1) * 4.0f - 1.0f, float(vid >> 1) * 4.0f - 1.0f, 0.0f, 1.0f);\n"
+  "}\n";
+
+const std::string g_pixelShaderCode =
+  "Texture2D<float4> tex : register(t0);\n"
+  "float4 main(float4 pos : SV_POSITION) : SV_TARGET {\n"
+  "  return tex.Load(int3(int2(pos.xy) % 256, 0));\n"
+  "}\n";
+
+class DynamicImageApp {
+
+public:
+
+  DynamicImageApp() {
+    HRESULT status = D3D11CreateDevice(
+      nullptr, D3D_DRIVER_TYPE_HARDWARE,
+      nullptr, 0, nullptr, 0, D3D11_SDK_VERSION,
+      &m_device, nullptr, &m_context);
+
+    if (FAILED(status))
+      throw DxvkError("Failed to create D3D11 device");
+
+    Com<ID3DBlob> vsBlob;
+    Com<ID3DBlob> psBlob;
+
+    if (FAILED(D3DCompile(g_vertexShaderCode.data(), g_vertexShaderCode.size(),
+        "Vertex shader", nullptr, nullptr, "main", "vs_5_0", 0, 0, &vsBlob, nullptr))
+     || FAILED(D3DCompile(g_pixelShaderCode.data(), g_pixelShaderCode.size(),
+        "Pixel shader", nullptr, nullptr, "main", "ps_5_0", 0, 0, &psBlob, nullptr)))
+      throw DxvkError("Failed to compile shaders");
+
+    if (FAILED(m_device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &m_vs))
+     || FAILED(m_device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &m_ps)))
+      throw DxvkError("Failed to create shaders");
+
+    D3D11_TEXTURE2D_DESC texDesc = { };
+    texDesc.Width          = g_textureSize;
+    texDesc.Height         = g_textureSize;
+    texDesc.MipLevels      = 1;
+    texDesc.ArraySize      = 1;
+    texDesc.Format         = DXGI_FORMAT_R8G8B8A8_UNORM;
+    texDesc.SampleDesc     = { 1, 0 };
+    texDesc.Usage          = D3D11_USAGE_DYNAMIC;
+    texDesc.BindFlags      = D3D11_BIND_SHADER_RESOURCE;
+    texDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    if (FAILED(m_device->CreateTexture2D(&texDesc, nullptr, &m_texture))
+     || FAILED(m_device->CreateShaderResourceView(m_texture.ptr(), nullptr, &m_srv)))
+      throw DxvkError("Failed to create dynamic texture");
+
+    D3D11_TEXTURE2D_DESC rtDesc = { };
+    rtDesc.Width           = g_targetSize * g_drawCount;
+    rtDesc.Height          = g_targetSize;
+    rtDesc.MipLevels       = 1;
+    rtDesc.ArraySize       = 1;
+    rtDesc.Format          = DXGI_FORMAT_R8G8B8A8_UNORM;
+    rtDesc.SampleDesc      = { 1, 0 };
+    rtDesc.Usage           = D3D11_USAGE_DEFAULT;
+    rtDesc.BindFlags       = D3D11_BIND_RENDER_TARGET;
+
+    if (FAILED(m_device->CreateTexture2D(&rtDesc, nullptr, &m_rt))
+     || FAILED(m_device->CreateRenderTargetView(m_rt.ptr(), nullptr, &m_rtv)))
+      throw DxvkError("Failed to create render target");
+
+    rtDesc.Usage           = D3D11_USAGE_STAGING;
+    rtDesc.BindFlags       = 0;
+    rtDesc.CPUAccessFlags  = D3D11_CPU_ACCESS_READ;
+
+    if (FAILED(m_device->CreateTexture2D(&rtDesc, nullptr, &m_readback)))
+      throw DxvkError("Failed to create readback texture");
+  }
+
+  bool run() {
+    m_context->OMSetRenderTargets(1, &m_rtv, nullptr);
+    m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    m_context->VSSetShader(m_vs.ptr(), nullptr, 0);
+    m_context->PSSetShader(m_ps.ptr(), nullptr, 0);
+    m_context->PSSetShaderResources(0, 1, &m_srv);
+
+    for (uint32_t i = 0; i < g_frameCount; i++) {
+      // Every map except the first one in a frame happens while
+      // the GPU has not even started executing the previous draw
+      for (uint32_t j = 0; j < g_drawCount; j++) {
+        D3D11_VIEWPORT viewport = { float(j * g_targetSize), 0.0f,
+          float(g_targetSize), float(g_targetSize), 0.0f, 1.0f };
+
+        writeTexture(getColor(i, j));
+
+        m_context->RSSetViewports(1, &viewport);
+        m_context->Draw(3, 0);
+      }
+
+      if (!checkFrame(i))
+        return false;
+    }
+
+    std::cout << "Passed" << std::endl;
+    return true;
+  }
+
+  void writeTexture(uint32_t color) {
+    D3D11_MAPPED_SUBRESOURCE sr;
+
+    if (FAILED(m_context->Map(m_texture.ptr(), 0, D3D11_MAP_WRITE_DISCARD, 0, &sr)))
+      throw DxvkError("Failed to map dynamic texture");
+
+    for (uint32_t y = 0; y < g_textureSize; y++) {
+      auto row = reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(sr.pData) + y * sr.RowPitch);
+
+      for (uint32_t x = 0; x < g_textureSize; x++)
+        row[x] = color;
+    }
+
+    m_context->Unmap(m_texture.ptr(), 0);
+  }
+
+  bool checkFrame(uint32_t frame) {
+    m_context->CopyResource(m_readback.ptr(), m_rt.ptr());
+
+    D3D11_MAPPED_SUBRESOURCE sr;
+
+    if (FAILED(m_context->Map(m_readback.ptr(), 0, D3D11_MAP_READ, 0, &sr)))
+      throw DxvkError("Failed to map readback texture");
+
+    bool success = true;
+
+    for (uint32_t j = 0; j < g_drawCount && success; j++) {
+      uint32_t expected = getColor(frame, j);
+      uint32_t actual = *reinterpret_cast<const uint32_t*>(
+        reinterpret_cast<const char*>(sr.pData) + (g_targetSize / 2) * sr.RowPitch
+          + (j * g_targetSize + g_targetSize / 2) * sizeof(uint32_t));
+
+      if (actual != expected) {
+        std::cerr << "Frame " << frame << ", draw " << j << ": Expected 0x" << std::hex
+                  << expected << ", got 0x" << actual << std::dec << std::endl;
+        success = false;
+      }
+    }
+
+    m_context->Unmap(m_readback.ptr(), 0);
+    return success;
+  }
+
+  static uint32_t getColor(uint32_t frame, uint32_t draw) {
+    return 0xFF000000u | ((frame * 4u) << 8) | ((draw * 64u) << 0);
+  }
+
+private:
+
+  Com<ID3D11Device>             m_device;
+  Com<ID3D11DeviceContext>      m_context;
+
+  Com<ID3D11VertexShader>       m_vs;
+  Com<ID3D11PixelShader>        m_ps;
+
+  Com<ID3D11Texture2D>          m_texture;
+  Com<ID3D11ShaderResourceView> m_srv;
+
+  Com<ID3D11Texture2D>          m_rt;
+  Com<ID3D11RenderTargetView>   m_rtv;
+  Com<ID3D11Texture2D>          m_readback;
+
+};
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  try {
+    DynamicImageApp app;
+    return app.run() ? 0 : 1;
+  } catch (const dxvk::DxvkError& e) {
+    std::cerr << e.message() << std::endl;
+    return 1;
+  }
+}
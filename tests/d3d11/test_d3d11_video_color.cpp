@@ -0,0 +1,93 @@
+#include <windows.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+#include "../../src/d3d11/d3d11_video_color.h"
+
+#include "../test_utils.h"
+
+using namespace dxvk;
+
+constexpr uint32_t g_imageWidth  = 128;
+constexpr uint32_t g_imageHeight = 128;
+
+// Maximum per-channel difference in 8-bit units. Quantizing
+// Y, Cb and Cr to eight bits introduces up to about 1.4 units
+// of error in the reconstructed color.
+constexpr int g_tolerance = 2;
+
+struct ColorTest {
+  const char* name;
+  bool        bt709;
+  float       kr;
+  float       kb;
+};
+
+const ColorTest g_tests[] = {
+  { "BT.601", false, 0.2990f, 0.1140f },
+  { "BT.709", true,  0.2126f, 0.0722f },
+};
+
+uint8_t quantize(float value) {
+  value = std::round(value * 255.0f);
+  return uint8_t(value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value));
+}
+
+bool runTest(const ColorTest& test, const std::vector<uint8_t>& rgb) {
+  D3D11VideoColorTransform transform = ComputeVideoColorTransform(true, test.bt709, false);
+
+  int maxError = 0;
+
+  for (size_t i = 0; i < g_imageWidth * g_imageHeight; i++) {
+    float r = float(rgb[3 * i + 0]) / 255.0f;
+    float g = float(rgb[3 * i + 1]) / 255.0f;
+    float b = float(rgb[3 * i + 2]) / 255.0f;
+
+    // Reference full-range RGB -> YCbCr conversion
+    float kg = 1.0f - test.kr - test.kb;
+    float y  = test.kr * r + kg * g + test.kb * b;
+    float cb = 0.5f + 0.5f * (b - y) / (1.0f - test.kb);
+    float cr = 0.5f + 0.5f * (r - y) / (1.0f - test.kr);
+
+    float result[3];
+    ConvertVideoColor(transform,
+      float(quantize(y))  / 255.0f,
+      float(quantize(cb)) / 255.0f,
+      float(quantize(cr)) / 255.0f,
+      result);
+
+    for (uint32_t c = 0; c < 3; c++) {
+      int error = std::abs(int(quantize(result[c])) - int(rgb[3 * i + c]));
+      maxError = std::max(maxError, error);
+    }
+  }
+
+  bool success = maxError <= g_tolerance;
+
+  std::cout << test.name << ": max error " << maxError
+            << (success ? " (pass)" : " (FAIL)") << std::endl;
+  return success;
+}
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  std::vector<uint8_t> rgb(g_imageWidth * g_imageHeight * 3);
+  std::ifstream ifile("video_image.raw", std::ios::binary);
+
+  if (!ifile || !ifile.read(reinterpret_cast<char*>(rgb.data()), rgb.size())) {
+    std::cerr << "Failed to read image file" << std::endl;
+    return 1;
+  }
+
+  bool success = true;
+
+  for (const auto& test : g_tests)
+    success &= runTest(test, rgb);
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,301 @@
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+#include <d3d9.h>
+#include <d3dcompiler.h>
+
+#include "../test_utils.h"
+
+using namespace dxvk;
+
+// Format conversions are recorded into the same context as draws.
+// This checks that vertex shader constants are still bound for
+// draws that follow a conversion within the same frame.
+
+const std::string g_vertexShaderCode = R"(
+
+float4 g_color : register( c0 );
+
+struct VS_OUTPUT {
+  float4 Position : POSITION;
+  float4 Color    : COLOR0;
+};
+
+VS_OUTPUT main( float3 Position : POSITION ) {
+  VS_OUTPUT OUT;
+  OUT.Position = float4(Position, 1.0f);
+  OUT.Color    = g_color;
+  return OUT;
+}
+
+)";
+
+const std::string g_pixelShaderCode = R"(
+
+float4 main( float4 Color : COLOR0 ) : COLOR {
+  return Color;
+}
+
+)";
+
+constexpr uint32_t g_targetSize = 64;
+constexpr uint32_t g_iterations = 8;
+
+Logger Logger::s_instance("d3d9-convert-constants.log");
+
+class ConvertConstantsApp {
+
+public:
+
+  ConvertConstantsApp(HINSTANCE instance, HWND window)
+  : m_window(window) {
+    HRESULT status = Direct3DCreate9Ex(D3D_SDK_VERSION, &m_d3d);
+
+    if (FAILED(status))
+      throw DxvkError("Failed to create D3D9 interface");
+
+    D3DPRESENT_PARAMETERS params;
+    getPresentParams(params);
+
+    status = m_d3d->CreateDeviceEx(
+      D3DADAPTER_DEFAULT,
+      D3DDEVTYPE_HAL,
+      m_window,
+      D3DCREATE_HARDWARE_VERTEXPROCESSING,
+      &params,
+      nullptr,
+      &m_device);
+
+    if (FAILED(status))
+      throw DxvkError("Failed to create D3D9 device");
+
+    m_vs = compileShader<IDirect3DVertexShader9>(g_vertexShaderCode, "vs_2_0");
+    m_ps = compileShader<IDirect3DPixelShader9>(g_pixelShaderCode, "ps_2_0");
+
+    // Single triangle that covers the entire render target
+    std::array<float, 9> vertices = {
+      -1.0f, -1.0f, 0.0f,
+      -1.0f,  3.0f, 0.0f,
+       3.0f, -1.0f, 0.0f,
+    };
+
+    if (FAILED(m_device->CreateVertexBuffer(sizeof(vertices), 0, 0, D3DPOOL_DEFAULT, &m_vb, nullptr)))
+      throw DxvkError("Failed to create vertex buffer");
+
+    void* data = nullptr;
+
+    if (FAILED(m_vb->Lock(0, 0, &data, 0)))
+      throw DxvkError("Failed to lock vertex buffer");
+
+    std::memcpy(data, vertices.data(), sizeof(vertices));
+    m_vb->Unlock();
+
+    std::array<D3DVERTEXELEMENT9, 2> elements = {{
+      { 0, 0, D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0 },
+      D3DDECL_END(),
+    }};
+
+    if (FAILED(m_device->CreateVertexDeclaration(elements.data(), &m_decl)))
+      throw DxvkError("Failed to create vertex declaration");
+
+    if (FAILED(m_device->CreateRenderTarget(g_targetSize, g_targetSize, D3DFMT_A8R8G8B8,
+        D3DMULTISAMPLE_NONE, 0, FALSE, &m_rt, nullptr)))
+      throw DxvkError("Failed to create render target");
+
+    if (FAILED(m_device->CreateOffscreenPlainSurface(g_targetSize, g_targetSize,
+        D3DFMT_A8R8G8B8, D3DPOOL_SYSTEMMEM, &m_readback, nullptr)))
+      throw DxvkError("Failed to create readback surface");
+
+    if (FAILED(m_device->CreateRenderTarget(g_targetSize, g_targetSize, D3DFMT_X8R8G8B8,
+        D3DMULTISAMPLE_NONE, 0, FALSE, &m_videoRt, nullptr)))
+      throw DxvkError("Failed to create video render target");
+
+    if (FAILED(m_device->CreateOffscreenPlainSurface(g_targetSize, g_targetSize,
+        D3DFMT_YUY2, D3DPOOL_DEFAULT, &m_yuy2, nullptr)))
+      throw DxvkError("Failed to create YUY2 surface");
+  }
+
+  bool run() {
+    bool success = true;
+
+    for (uint32_t i = 0; i < g_iterations && success; i++) {
+      m_device->SetRenderTarget(0, m_rt.ptr());
+      m_device->SetVertexShader(m_vs.ptr());
+      m_device->SetPixelShader(m_ps.ptr());
+      m_device->SetVertexDeclaration(m_decl.ptr());
+      m_device->SetStreamSource(0, m_vb.ptr(), 0, 3 * sizeof(float));
+
+      m_device->BeginScene();
+
+      // Draw once so that the constant buffers are bound
+      // before the conversion, as they would be in a game
+      std::array<float, 4> color = { 0.0f, 0.0f, 1.0f, 1.0f };
+      m_device->SetVertexShaderConstantF(0, color.data(), 1);
+      m_device->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 1);
+
+      uploadVideoFrame(i);
+
+      // Then draw with different constants after it
+      color = { 1.0f, 0.0f, 0.0f, 1.0f };
+      m_device->SetVertexShaderConstantF(0, color.data(), 1);
+      m_device->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 1);
+
+      m_device->EndScene();
+
+      success = checkColor(i, D3DCOLOR_ARGB(0xff, 0xff, 0x00, 0x00));
+    }
+
+    std::cout << (success ? "Passed" : "Failed") << std::endl;
+    return success;
+  }
+
+  void uploadVideoFrame(uint32_t frame) {
+    D3DLOCKED_RECT rect;
+
+    if (FAILED(m_yuy2->LockRect(&rect, nullptr, 0)))
+      throw DxvkError("Failed to lock YUY2 surface");
+
+    for (uint32_t y = 0; y < g_targetSize; y++)
+      std::memset(reinterpret_cast<char*>(rect.pBits) + y * rect.Pitch, int(frame * 16), g_targetSize * 2);
+
+    m_yuy2->UnlockRect();
+
+    // Unlocking the surface records the conversion,
+    // the blit makes sure that the result gets used
+    m_device->StretchRect(m_yuy2.ptr(), nullptr, m_videoRt.ptr(), nullptr, D3DTEXF_NONE);
+  }
+
+  bool checkColor(uint32_t frame, D3DCOLOR expected) {
+    if (FAILED(m_device->GetRenderTargetData(m_rt.ptr(), m_readback.ptr())))
+      throw DxvkError("Failed to read back render target");
+
+    D3DLOCKED_RECT rect;
+
+    if (FAILED(m_readback->LockRect(&rect, nullptr, D3DLOCK_READONLY)))
+      throw DxvkError("Failed to lock readback surface");
+
+    D3DCOLOR actual = *reinterpret_cast<const D3DCOLOR*>(
+      reinterpret_cast<const char*>(rect.pBits) + (g_targetSize / 2) * rect.Pitch + (g_targetSize / 2) * sizeof(D3DCOLOR));
+
+    m_readback->UnlockRect();
+
+    if (actual != expected) {
+      std::cerr << "Frame " << frame << ": Expected 0x" << std::hex << expected
+                << ", got 0x" << actual << std::dec << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  void getPresentParams(D3DPRESENT_PARAMETERS& params) {
+    params.AutoDepthStencilFormat = D3DFMT_UNKNOWN;
+    params.BackBufferCount = 1;
+    params.BackBufferFormat = D3DFMT_X8R8G8B8;
+    params.BackBufferWidth = g_targetSize;
+    params.BackBufferHeight = g_targetSize;
+    params.EnableAutoDepthStencil = FALSE;
+    params.Flags = 0;
+    params.FullScreen_RefreshRateInHz = 0;
+    params.hDeviceWindow = m_window;
+    params.MultiSampleQuality = 0;
+    params.MultiSampleType = D3DMULTISAMPLE_NONE;
+    params.PresentationInterval = D3DPRESENT_INTERVAL_DEFAULT;
+    params.SwapEffect = D3DSWAPEFFECT_DISCARD;
+    params.Windowed = TRUE;
+  }
+
+private:
+
+  HWND                          m_window;
+
+  Com<IDirect3D9Ex>             m_d3d;
+  Com<IDirect3DDevice9Ex>       m_device;
+
+  Com<IDirect3DVertexShader9>   m_vs;
+  Com<IDirect3DPixelShader9>    m_ps;
+  Com<IDirect3DVertexBuffer9>   m_vb;
+  Com<IDirect3DVertexDeclaration9> m_decl;
+
+  Com<IDirect3DSurface9>        m_rt;
+  Com<IDirect3DSurface9>        m_readback;
+  Com<IDirect3DSurface9>        m_videoRt;
+  Com<IDirect3DSurface9>        m_yuy2;
+
+  template<typename T>
+  Com<T> compileShader(const std::string& code, const char* profile) {
+    Com<ID3DBlob> blob;
+
+    if (FAILED(D3DCompile(code.data(), code.length(),
+        nullptr, nullptr, nullptr, "main", profile, 0, 0, &blob, nullptr)))
+      throw DxvkError(str::format("Failed to compile ", profile, " shader"));
+
+    auto dwords = reinterpret_cast<const DWORD*>(blob->GetBufferPointer());
+
+    Com<T> shader;
+    HRESULT status;
+
+    if constexpr (std::is_same_v<T, IDirect3DVertexShader9>)
+      status = m_device->CreateVertexShader(dwords, &shader);
+    else
+      status = m_device->CreatePixelShader(dwords, &shader);
+
+    if (FAILED(status))
+      throw DxvkError(str::format("Failed to create ", profile, " shader"));
+
+    return shader;
+  }
+
+};
+
+LRESULT CALLBACK WindowProc(HWND hWnd,
+                            UINT message,
+                            WPARAM wParam,
+                            LPARAM lParam);
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  HWND hWnd;
+  WNDCLASSEXW wc;
+  ZeroMemory(&wc, sizeof(WNDCLASSEX));
+  wc.cbSize = sizeof(WNDCLASSEX);
+  wc.style = CS_HREDRAW | CS_VREDRAW;
+  wc.lpfnWndProc = WindowProc;
+  wc.hInstance = hInstance;
+  wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
+  wc.hbrBackground = (HBRUSH)COLOR_WINDOW;
+  wc.lpszClassName = L"WindowClass1";
+  RegisterClassExW(&wc);
+
+  hWnd = CreateWindowExW(0,
+    L"WindowClass1",
+    L"Format conversion constant test",
+    WS_OVERLAPPEDWINDOW,
+    300, 300,
+    640, 480,
+    nullptr,
+    nullptr,
+    hInstance,
+    nullptr);
+
+  try {
+    ConvertConstantsApp app(hInstance, hWnd);
+    return app.run() ? 0 : 1;
+  } catch (const dxvk::DxvkError& e) {
+    std::cerr << e.message() << std::endl;
+    return 1;
+  }
+}
+
+LRESULT CALLBACK WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
+  switch (message) {
+    case WM_CLOSE:
+      PostQuitMessage(0);
+      return 0;
+  }
+
+  return DefWindowProc(hWnd, message, wParam, lParam);
+}
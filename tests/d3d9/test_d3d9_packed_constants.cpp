@@ -0,0 +1,327 @@
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#include <d3d9.h>
+#include <d3dcompiler.h>
+
+#include "../test_utils.h"
+
+using namespace dxvk;
+
+// Pixel shaders that only read float constants with immediate
+// indices get those constants packed into consecutive slots.
+// This draws with shaders that read different sets of constants
+// without touching the constants in between, so that each shader
+// switch must re-upload the packed data, and with a shader that
+// reads a constant beyond the pixel shader range of 224 registers,
+// which must not be packed and reads as zero.
+
+const std::string g_vertexShaderCode = R"(
+
+float4 main( float3 Position : POSITION ) : POSITION {
+  return float4(Position, 1.0f);
+}
+
+)";
+
+const std::string g_pixelShaderCodeA = R"(
+
+float4 a : register( c3 );
+float4 b : register( c10 );
+float4 c : register( c200 );
+
+float4 main() : COLOR {
+  return a + b + c;
+}
+
+)";
+
+const std::string g_pixelShaderCodeB = R"(
+
+float4 a : register( c5 );
+float4 b : register( c223 );
+
+float4 main() : COLOR {
+  return a + b;
+}
+
+)";
+
+// fxc refuses to compile reads of c224 and above for
+// ps_3_0, so this one is assembled by hand:
+//   ps_3_0
+//   add oC0, c1, c230
+const std::array<DWORD, 6> g_pixelShaderCodeC = {
+  0xffff0300,
+  0x03000002, 0x800f0800, 0xa0e40001, 0xa0e400e6,
+  0x0000ffff,
+};
+
+constexpr uint32_t g_targetSize    = 64;
+constexpr uint32_t g_iterations    = 8;
+constexpr uint32_t g_constantCount = 224;
+
+struct ConstantValue {
+  uint32_t             index;
+  std::array<float, 4> value;
+};
+
+// Every other constant is set to white, so that reading
+// the wrong register shows up in the resulting color.
+const std::array<ConstantValue, 6> g_constants = {{
+  { 1,   { 0.0f,  1.0f,  0.0f,  1.0f } },
+  { 3,   { 0.25f, 0.0f,  0.0f,  0.0f } },
+  { 5,   { 1.0f,  0.0f,  0.0f,  1.0f } },
+  { 10,  { 0.0f,  0.5f,  0.0f,  0.0f } },
+  { 200, { 0.0f,  0.0f,  1.0f,  1.0f } },
+  { 223, { 0.0f,  0.25f, 0.5f,  0.0f } },
+}};
+
+Logger Logger::s_instance("d3d9-packed-constants.log");
+
+class PackedConstantsApp {
+
+public:
+
+  PackedConstantsApp(HINSTANCE instance, HWND window)
+  : m_window(window) {
+    HRESULT status = Direct3DCreate9Ex(D3D_SDK_VERSION, &m_d3d);
+
+    if (FAILED(status))
+      throw DxvkError("Failed to create D3D9 interface");
+
+    D3DPRESENT_PARAMETERS params;
+    getPresentParams(params);
+
+    status = m_d3d->CreateDeviceEx(
+      D3DADAPTER_DEFAULT,
+      D3DDEVTYPE_HAL,
+      m_window,
+      D3DCREATE_HARDWARE_VERTEXPROCESSING,
+      &params,
+      nullptr,
+      &m_device);
+
+    if (FAILED(status))
+      throw DxvkError("Failed to create D3D9 device");
+
+    m_vs  = compileShader<IDirect3DVertexShader9>(g_vertexShaderCode, "vs_3_0");
+    m_psA = compileShader<IDirect3DPixelShader9>(g_pixelShaderCodeA, "ps_3_0");
+    m_psB = compileShader<IDirect3DPixelShader9>(g_pixelShaderCodeB, "ps_3_0");
+
+    if (FAILED(m_device->CreatePixelShader(g_pixelShaderCodeC.data(), &m_psC)))
+      throw DxvkError("Failed to create out-of-range pixel shader");
+
+    // Single triangle that covers the entire render target
+    std::array<float, 9> vertices = {
+      -1.0f, -1.0f, 0.0f,
+      -1.0f,  3.0f, 0.0f,
+       3.0f, -1.0f, 0.0f,
+    };
+
+    if (FAILED(m_device->CreateVertexBuffer(sizeof(vertices), 0, 0, D3DPOOL_DEFAULT, &m_vb, nullptr)))
+      throw DxvkError("Failed to create vertex buffer");
+
+    void* data = nullptr;
+
+    if (FAILED(m_vb->Lock(0, 0, &data, 0)))
+      throw DxvkError("Failed to lock vertex buffer");
+
+    std::memcpy(data, vertices.data(), sizeof(vertices));
+    m_vb->Unlock();
+
+    std::array<D3DVERTEXELEMENT9, 2> elements = {{
+      { 0, 0, D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0 },
+      D3DDECL_END(),
+    }};
+
+    if (FAILED(m_device->CreateVertexDeclaration(elements.data(), &m_decl)))
+      throw DxvkError("Failed to create vertex declaration");
+
+    if (FAILED(m_device->CreateRenderTarget(g_targetSize, g_targetSize, D3DFMT_A8R8G8B8,
+        D3DMULTISAMPLE_NONE, 0, FALSE, &m_rt, nullptr)))
+      throw DxvkError("Failed to create render target");
+
+    if (FAILED(m_device->CreateOffscreenPlainSurface(g_targetSize, g_targetSize,
+        D3DFMT_A8R8G8B8, D3DPOOL_SYSTEMMEM, &m_readback, nullptr)))
+      throw DxvkError("Failed to create readback surface");
+  }
+
+  bool run() {
+    std::array<float, 4 * g_constantCount> constants;
+    constants.fill(1.0f);
+
+    for (const auto& c : g_constants)
+      std::memcpy(&constants[4 * c.index], c.value.data(), sizeof(c.value));
+
+    m_device->SetRenderTarget(0, m_rt.ptr());
+    m_device->SetVertexShader(m_vs.ptr());
+    m_device->SetVertexDeclaration(m_decl.ptr());
+    m_device->SetStreamSource(0, m_vb.ptr(), 0, 3 * sizeof(float));
+    m_device->SetPixelShaderConstantF(0, constants.data(), g_constantCount);
+
+    bool success = true;
+
+    for (uint32_t i = 0; i < g_iterations && success; i++) {
+      // c3 + c10 + c200
+      success &= drawAndCheck(i, "A", m_psA.ptr(), D3DCOLOR_ARGB(0xff, 0x40, 0x80, 0xff));
+      // c5 + c223, packed into the slots that A used for c3 and c10
+      success &= drawAndCheck(i, "B", m_psB.ptr(), D3DCOLOR_ARGB(0xff, 0xff, 0x40, 0x80));
+      // c1 + c230, where c230 is out of range and reads as zero
+      success &= drawAndCheck(i, "C", m_psC.ptr(), D3DCOLOR_ARGB(0xff, 0x00, 0xff, 0x00));
+    }
+
+    std::cout << (success ? "Passed" : "Failed") << std::endl;
+    return success;
+  }
+
+  bool drawAndCheck(uint32_t frame, const char* name, IDirect3DPixelShader9* shader, D3DCOLOR expected) {
+    m_device->SetPixelShader(shader);
+
+    m_device->BeginScene();
+    m_device->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 1);
+    m_device->EndScene();
+
+    if (FAILED(m_device->GetRenderTargetData(m_rt.ptr(), m_readback.ptr())))
+      throw DxvkError("Failed to read back render target");
+
+    D3DLOCKED_RECT rect;
+
+    if (FAILED(m_readback->LockRect(&rect, nullptr, D3DLOCK_READONLY)))
+      throw DxvkError("Failed to lock readback surface");
+
+    D3DCOLOR actual = *reinterpret_cast<const D3DCOLOR*>(
+      reinterpret_cast<const char*>(rect.pBits) + (g_targetSize / 2) * rect.Pitch + (g_targetSize / 2) * sizeof(D3DCOLOR));
+
+    m_readback->UnlockRect();
+
+    // Allow for rounding differences when
+    // converting the output to UNORM
+    bool match = true;
+
+    for (uint32_t i = 0; i < 32; i += 8) {
+      int32_t a = int32_t((actual   >> i) & 0xff);
+      int32_t e = int32_t((expected >> i) & 0xff);
+      match &= std::abs(a - e) <= 1;
+    }
+
+    if (!match) {
+      std::cerr << "Frame " << frame << ", shader " << name << ": Expected 0x" << std::hex
+                << expected << ", got 0x" << actual << std::dec << std::endl;
+    }
+
+    return match;
+  }
+
+  void getPresentParams(D3DPRESENT_PARAMETERS& params) {
+    params.AutoDepthStencilFormat = D3DFMT_UNKNOWN;
+    params.BackBufferCount = 1;
+    params.BackBufferFormat = D3DFMT_X8R8G8B8;
+    params.BackBufferWidth = g_targetSize;
+    params.BackBufferHeight = g_targetSize;
+    params.EnableAutoDepthStencil = FALSE;
+    params.Flags = 0;
+    params.FullScreen_RefreshRateInHz = 0;
+    params.hDeviceWindow = m_window;
+    params.MultiSampleQuality = 0;
+    params.MultiSampleType = D3DMULTISAMPLE_NONE;
+    params.PresentationInterval = D3DPRESENT_INTERVAL_DEFAULT;
+    params.SwapEffect = D3DSWAPEFFECT_DISCARD;
+    params.Windowed = TRUE;
+  }
+
+private:
+
+  HWND                          m_window;
+
+  Com<IDirect3D9Ex>             m_d3d;
+  Com<IDirect3DDevice9Ex>       m_device;
+
+  Com<IDirect3DVertexShader9>   m_vs;
+  Com<IDirect3DPixelShader9>    m_psA;
+  Com<IDirect3DPixelShader9>    m_psB;
+  Com<IDirect3DPixelShader9>    m_psC;
+  Com<IDirect3DVertexBuffer9>   m_vb;
+  Com<IDirect3DVertexDeclaration9> m_decl;
+
+  Com<IDirect3DSurface9>        m_rt;
+  Com<IDirect3DSurface9>        m_readback;
+
+  template<typename T>
+  Com<T> compileShader(const std::string& code, const char* profile) {
+    Com<ID3DBlob> blob;
+
+    if (FAILED(D3DCompile(code.data(), code.length(),
+        nullptr, nullptr, nullptr, "main", profile, 0, 0, &blob, nullptr)))
+      throw DxvkError(str::format("Failed to compile ", profile, " shader"));
+
+    auto dwords = reinterpret_cast<const DWORD*>(blob->GetBufferPointer());
+
+    Com<T> shader;
+    HRESULT status;
+
+    if constexpr (std::is_same_v<T, IDirect3DVertexShader9>)
+      status = m_device->CreateVertexShader(dwords, &shader);
+    else
+      status = m_device->CreatePixelShader(dwords, &shader);
+
+    if (FAILED(status))
+      throw DxvkError(str::format("Failed to create ", profile, " shader"));
+
+    return shader;
+  }
+
+};
+
+LRESULT CALLBACK WindowProc(HWND hWnd,
+                            UINT message,
+                            WPARAM wParam,
+                            LPARAM lParam);
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  HWND hWnd;
+  WNDCLASSEXW wc;
+  ZeroMemory(&wc, sizeof(WNDCLASSEX));
+  wc.cbSize = sizeof(WNDCLASSEX);
+  wc.style = CS_HREDRAW | CS_VREDRAW;
+  wc.lpfnWndProc = WindowProc;
+  wc.hInstance = hInstance;
+  wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
+  wc.hbrBackground = (HBRUSH)COLOR_WINDOW;
+  wc.lpszClassName = L"WindowClass1";
+  RegisterClassExW(&wc);
+
+  hWnd = CreateWindowExW(0,
+    L"WindowClass1",
+    L"Packed constant test",
+    WS_OVERLAPPEDWINDOW,
+    300, 300,
+    640, 480,
+    nullptr,
+    nullptr,
+    hInstance,
+    nullptr);
+
+  try {
+    PackedConstantsApp app(hInstance, hWnd);
+    return app.run() ? 0 : 1;
+  } catch (const dxvk::DxvkError& e) {
+    std::cerr << e.message() << std::endl;
+    return 1;
+  }
+}
+
+LRESULT CALLBACK WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
+  switch (message) {
+    case WM_CLOSE:
+      PostQuitMessage(0);
+      return 0;
+  }
+
+  return DefWindowProc(hWnd, message, wParam, lParam);
+}
@@ -0,0 +1,203 @@
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include <d3d9.h>
+
+#include "../test_utils.h"
+
+using namespace dxvk;
+
+struct StateBlockBenchmark {
+  const char* name;
+  uint32_t    renderStates;
+  uint32_t    floatConstants;
+};
+
+// Render states that are safe to toggle without any
+// resources bound, used to fill recorded state blocks
+const D3DRENDERSTATETYPE g_renderStates[] = {
+  D3DRS_ZENABLE,          D3DRS_ZWRITEENABLE,     D3DRS_ALPHATESTENABLE,
+  D3DRS_SRCBLEND,         D3DRS_DESTBLEND,        D3DRS_CULLMODE,
+  D3DRS_ZFUNC,            D3DRS_ALPHAREF,         D3DRS_ALPHAFUNC,
+  D3DRS_ALPHABLENDENABLE, D3DRS_FOGENABLE,        D3DRS_SPECULARENABLE,
+  D3DRS_STENCILENABLE,    D3DRS_STENCILREF,       D3DRS_STENCILMASK,
+  D3DRS_TEXTUREFACTOR,
+};
+
+const StateBlockBenchmark g_benchmarks[] = {
+  { "1 rs",              1,   0 },
+  { "16 rs",            16,   0 },
+  { "4 vs consts",       0,   4 },
+  { "64 vs consts",      0,  64 },
+  { "256 vs consts",     0, 256 },
+  { "16 rs + 64 consts", 16,  64 },
+};
+
+constexpr uint32_t g_iterations = 10000;
+
+class StateBlockApp {
+
+public:
+
+  StateBlockApp(HINSTANCE instance, HWND window)
+  : m_window(window) {
+    HRESULT status = Direct3DCreate9Ex(D3D_SDK_VERSION, &m_d3d);
+
+    if (FAILED(status))
+      throw DxvkError("Failed to create D3D9 interface");
+
+    D3DPRESENT_PARAMETERS params;
+    getPresentParams(params);
+
+    status = m_d3d->CreateDeviceEx(
+      D3DADAPTER_DEFAULT,
+      D3DDEVTYPE_HAL,
+      m_window,
+      D3DCREATE_HARDWARE_VERTEXPROCESSING,
+      &params,
+      nullptr,
+      &m_device);
+
+    if (FAILED(status))
+      throw DxvkError("Failed to create D3D9 device");
+  }
+
+  void run() {
+    for (const auto& benchmark : g_benchmarks)
+      runRecorded(benchmark);
+
+    runCreated("D3DSBT_VERTEXSTATE", D3DSBT_VERTEXSTATE);
+    runCreated("D3DSBT_PIXELSTATE",  D3DSBT_PIXELSTATE);
+    runCreated("D3DSBT_ALL",         D3DSBT_ALL);
+  }
+
+  void runRecorded(const StateBlockBenchmark& benchmark) {
+    // Record two state blocks with different values so that
+    // every apply actually changes the state on the device
+    std::array<Com<IDirect3DStateBlock9>, 2> blocks;
+
+    for (uint32_t i = 0; i < blocks.size(); i++) {
+      if (FAILED(m_device->BeginStateBlock()))
+        throw DxvkError("Failed to begin state block");
+
+      for (uint32_t j = 0; j < benchmark.renderStates; j++)
+        m_device->SetRenderState(g_renderStates[j], i);
+
+      std::vector<float> consts(benchmark.floatConstants * 4, float(i));
+
+      if (benchmark.floatConstants)
+        m_device->SetVertexShaderConstantF(0, consts.data(), benchmark.floatConstants);
+
+      if (FAILED(m_device->EndStateBlock(&blocks[i])))
+        throw DxvkError("Failed to end state block");
+    }
+
+    report(benchmark.name, measureApply(blocks));
+  }
+
+  void runCreated(const char* name, D3DSTATEBLOCKTYPE type) {
+    std::array<Com<IDirect3DStateBlock9>, 2> blocks;
+
+    for (uint32_t i = 0; i < blocks.size(); i++) {
+      if (FAILED(m_device->CreateStateBlock(type, &blocks[i])))
+        throw DxvkError("Failed to create state block");
+    }
+
+    report(name, measureApply(blocks));
+  }
+
+  double measureApply(std::array<Com<IDirect3DStateBlock9>, 2>& blocks) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t i = 0; i < g_iterations; i++)
+      blocks[i & 1]->Apply();
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / double(g_iterations);
+  }
+
+  void report(const char* name, double nsPerApply) {
+    std::cout << name << ": " << nsPerApply << " ns per Apply" << std::endl;
+  }
+
+  void getPresentParams(D3DPRESENT_PARAMETERS& params) {
+    params.AutoDepthStencilFormat = D3DFMT_UNKNOWN;
+    params.BackBufferCount = 1;
+    params.BackBufferFormat = D3DFMT_X8R8G8B8;
+    params.BackBufferWidth = 1024;
+    params.BackBufferHeight = 600;
+    params.EnableAutoDepthStencil = FALSE;
+    params.Flags = 0;
+    params.FullScreen_RefreshRateInHz = 0;
+    params.hDeviceWindow = m_window;
+    params.MultiSampleQuality = 0;
+    params.MultiSampleType = D3DMULTISAMPLE_NONE;
+    params.PresentationInterval = D3DPRESENT_INTERVAL_DEFAULT;
+    params.SwapEffect = D3DSWAPEFFECT_DISCARD;
+    params.Windowed = TRUE;
+  }
+
+private:
+
+  HWND                          m_window;
+
+  Com<IDirect3D9Ex>             m_d3d;
+  Com<IDirect3DDevice9Ex>       m_device;
+
+};
+
+LRESULT CALLBACK WindowProc(HWND hWnd,
+                            UINT message,
+                            WPARAM wParam,
+                            LPARAM lParam);
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  HWND hWnd;
+  WNDCLASSEXW wc;
+  ZeroMemory(&wc, sizeof(WNDCLASSEX));
+  wc.cbSize = sizeof(WNDCLASSEX);
+  wc.style = CS_HREDRAW | CS_VREDRAW;
+  wc.lpfnWndProc = WindowProc;
+  wc.hInstance = hInstance;
+  wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
+  wc.hbrBackground = (HBRUSH)COLOR_WINDOW;
+  wc.lpszClassName = L"WindowClass1";
+  RegisterClassExW(&wc);
+
+  hWnd = CreateWindowExW(0,
+    L"WindowClass1",
+    L"State block benchmark",
+    WS_OVERLAPPEDWINDOW,
+    300, 300,
+    640, 480,
+    nullptr,
+    nullptr,
+    hInstance,
+    nullptr);
+
+  try {
+    StateBlockApp app(hInstance, hWnd);
+    app.run();
+  } catch (const dxvk::DxvkError& e) {
+    std::cerr << e.message() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+LRESULT CALLBACK WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
+  switch (message) {
+    case WM_CLOSE:
+      PostQuitMessage(0);
+      return 0;
+  }
+
+  return DefWindowProc(hWnd, message, wParam, lParam);
+}
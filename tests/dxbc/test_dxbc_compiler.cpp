@@ -1,9 +1,12 @@
-#include <iterator>
+#include <chrono>
 #include <fstream>
+#include <sstream>
 
 #include "../../src/dxbc/dxbc_module.h"
 #include "../../src/dxvk/dxvk_shader.h"
 
+#include "../test_files.h"
+
 #include <shellapi.h>
 #include <windows.h>
 #include <windowsx.h>
@@ -14,40 +17,137 @@ namespace dxvk {
 
 using namespace dxvk;
 
+constexpr uint32_t g_benchmarkIterations = 10;
+constexpr uint32_t g_decodeIterations = 1000;
+
+Rc<DxvkShader> compileShader(const std::vector<char>& dxbcCode, const std::string& name) {
+  DxbcReader reader(dxbcCode.data(), dxbcCode.size());
+  DxbcModule module(reader);
+
+  DxbcModuleInfo moduleInfo;
+  moduleInfo.options.useSubgroupOpsForAtomicCounters = true;
+  moduleInfo.options.useDemoteToHelperInvocation = true;
+  moduleInfo.options.minSsboAlignment = 4;
+  moduleInfo.options.optimizeSpirv = true;
+  moduleInfo.tess = nullptr;
+  moduleInfo.xfb = nullptr;
+
+  return module.compile(moduleInfo, name);
+}
+
+std::vector<TestFile> findShaders(int argc, LPWSTR* argv) {
+  std::vector<std::filesystem::path> paths(argv + 2, argv + argc);
+  return findFiles(paths, { ".dxbc" }, false);
+}
+
+int runBenchmark(int argc, LPWSTR* argv) {
+  std::vector<TestFile> files = findShaders(argc, argv);
+
+  double totalUs = 0.0;
+  size_t totalDxbc = 0;
+  size_t totalSpirv = 0;
+
+  for (const auto& file : files) {
+    std::vector<char> dxbcCode = readFile(file.path);
+    Rc<DxvkShader> shader;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t i = 0; i < g_benchmarkIterations; i++)
+      shader = compileShader(dxbcCode, file.name.string());
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    double us = std::chrono::duration<double, std::micro>(t1 - t0).count()
+              / double(g_benchmarkIterations);
+
+    std::ostringstream spirvCode;
+    shader->dump(spirvCode);
+    size_t spirvSize = spirvCode.str().size();
+
+    Logger::info(str::format(file.name.string(), ": ", dxbcCode.size(), " -> ", spirvSize,
+      " bytes, ", uint64_t(us), " us"));
+
+    totalUs += us;
+    totalDxbc += dxbcCode.size();
+    totalSpirv += spirvSize;
+  }
+
+  Logger::info(str::format("Compiled ", files.size(), " shaders (",
+    totalDxbc, " -> ", totalSpirv, " bytes) in ", uint64_t(totalUs / 1000.0), " ms"));
+  return 0;
+}
+
+int runDecodeBenchmark(int argc, LPWSTR* argv) {
+  std::vector<TestFile> files = findShaders(argc, argv);
+
+  double totalSec = 0.0;
+  size_t totalSize = 0;
+  size_t totalInstructions = 0;
+
+  for (const auto& file : files) {
+    std::vector<char> dxbcCode = readFile(file.path);
+
+    DxbcReader reader(dxbcCode.data(), dxbcCode.size());
+    DxbcModule module(reader);
+
+    size_t instructionCount = 0;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t i = 0; i < g_decodeIterations; i++) {
+      DxbcCodeSlice slice = module.code();
+      DxbcDecodeContext decoder;
+
+      instructionCount = 0;
+
+      while (!slice.atEnd()) {
+        decoder.decodeInstruction(slice);
+        instructionCount += 1;
+      }
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    totalSec += std::chrono::duration<double>(t1 - t0).count();
+    totalSize += dxbcCode.size() * g_decodeIterations;
+    totalInstructions += instructionCount * g_decodeIterations;
+  }
+
+  double mbPerSec  = totalSec ? double(totalSize) / (totalSec * 1048576.0) : 0.0;
+  double insPerSec = totalSec ? double(totalInstructions) / totalSec : 0.0;
+
+  Logger::info(str::format("Decoded ", files.size(), " shaders: ",
+    uint64_t(mbPerSec), " MB/s, ", uint64_t(insPerSec / 1000.0), "k instructions/s"));
+  return 0;
+}
+
 int WINAPI WinMain(HINSTANCE hInstance,
                    HINSTANCE hPrevInstance,
                    LPSTR lpCmdLine,
                    int nCmdShow) {
   int     argc = 0;
   LPWSTR* argv = CommandLineToArgvW(
-    GetCommandLineW(), &argc);  
-  
+    GetCommandLineW(), &argc);
+
   if (argc < 3) {
     Logger::err("Usage: dxbc-compiler input.dxbc output.spv");
+    Logger::err("       dxbc-compiler --benchmark <file or directory>...");
+    Logger::err("       dxbc-compiler --benchmark-decode <file or directory>...");
     return 1;
   }
-  
+
   try {
+    if (str::fromws(argv[1]) == "--benchmark")
+      return runBenchmark(argc, argv);
+
+    if (str::fromws(argv[1]) == "--benchmark-decode")
+      return runDecodeBenchmark(argc, argv);
+
     std::string ifileName = str::fromws(argv[1]);
-    std::ifstream ifile(ifileName, std::ios::binary);
-    ifile.ignore(std::numeric_limits<std::streamsize>::max());
-    std::streamsize length = ifile.gcount();
-    ifile.clear();
-    
-    ifile.seekg(0, std::ios_base::beg);
-    std::vector<char> dxbcCode(length);
-    ifile.read(dxbcCode.data(), length);
-    
-    DxbcReader reader(dxbcCode.data(), dxbcCode.size());
-    DxbcModule module(reader);
-    
-    DxbcModuleInfo moduleInfo;
-    moduleInfo.options.useSubgroupOpsForAtomicCounters = true;
-    moduleInfo.options.useDemoteToHelperInvocation = true;
-    moduleInfo.options.minSsboAlignment = 4;
-    moduleInfo.xfb = nullptr;
-
-    Rc<DxvkShader> shader = module.compile(moduleInfo, ifileName);
+    std::vector<char> dxbcCode = readFile(ifileName);
+
+    Rc<DxvkShader> shader = compileShader(dxbcCode, ifileName);
     std::ofstream ofile(str::fromws(argv[2]), std::ios::binary);
     shader->dump(ofile);
     return 0;
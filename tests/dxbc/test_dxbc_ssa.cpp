@@ -0,0 +1,492 @@
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <d3dcompiler.h>
+
+#include "../../src/dxbc/dxbc_analysis.h"
+#include "../../src/dxbc/dxbc_module.h"
+#include "../../src/dxvk/dxvk_shader.h"
+
+#include <shellapi.h>
+#include <windows.h>
+
+#include "../test_utils.h"
+
+namespace dxvk {
+  Logger Logger::s_instance("dxbc-ssa.log");
+}
+
+using namespace dxvk;
+
+// Compiles HLSL shaders that exercise the cases where the analyzer
+// must not emit r# components as SSA values, and checks the result
+// against a straightforward def-use scan of the decoded instructions.
+// With --dump, the SPIR-V of each case is written out so that it can
+// be checked with spirv-val, which --spirv-val runs automatically.
+
+enum class SsaCheck : uint32_t {
+  Subroutines,
+  HullShaderPhases,
+  AtomicsUnderKill,
+  PartialMasks,
+};
+
+struct SsaTestCase {
+  const char* name;
+  const char* target;
+  const char* entryPoint;
+  SsaCheck    check;
+  const char* code;
+};
+
+const std::array<SsaTestCase, 4> g_testCases = {{
+  { "subroutines", "ps_5_0", "main", SsaCheck::Subroutines, R"(
+    cbuffer cb : register(b0) { uint g_mode; float4 g_scale; };
+    Texture2D<float4> g_tex : register(t0);
+    SamplerState g_sampler : register(s0);
+
+    float4 main(float4 pos : SV_POSITION, float2 uv : TEXCOORD0) : SV_TARGET {
+      float4 base = g_tex.Sample(g_sampler, uv);
+      float4 result = base;
+
+      [call] switch (g_mode) {
+        case 0:  result = base * g_scale; break;
+        case 1:  result = base.wzyx + g_scale; break;
+        case 2:  result = sqrt(abs(base)) * g_scale.x; break;
+        default: result = base.yyyy; break;
+      }
+
+      return result + base;
+    })" },
+
+  { "hs-phases", "hs_5_0", "main", SsaCheck::HullShaderPhases, R"(
+    struct VS_CONTROL_POINT { float4 pos : POSITION; float4 color : COLOR; };
+    struct HS_CONTROL_POINT { float4 pos : POSITION; float4 color : COLOR; };
+
+    struct HS_CONSTANTS {
+      float  edges[3] : SV_TessFactor;
+      float  inside   : SV_InsideTessFactor;
+      float4 center   : CENTER;
+    };
+
+    cbuffer cb : register(b0) { float4 g_factors; };
+
+    HS_CONSTANTS patchMain(InputPatch<VS_CONTROL_POINT, 3> patch) {
+      HS_CONSTANTS result;
+      float4 center = (patch[0].pos + patch[1].pos + patch[2].pos) / 3.0f;
+
+      [unroll] for (uint i = 0; i < 3; i++)
+        result.edges[i] = max(g_factors[i] * length(patch[i].pos - center), 1.0f);
+
+      result.inside = max(g_factors.w, 1.0f);
+      result.center = center;
+      return result;
+    }
+
+    [domain("tri")]
+    [partitioning("fractional_odd")]
+    [outputtopology("triangle_cw")]
+    [outputcontrolpoints(3)]
+    [patchconstantfunc("patchMain")]
+    HS_CONTROL_POINT main(InputPatch<VS_CONTROL_POINT, 3> patch, uint id : SV_OutputControlPointID) {
+      HS_CONTROL_POINT result;
+      result.pos   = patch[id].pos * g_factors.x;
+      result.color = patch[id].color + patch[id].pos;
+      return result;
+    })" },
+
+  { "atomics-under-kill", "ps_5_0", "main", SsaCheck::AtomicsUnderKill, R"(
+    RWByteAddressBuffer g_counter : register(u1);
+    Texture2D<float4> g_tex : register(t0);
+    SamplerState g_sampler : register(s0);
+
+    float4 main(float4 pos : SV_POSITION, float2 uv : TEXCOORD0) : SV_TARGET {
+      float4 color = g_tex.Sample(g_sampler, uv);
+      clip(color.a - 0.5f);
+
+      uint index, other;
+      g_counter.InterlockedAdd(0, 1, index);
+      g_counter.InterlockedMax(4, index, other);
+      return color * float(index) + float(other);
+    })" },
+
+  { "partial-masks", "ps_5_0", "main", SsaCheck::PartialMasks, R"(
+    cbuffer cb : register(b0) { float4 g_values[16]; uint g_count; };
+
+    float4 main(float4 pos : SV_POSITION, float2 uv : TEXCOORD0) : SV_TARGET {
+      float2 base = uv * 2.0f - 1.0f;
+      float  sum  = 0.0f;
+
+      [loop] for (uint i = 0; i < g_count; i++)
+        sum += dot(g_values[i].xy, base);
+
+      return float4(base, sum, 1.0f);
+    })" },
+}};
+
+
+/**
+ * \brief Def-use info of one r# component
+ */
+struct SsaComponentInfo {
+  uint32_t writeCount   = 0;
+  bool     badWrite     = false;
+  bool     badRead      = false;
+  uint32_t function     = 0;
+};
+
+
+class SsaChecker {
+
+public:
+
+  SsaChecker(DxbcCodeSlice code) {
+    DxbcDecodeContext decoder;
+
+    while (!code.atEnd()) {
+      decoder.decodeInstruction(code);
+      processInstruction(decoder.getInstruction());
+    }
+  }
+
+  /**
+   * \brief Checks analyzer results
+   *
+   * Every component the analyzer marks as SSA must be
+   * written exactly once outside of control flow and
+   * atomics, and only be read after that write within
+   * the same function.
+   */
+  bool checkMasks(const DxbcAnalysisInfo& analysis) const {
+    bool success = true;
+
+    for (uint32_t r = 0; r < analysis.rRegSsaMasks.size(); r++) {
+      for (uint32_t c = 0; c < 4; c++) {
+        if (!analysis.rRegSsaMasks[r][c])
+          continue;
+
+        const SsaComponentInfo* info = getInfo(r, c);
+
+        if (!info || info->writeCount != 1 || info->badWrite || info->badRead) {
+          Logger::err(str::format("  r", r, ".", "xyzw"[c], " must not be SSA"));
+          success = false;
+        }
+      }
+    }
+
+    return success;
+  }
+
+  /**
+   * \brief Checks whether a component is ever written
+   */
+  bool isWritten(uint32_t r, uint32_t c) const {
+    const SsaComponentInfo* info = getInfo(r, c);
+    return info && info->writeCount;
+  }
+
+  uint32_t labelCount()  const { return m_labelCount; }
+  uint32_t phaseCount()  const { return m_phaseCount; }
+  bool     usesKill()    const { return m_usesKill; }
+
+  const std::vector<std::pair<uint32_t, DxbcRegMask>>& atomicDsts() const {
+    return m_atomicDsts;
+  }
+
+private:
+
+  std::vector<std::array<SsaComponentInfo, 4>>  m_regs;
+  std::vector<std::pair<uint32_t, DxbcRegMask>> m_atomicDsts;
+
+  uint32_t m_function   = 0;
+  uint32_t m_depth      = 0;
+  uint32_t m_labelCount = 0;
+  uint32_t m_phaseCount = 0;
+  bool     m_usesKill   = false;
+
+  const SsaComponentInfo* getInfo(uint32_t r, uint32_t c) const {
+    return r < m_regs.size() ? &m_regs[r][c] : nullptr;
+  }
+
+  void processInstruction(const DxbcShaderInstruction& ins) {
+    if (ins.op == DxbcOpcode::Label) {
+      m_function += 1;
+      m_labelCount += 1;
+    }
+
+    if (ins.opClass == DxbcInstClass::HullShaderPhase) {
+      m_function += 1;
+      m_phaseCount += 1;
+    }
+
+    if (ins.op == DxbcOpcode::Discard)
+      m_usesKill = true;
+
+    for (uint32_t i = 0; i < ins.srcCount; i++)
+      processOperand(ins.src[i], false, false);
+
+    bool isAtomic = ins.opClass == DxbcInstClass::Atomic
+                 || ins.opClass == DxbcInstClass::AtomicCounter;
+
+    for (uint32_t i = 0; i < ins.dstCount; i++)
+      processOperand(ins.dst[i], true, isAtomic);
+
+    switch (ins.op) {
+      case DxbcOpcode::If:
+      case DxbcOpcode::Loop:
+      case DxbcOpcode::Switch:
+        m_depth += 1;
+        break;
+
+      case DxbcOpcode::EndIf:
+      case DxbcOpcode::EndLoop:
+      case DxbcOpcode::EndSwitch:
+        m_depth -= 1;
+        break;
+
+      case DxbcOpcode::Ret:
+        if (!m_depth)
+          m_function += 1;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  void processOperand(const DxbcRegister& reg, bool isDst, bool isAtomic) {
+    for (uint32_t i = 0; i < reg.idxDim; i++) {
+      if (reg.idx[i].relReg)
+        processOperand(*reg.idx[i].relReg, false, false);
+    }
+
+    if (reg.type != DxbcOperandType::Temp)
+      return;
+
+    uint32_t r = reg.idx[0].offset;
+
+    if (r >= m_regs.size())
+      m_regs.resize(r + 1);
+
+    if (isAtomic)
+      m_atomicDsts.push_back({ r, reg.mask });
+
+    for (uint32_t c = 0; c < 4; c++) {
+      if (isDst) {
+        if (!reg.mask[c])
+          continue;
+
+        SsaComponentInfo& info = m_regs[r][c];
+        info.writeCount += 1;
+        info.badWrite |= m_depth != 0 || isAtomic;
+        info.function = m_function;
+      } else {
+        SsaComponentInfo& info = m_regs[r][reg.swizzle[c]];
+        info.badRead |= !info.writeCount || info.function != m_function;
+      }
+    }
+  }
+
+};
+
+
+struct SsaTestArgs {
+  std::string dumpPath;
+  std::string spirvVal;
+};
+
+
+Com<ID3DBlob> compileHlsl(const SsaTestCase& test) {
+  Com<ID3DBlob> binary;
+  Com<ID3DBlob> errors;
+
+  HRESULT hr = D3DCompile(test.code, std::strlen(test.code),
+    test.name, nullptr, nullptr, test.entryPoint, test.target,
+    D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &binary, &errors);
+
+  if (FAILED(hr)) {
+    if (errors != nullptr)
+      Logger::err(reinterpret_cast<const char*>(errors->GetBufferPointer()));
+    throw DxvkError(str::format(test.name, ": Failed to compile HLSL"));
+  }
+
+  return binary;
+}
+
+
+bool checkCase(const SsaTestCase& test, const SsaChecker& checker, const DxbcAnalysisInfo& analysis) {
+  bool success = checker.checkMasks(analysis);
+
+  uint32_t ssaCount = 0;
+  uint32_t writtenCount = 0;
+  bool hasPartialMask = false;
+
+  for (uint32_t r = 0; r < analysis.rRegSsaMasks.size(); r++) {
+    uint32_t regSsa = 0;
+    uint32_t regWritten = 0;
+
+    for (uint32_t c = 0; c < 4; c++) {
+      regSsa     += analysis.rRegSsaMasks[r][c] ? 1 : 0;
+      regWritten += checker.isWritten(r, c) ? 1 : 0;
+    }
+
+    ssaCount += regSsa;
+    writtenCount += regWritten;
+    hasPartialMask |= regSsa && regSsa < regWritten;
+  }
+
+  Logger::info(str::format("  ", ssaCount, " of ", writtenCount, " written components are SSA"));
+
+  // Every case has straight-line code that should be optimized,
+  // otherwise the checks below would trivially succeed.
+  if (!ssaCount) {
+    Logger::err("  No SSA components");
+    success = false;
+  }
+
+  switch (test.check) {
+    case SsaCheck::Subroutines:
+      if (!checker.labelCount()) {
+        Logger::err("  No subroutines in DXBC");
+        success = false;
+      }
+      break;
+
+    case SsaCheck::HullShaderPhases:
+      if (checker.phaseCount() < 2) {
+        Logger::err("  Less than two hull shader phases in DXBC");
+        success = false;
+      }
+      break;
+
+    case SsaCheck::AtomicsUnderKill:
+      if (!checker.usesKill() || checker.atomicDsts().empty()) {
+        Logger::err("  No atomics with return value after discard in DXBC");
+        success = false;
+      }
+
+      for (const auto& dst : checker.atomicDsts()) {
+        for (uint32_t c = 0; c < 4; c++) {
+          if (dst.second[c] && dst.first < analysis.rRegSsaMasks.size()
+           && analysis.rRegSsaMasks[dst.first][c]) {
+            Logger::err(str::format("  Atomic result r", dst.first, ".", "xyzw"[c], " is SSA"));
+            success = false;
+          }
+        }
+      }
+      break;
+
+    case SsaCheck::PartialMasks:
+      if (!hasPartialMask) {
+        Logger::err("  No register with partial SSA mask");
+        success = false;
+      }
+      break;
+  }
+
+  return success;
+}
+
+
+bool validateSpirv(const SsaTestArgs& args, const std::string& fileName) {
+  if (args.spirvVal.empty())
+    return true;
+
+  std::string command = str::format("\"", args.spirvVal, "\" --target-env vulkan1.3 \"", fileName, "\"");
+
+  if (std::system(command.c_str())) {
+    Logger::err(str::format("  spirv-val failed on ", fileName));
+    return false;
+  }
+
+  return true;
+}
+
+
+bool runCase(const SsaTestCase& test, const SsaTestArgs& args) {
+  Logger::info(str::format(test.name, ":"));
+
+  Com<ID3DBlob> binary = compileHlsl(test);
+
+  DxbcReader reader(
+    reinterpret_cast<const char*>(binary->GetBufferPointer()),
+    binary->GetBufferSize());
+  DxbcModule module(reader);
+
+  DxbcModuleInfo moduleInfo;
+  moduleInfo.options.useSubgroupOpsForAtomicCounters = true;
+  moduleInfo.options.useDemoteToHelperInvocation = true;
+  moduleInfo.options.minSsboAlignment = 4;
+  moduleInfo.options.optimizeSpirv = true;
+  moduleInfo.options.promoteRegisters = true;
+  moduleInfo.tess = nullptr;
+  moduleInfo.xfb = nullptr;
+
+  DxbcAnalysisInfo analysis = module.analyze(moduleInfo);
+
+  bool success = checkCase(test, SsaChecker(module.code()), analysis);
+
+  // Compiling must work regardless of the checks above,
+  // and the resulting SPIR-V must pass validation
+  Rc<DxvkShader> shader = module.compile(moduleInfo, test.name);
+
+  if (!args.dumpPath.empty()) {
+    std::string fileName = str::format(args.dumpPath, "/", test.name, ".spv");
+
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    shader->dump(file);
+    file.close();
+
+    success &= validateSpirv(args, fileName);
+  }
+
+  Logger::info(success ? "  Passed" : "  Failed");
+  return success;
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  int     argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(
+    GetCommandLineW(), &argc);
+
+  SsaTestArgs args;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = str::fromws(argv[i]);
+
+    if (arg == "--dump" && i + 1 < argc) {
+      args.dumpPath = str::fromws(argv[++i]);
+    } else if (arg == "--spirv-val" && i + 1 < argc) {
+      args.spirvVal = str::fromws(argv[++i]);
+    } else {
+      Logger::err("Usage: dxbc-ssa [--dump dir [--spirv-val path/to/spirv-val]]");
+      return 1;
+    }
+  }
+
+  if (!args.spirvVal.empty() && args.dumpPath.empty()) {
+    Logger::err("--spirv-val requires --dump");
+    return 1;
+  }
+
+  uint32_t failures = 0;
+
+  try {
+    for (const auto& test : g_testCases)
+      failures += runCase(test, args) ? 0 : 1;
+  } catch (const DxvkError& e) {
+    Logger::err(e.message());
+    return 1;
+  }
+
+  Logger::info(str::format(g_testCases.size() - failures, " of ", g_testCases.size(), " tests passed"));
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,345 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../../src/dxbc/dxbc_module.h"
+#include "../../src/dxso/dxso_module.h"
+#include "../../src/dxso/dxso_modinfo.h"
+#include "../../src/dxvk/dxvk_shader.h"
+
+#include "../../src/util/sha1/sha1_util.h"
+#include "../../src/util/thread.h"
+
+#include "../test_files.h"
+
+#include <shellapi.h>
+#include <windows.h>
+#include <psapi.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("shader-corpus.log");
+}
+
+using namespace dxvk;
+
+struct CorpusShader {
+  std::string       name;
+  std::vector<char> code;
+  bool              isDxso = false;
+};
+
+struct CorpusResult {
+  bool        success   = false;
+  double      us        = 0.0;
+  size_t      spirvSize = 0;
+  Sha1Hash    hash;
+  std::string error;
+};
+
+struct CorpusArgs {
+  uint32_t                 threads = 0;
+  bool                     optimize = false;
+  bool                     promoteRegisters = false;
+  std::string              baseline;
+  std::string              output;
+  std::vector<std::string> paths;
+};
+
+std::vector<CorpusShader> loadCorpus(const std::vector<std::string>& paths) {
+  // Directories are scanned for .dxbc and .dxso files as written
+  // out by DXVK_SHADER_DUMP_PATH, including subdirectories. Shaders
+  // are named by their path relative to the corpus root, since the
+  // same file name may occur in several subdirectories.
+  std::vector<TestFile> files = findFiles(
+    std::vector<std::filesystem::path>(paths.begin(), paths.end()),
+    { ".dxbc", ".dxso" }, true);
+
+  std::vector<CorpusShader> corpus(files.size());
+
+  for (size_t i = 0; i < files.size(); i++) {
+    corpus[i].name   = files[i].name.generic_string();
+    corpus[i].code   = readFile(files[i].path);
+    corpus[i].isDxso = files[i].path.extension() == ".dxso";
+  }
+
+  return corpus;
+}
+
+void appendCode(std::string& spirv, const Rc<DxvkShader>& shader) {
+  if (shader == nullptr)
+    return;
+
+  std::ostringstream stream;
+  shader->dump(stream);
+  spirv += stream.str();
+}
+
+std::string compileDxbc(const CorpusShader& shader, const CorpusArgs& args) {
+  DxbcReader reader(shader.code.data(), shader.code.size());
+  DxbcModule module(reader);
+
+  DxbcModuleInfo moduleInfo;
+  moduleInfo.options.useSubgroupOpsForAtomicCounters = true;
+  moduleInfo.options.useDemoteToHelperInvocation = true;
+  moduleInfo.options.minSsboAlignment = 4;
+  moduleInfo.options.optimizeSpirv = args.optimize;
+  moduleInfo.options.promoteRegisters = args.promoteRegisters;
+  moduleInfo.tess = nullptr;
+  moduleInfo.xfb = nullptr;
+
+  std::string spirv;
+  appendCode(spirv, module.compile(moduleInfo, shader.name));
+  return spirv;
+}
+
+std::string compileDxso(const CorpusShader& shader, const CorpusArgs& args) {
+  DxsoReader reader(shader.code.data());
+  DxsoModule module(reader);
+
+  // Use the defaults that a hardware vertex processing
+  // device would use with no config options applied
+  DxsoModuleInfo moduleInfo;
+  moduleInfo.options.useDemoteToHelperInvocation     = true;
+  moduleInfo.options.useSubgroupOpsForEarlyDiscard   = false;
+  moduleInfo.options.strictConstantCopies            = false;
+  moduleInfo.options.d3d9FloatEmulation              = D3D9FloatEmulation::Enabled;
+  moduleInfo.options.strictPow                       = true;
+  moduleInfo.options.shaderModel                     = 3;
+  moduleInfo.options.invariantPosition               = true;
+  moduleInfo.options.forceSamplerTypeSpecConstants   = false;
+  moduleInfo.options.vertexFloatConstantBufferAsSSBO = false;
+  moduleInfo.options.longMad                         = false;
+  moduleInfo.options.alphaTestWiggleRoom             = false;
+  moduleInfo.options.robustness2Supported            = true;
+  moduleInfo.options.optimizeSpirv                   = args.optimize;
+
+  D3D9ConstantLayout layout;
+  layout.floatCount   = module.info().type() == DxsoProgramTypes::VertexShader
+    ? caps::MaxFloatConstantsVS
+    : caps::MaxFloatConstantsPS;
+  layout.intCount     = caps::MaxOtherConstants;
+  layout.boolCount    = caps::MaxOtherConstants;
+  layout.bitmaskCount = align(layout.boolCount, 32) / 32;
+
+  DxsoAnalysisInfo analysis = module.analyze();
+  DxsoPermutations shaders = module.compile(moduleInfo, shader.name, analysis, layout);
+
+  std::string spirv;
+
+  for (const auto& permutation : shaders)
+    appendCode(spirv, permutation);
+
+  return spirv;
+}
+
+CorpusResult compileShader(const CorpusShader& shader, const CorpusArgs& args) {
+  CorpusResult result;
+
+  try {
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    std::string spirv = shader.isDxso
+      ? compileDxso(shader, args)
+      : compileDxbc(shader, args);
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    result.success   = true;
+    result.us        = std::chrono::duration<double, std::micro>(t1 - t0).count();
+    result.spirvSize = spirv.size();
+    result.hash      = Sha1Hash::compute(spirv.data(), spirv.size());
+  } catch (const DxvkError& e) {
+    result.error = e.message();
+  }
+
+  return result;
+}
+
+std::vector<CorpusResult> compileCorpus(
+  const std::vector<CorpusShader>&  corpus,
+  const CorpusArgs&                 args) {
+  std::vector<CorpusResult> results(corpus.size());
+  std::atomic<size_t> nextShader = { 0u };
+
+  auto worker = [&] {
+    size_t index;
+
+    while ((index = nextShader++) < corpus.size())
+      results[index] = compileShader(corpus[index], args);
+  };
+
+  std::vector<dxvk::thread> threads(args.threads);
+
+  for (auto& thread : threads)
+    thread = dxvk::thread(worker);
+
+  for (auto& thread : threads)
+    thread.join();
+
+  return results;
+}
+
+std::unordered_map<std::string, std::string> readBaseline(const std::string& fileName) {
+  std::unordered_map<std::string, std::string> baseline;
+
+  std::ifstream ifile(str::tows(fileName.c_str()).c_str());
+  std::string hash, size, name;
+
+  // Shader names are relative paths and may contain spaces
+  while (ifile >> hash >> size && std::getline(ifile >> std::ws, name))
+    baseline.insert({ name, hash + " " + size });
+
+  return baseline;
+}
+
+uint64_t getPeakMemoryUsage() {
+  PROCESS_MEMORY_COUNTERS counters = { };
+  counters.cb = sizeof(counters);
+
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return 0;
+
+  return counters.PeakWorkingSetSize;
+}
+
+bool parseArgs(int argc, LPWSTR* argv, CorpusArgs& args) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = str::fromws(argv[i]);
+
+    if (arg == "--threads" && i + 1 < argc)
+      args.threads = uint32_t(std::stoul(str::fromws(argv[++i])));
+    else if (arg == "--baseline" && i + 1 < argc)
+      args.baseline = str::fromws(argv[++i]);
+    else if (arg == "--output" && i + 1 < argc)
+      args.output = str::fromws(argv[++i]);
+    else if (arg == "--optimize")
+      args.optimize = true;
+    else if (arg == "--promote-registers")
+      args.promoteRegisters = true;
+    else if (arg.size() > 2 && arg.substr(0, 2) == "--")
+      return false;
+    else
+      args.paths.push_back(arg);
+  }
+
+  return !args.paths.empty();
+}
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  int     argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(
+    GetCommandLineW(), &argc);
+
+  CorpusArgs args;
+
+  if (!parseArgs(argc, argv, args)) {
+    Logger::err("Usage: shader-corpus [--threads n] [--optimize] [--promote-registers] [--output hashes.txt] [--baseline hashes.txt] <file or directory>...");
+    return 1;
+  }
+
+  if (!args.threads)
+    args.threads = std::max(dxvk::thread::hardware_concurrency(), 1u);
+
+  std::vector<CorpusShader> corpus = loadCorpus(args.paths);
+
+  auto t0 = std::chrono::high_resolution_clock::now();
+  std::vector<CorpusResult> results = compileCorpus(corpus, args);
+  auto t1 = std::chrono::high_resolution_clock::now();
+
+  double totalUs    = 0.0;
+  size_t totalInput = 0;
+  size_t totalSpirv = 0;
+  size_t failures   = 0;
+
+  std::unordered_map<std::string, std::string> baseline;
+  size_t mismatches = 0;
+  size_t missing    = 0;
+
+  if (!args.baseline.empty())
+    baseline = readBaseline(args.baseline);
+
+  std::ofstream output;
+
+  if (!args.output.empty())
+    output.open(str::tows(args.output.c_str()).c_str(), std::ios_base::trunc);
+
+  for (size_t i = 0; i < corpus.size(); i++) {
+    const CorpusShader& shader = corpus[i];
+    const CorpusResult& result = results[i];
+
+    if (!result.success) {
+      Logger::err(str::format(shader.name, ": ", result.error));
+      failures += 1;
+      continue;
+    }
+
+    std::string entry = str::format(result.hash.toString(), " ", result.spirvSize);
+
+    Logger::info(str::format(shader.name, ": ", shader.code.size(), " -> ", result.spirvSize,
+      " bytes, ", uint64_t(result.us), " us, ", result.hash.toString()));
+
+    if (!args.baseline.empty()) {
+      auto expected = baseline.find(shader.name);
+
+      if (expected == baseline.end()) {
+        Logger::warn(str::format(shader.name, ": Not in baseline"));
+      } else if (expected->second != entry) {
+        Logger::err(str::format(shader.name, ": Output changed, expected ", expected->second));
+        mismatches += 1;
+      }
+    }
+
+    if (output.is_open())
+      output << entry << " " << shader.name << std::endl;
+
+    totalUs    += result.us;
+    totalInput += shader.code.size();
+    totalSpirv += result.spirvSize;
+  }
+
+  if (!args.baseline.empty()) {
+    // Shaders that disappeared from the corpus would otherwise
+    // go unnoticed, so report baseline entries that we did not
+    // compile, in a stable order.
+    std::unordered_set<std::string> names;
+
+    for (const auto& shader : corpus)
+      names.insert(shader.name);
+
+    std::vector<std::string> missingNames;
+
+    for (const auto& entry : baseline) {
+      if (names.find(entry.first) == names.end())
+        missingNames.push_back(entry.first);
+    }
+
+    std::sort(missingNames.begin(), missingNames.end());
+
+    for (const auto& name : missingNames)
+      Logger::err(str::format(name, ": In baseline, but not in corpus"));
+
+    missing = missingNames.size();
+  }
+
+  double wallMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+  Logger::info(str::format("Compiled ", corpus.size() - failures, " of ", corpus.size(),
+    " shaders (", totalInput, " -> ", totalSpirv, " bytes) on ", args.threads, " threads"));
+  Logger::info(str::format("  Wall time:   ", uint64_t(wallMs), " ms"));
+  Logger::info(str::format("  Thread time: ", uint64_t(totalUs / 1000.0), " ms"));
+  Logger::info(str::format("  Peak memory: ", getPeakMemoryUsage() >> 20, " MB"));
+
+  if (!args.baseline.empty()) {
+    Logger::info(str::format("  Mismatches:  ", mismatches));
+    Logger::info(str::format("  Missing:     ", missing));
+  }
+
+  return (failures || mismatches || missing) ? 1 : 0;
+}
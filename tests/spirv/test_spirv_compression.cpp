@@ -0,0 +1,141 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include "../../src/spirv/spirv_compression.h"
+
+#include "../../src/util/log/log.h"
+#include "../../src/util/util_string.h"
+
+#include "../test_files.h"
+
+#include <shellapi.h>
+#include <windows.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("spirv-compression.log");
+}
+
+using namespace dxvk;
+
+constexpr uint32_t g_fuzzIterations = 20000;
+constexpr uint32_t g_benchmarkIterations = 100;
+
+uint32_t randomToken(std::mt19937& rng) {
+  // Bias towards values close to the limits of the
+  // individual encodings, as well as tokens that are
+  // typical for SPIR-V code, i.e. opcodes and low IDs.
+  static const uint32_t limits[] = { 1u << 12, 1u << 16, 1u << 20 };
+
+  switch (rng() % 5) {
+    case 0:  return rng();
+    case 1:  return limits[rng() % 3] + (rng() % 5) - 2;
+    case 2:  return rng() % (1u << 12);
+    case 3:  return rng() % (1u << 16);
+    default: return ((1 + rng() % 8) << 16) | (rng() % 400);
+  }
+}
+
+bool runFuzzTest() {
+  std::mt19937 rng(0);
+
+  for (uint32_t i = 0; i < g_fuzzIterations; i++) {
+    // Mostly test short buffers since those cover all
+    // the edge cases around incomplete blocks
+    uint32_t size = (i & 1) ? rng() % 128 : rng() % 8192;
+
+    SpirvCodeBuffer code(size);
+
+    for (uint32_t j = 0; j < size; j++)
+      code.data()[j] = randomToken(rng);
+
+    SpirvCompressedBuffer compressed(code);
+    SpirvCodeBuffer decompressed = compressed.decompress();
+
+    if (decompressed.dwords() != size || (size && std::memcmp(
+        decompressed.data(), code.data(), code.size()))) {
+      std::cerr << "Fuzz test: Mismatch in iteration " << i
+                << " (" << size << " dwords)" << std::endl;
+      return false;
+    }
+  }
+
+  std::cout << "Fuzz test: " << g_fuzzIterations << " iterations passed" << std::endl;
+  return true;
+}
+
+bool runBenchmark(int argc, LPWSTR* argv) {
+  std::vector<std::filesystem::path> paths(argv + 2, argv + argc);
+  std::vector<SpirvCodeBuffer> corpus;
+
+  for (const auto& file : findFiles(paths, { ".spv" }, false)) {
+    std::vector<char> code = readFile(file.path);
+
+    corpus.emplace_back(uint32_t(code.size() / sizeof(uint32_t)),
+      reinterpret_cast<const uint32_t*>(code.data()));
+  }
+
+  size_t rawSize = 0;
+  size_t decodedSize = 0;
+
+  std::vector<SpirvCompressedBuffer> compressed;
+  compressed.reserve(corpus.size());
+
+  auto t0 = std::chrono::high_resolution_clock::now();
+
+  for (auto& code : corpus) {
+    compressed.emplace_back(code);
+    rawSize += code.size();
+  }
+
+  auto t1 = std::chrono::high_resolution_clock::now();
+
+  for (uint32_t i = 0; i < g_benchmarkIterations; i++) {
+    for (const auto& code : compressed)
+      decodedSize += code.decompress().size();
+  }
+
+  auto t2 = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < corpus.size(); i++) {
+    SpirvCodeBuffer decompressed = compressed[i].decompress();
+
+    if (decompressed.dwords() != corpus[i].dwords() || (decompressed.dwords() && std::memcmp(
+        decompressed.data(), corpus[i].data(), corpus[i].size()))) {
+      std::cerr << "Benchmark: Mismatch in shader " << i << std::endl;
+      return false;
+    }
+  }
+
+  double encodeSec = std::chrono::duration<double>(t1 - t0).count();
+  double decodeSec = std::chrono::duration<double>(t2 - t1).count();
+
+  double encodeRate = encodeSec ? double(rawSize) / encodeSec : 0.0;
+  double decodeRate = decodeSec ? double(decodedSize) / decodeSec : 0.0;
+
+  std::cout << "Benchmark: " << corpus.size() << " shaders, " << rawSize << " bytes" << std::endl;
+  std::cout << "  Compress:   " << uint64_t(encodeRate / 1048576.0) << " MB/s" << std::endl;
+  std::cout << "  Decompress: " << uint64_t(decodeRate / 1048576.0) << " MB/s" << std::endl;
+  return true;
+}
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  int     argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(
+    GetCommandLineW(), &argc);
+
+  if (argc >= 2 && str::fromws(argv[1]) == "--benchmark")
+    return runBenchmark(argc, argv) ? 0 : 1;
+
+  if (argc >= 2) {
+    std::cerr << "Usage: spirv-compression" << std::endl;
+    std::cerr << "       spirv-compression --benchmark <file or directory>..." << std::endl;
+    return 1;
+  }
+
+  return runFuzzTest() ? 0 : 1;
+}
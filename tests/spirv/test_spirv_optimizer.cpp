@@ -0,0 +1,467 @@
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+
+#include "../../src/spirv/spirv_module.h"
+#include "../../src/spirv/spirv_optimizer.h"
+
+#include "../../src/util/log/log.h"
+#include "../../src/util/util_string.h"
+
+#include <shellapi.h>
+#include <windows.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("spirv-optimizer.log");
+}
+
+using namespace dxvk;
+
+// Builds small fragment shaders, runs the optimizer on them and
+// checks the resulting code. With --dump, the input and output
+// modules of each test are written to the given directory so
+// that they can be checked with spirv-val.
+
+std::string g_dumpPath;
+
+class TestShader {
+
+public:
+
+  TestShader()
+  : m_module(spvVersion(1, 3)) {
+    m_module.enableCapability(spv::CapabilityShader);
+    m_module.setMemoryModel(
+      spv::AddressingModelLogical,
+      spv::MemoryModelGLSL450);
+
+    voidType  = m_module.defVoidType();
+    boolType  = m_module.defBoolType();
+    floatType = m_module.defFloatType(32);
+    vec4Type  = m_module.defVectorType(floatType, 4);
+    funcType  = m_module.defFunctionType(voidType, 0, nullptr);
+
+    m_entryPointId = m_module.allocateId();
+  }
+
+  SpirvModule& module() {
+    return m_module;
+  }
+
+  uint32_t defVar(uint32_t type, spv::StorageClass storage) {
+    return m_module.newVar(m_module.defPointerType(type, storage), storage);
+  }
+
+  void beginMain() {
+    m_module.functionBegin(voidType, m_entryPointId, funcType, spv::FunctionControlMaskNone);
+    m_module.opLabel(m_module.allocateId());
+  }
+
+  SpirvCodeBuffer endMain() {
+    m_module.opReturn();
+    m_module.functionEnd();
+
+    m_module.addEntryPoint(m_entryPointId, spv::ExecutionModelFragment, "main");
+    m_module.setExecutionMode(m_entryPointId, spv::ExecutionModeOriginUpperLeft);
+    return m_module.compile();
+  }
+
+  uint32_t voidType  = 0;
+  uint32_t boolType  = 0;
+  uint32_t floatType = 0;
+  uint32_t vec4Type  = 0;
+  uint32_t funcType  = 0;
+
+private:
+
+  SpirvModule m_module;
+  uint32_t    m_entryPointId = 0;
+
+};
+
+
+uint32_t countInstructions(
+        SpirvCodeBuffer&                          code,
+  const std::function<bool (SpirvInstruction)>&   pred) {
+  uint32_t count = 0;
+
+  for (auto ins : code)
+    count += pred(ins) ? 1 : 0;
+
+  return count;
+}
+
+
+bool hasVariable(SpirvCodeBuffer& code, uint32_t varId) {
+  return countInstructions(code, [varId] (SpirvInstruction ins) {
+    return ins.opCode() == spv::OpVariable && ins.arg(2) == varId;
+  }) != 0;
+}
+
+
+uint32_t countLoads(SpirvCodeBuffer& code, uint32_t varId) {
+  return countInstructions(code, [varId] (SpirvInstruction ins) {
+    return ins.opCode() == spv::OpLoad && ins.arg(3) == varId;
+  });
+}
+
+
+uint32_t countStores(SpirvCodeBuffer& code, uint32_t varId) {
+  return countInstructions(code, [varId] (SpirvInstruction ins) {
+    return ins.opCode() == spv::OpStore && ins.arg(1) == varId;
+  });
+}
+
+
+bool isCopyOf(SpirvCodeBuffer& code, uint32_t resultId, uint32_t operandId) {
+  return countInstructions(code, [resultId, operandId] (SpirvInstruction ins) {
+    return ins.opCode() == spv::OpCopyObject
+        && ins.arg(2) == resultId
+        && ins.arg(3) == operandId;
+  }) != 0;
+}
+
+
+bool isInInterface(SpirvCodeBuffer& code, uint32_t varId) {
+  return countInstructions(code, [varId] (SpirvInstruction ins) {
+    if (ins.opCode() != spv::OpEntryPoint)
+      return false;
+
+    uint32_t first = 3 + (std::strlen(ins.chr(3)) + 4) / 4;
+
+    for (uint32_t i = first; i < ins.length(); i++) {
+      if (ins.arg(i) == varId)
+        return true;
+    }
+
+    return false;
+  }) != 0;
+}
+
+
+SpirvCodeBuffer optimize(const char* name, SpirvCodeBuffer&& code) {
+  SpirvCodeBuffer input = code;
+  SpirvCodeBuffer output = SpirvOptimizer(std::move(code)).run();
+
+  if (!g_dumpPath.empty()) {
+    std::ofstream inFile(str::format(g_dumpPath, "/", name, ".in.spv"), std::ios::binary);
+    input.store(inFile);
+
+    std::ofstream outFile(str::format(g_dumpPath, "/", name, ".out.spv"), std::ios::binary);
+    output.store(outFile);
+  }
+
+  // The optimizer must never renumber IDs
+  if (output.dwords() < 5 || output.data()[3] != input.data()[3])
+    throw DxvkError(str::format(name, ": ID bound changed"));
+
+  return output;
+}
+
+
+void expect(bool condition, const char* test, const char* message) {
+  if (!condition)
+    throw DxvkError(str::format(test, ": ", message));
+}
+
+
+void testForwardStores() {
+  // Loads from a private variable following a store in the
+  // same block must use the stored value directly, after
+  // which the variable and the store are dead.
+  TestShader shader;
+  SpirvModule& m = shader.module();
+
+  uint32_t output = shader.defVar(shader.vec4Type, spv::StorageClassOutput);
+  m.decorateLocation(output, 0);
+
+  uint32_t var = shader.defVar(shader.vec4Type, spv::StorageClassPrivate);
+  uint32_t value = m.constvec4f32(1.0f, 2.0f, 3.0f, 4.0f);
+
+  shader.beginMain();
+  m.opStore(var, value);
+  uint32_t load0 = m.opLoad(shader.vec4Type, var);
+  uint32_t load1 = m.opLoad(shader.vec4Type, var);
+  m.opStore(output, m.opFAdd(shader.vec4Type, load0, load1));
+
+  SpirvCodeBuffer code = optimize("forward-stores", shader.endMain());
+
+  expect(!countLoads(code, var), "forward-stores", "Load not forwarded");
+  expect(isCopyOf(code, load0, value), "forward-stores", "Bad value for first load");
+  expect(isCopyOf(code, load1, value), "forward-stores", "Bad value for second load");
+  expect(!hasVariable(code, var), "forward-stores", "Dead variable not removed");
+  expect(!countStores(code, var), "forward-stores", "Dead store not removed");
+  expect(countStores(code, output) == 1, "forward-stores", "Output store removed");
+}
+
+
+void testForwardLoads() {
+  // A second load without a store in between must reuse the
+  // result of the first one, but the first load has to stay.
+  TestShader shader;
+  SpirvModule& m = shader.module();
+
+  uint32_t output = shader.defVar(shader.vec4Type, spv::StorageClassOutput);
+  m.decorateLocation(output, 0);
+
+  uint32_t var = shader.defVar(shader.vec4Type, spv::StorageClassPrivate);
+
+  shader.beginMain();
+  uint32_t load0 = m.opLoad(shader.vec4Type, var);
+  uint32_t load1 = m.opLoad(shader.vec4Type, var);
+  m.opStore(output, m.opFAdd(shader.vec4Type, load0, load1));
+
+  SpirvCodeBuffer code = optimize("forward-loads", shader.endMain());
+
+  expect(countLoads(code, var) == 1, "forward-loads", "First load removed");
+  expect(isCopyOf(code, load1, load0), "forward-loads", "Second load not forwarded");
+  expect(hasVariable(code, var), "forward-loads", "Variable removed");
+}
+
+
+void testBlockBoundaries() {
+  // Stored values must not be forwarded across blocks,
+  // since the optimizer does not track control flow.
+  TestShader shader;
+  SpirvModule& m = shader.module();
+
+  uint32_t output = shader.defVar(shader.vec4Type, spv::StorageClassOutput);
+  m.decorateLocation(output, 0);
+
+  uint32_t var = shader.defVar(shader.vec4Type, spv::StorageClassPrivate);
+  uint32_t value = m.constvec4f32(1.0f, 2.0f, 3.0f, 4.0f);
+
+  shader.beginMain();
+  m.opStore(var, value);
+
+  uint32_t label = m.allocateId();
+  m.opBranch(label);
+  m.opLabel(label);
+
+  uint32_t load = m.opLoad(shader.vec4Type, var);
+  m.opStore(output, load);
+
+  SpirvCodeBuffer code = optimize("block-boundaries", shader.endMain());
+
+  expect(countLoads(code, var) == 1, "block-boundaries", "Load forwarded across blocks");
+  expect(countStores(code, var) == 1, "block-boundaries", "Store removed");
+  expect(hasVariable(code, var), "block-boundaries", "Variable removed");
+}
+
+
+void testFunctionCalls() {
+  // Function calls may write any private variable
+  TestShader shader;
+  SpirvModule& m = shader.module();
+
+  uint32_t output = shader.defVar(shader.vec4Type, spv::StorageClassOutput);
+  m.decorateLocation(output, 0);
+
+  uint32_t var = shader.defVar(shader.vec4Type, spv::StorageClassPrivate);
+  uint32_t value0 = m.constvec4f32(1.0f, 2.0f, 3.0f, 4.0f);
+  uint32_t value1 = m.constvec4f32(5.0f, 6.0f, 7.0f, 8.0f);
+
+  uint32_t funcId = m.allocateId();
+  m.functionBegin(shader.voidType, funcId, shader.funcType, spv::FunctionControlMaskNone);
+  m.opLabel(m.allocateId());
+  m.opStore(var, value1);
+  m.opReturn();
+  m.functionEnd();
+
+  shader.beginMain();
+  m.opStore(var, value0);
+  m.opFunctionCall(shader.voidType, funcId, 0, nullptr);
+  uint32_t load = m.opLoad(shader.vec4Type, var);
+  m.opStore(output, load);
+
+  SpirvCodeBuffer code = optimize("function-calls", shader.endMain());
+
+  expect(countLoads(code, var) == 1, "function-calls", "Load forwarded across function call");
+  expect(countStores(code, var) == 2, "function-calls", "Store removed");
+}
+
+
+void testAccessChains() {
+  // Variables that are accessed through pointers other than
+  // the variable itself must be left alone entirely.
+  TestShader shader;
+  SpirvModule& m = shader.module();
+
+  uint32_t output = shader.defVar(shader.vec4Type, spv::StorageClassOutput);
+  m.decorateLocation(output, 0);
+
+  uint32_t var = shader.defVar(shader.vec4Type, spv::StorageClassPrivate);
+  uint32_t value = m.constvec4f32(1.0f, 2.0f, 3.0f, 4.0f);
+  uint32_t index = m.constu32(0);
+
+  shader.beginMain();
+  m.opStore(var, value);
+
+  uint32_t ptr = m.opAccessChain(m.defPointerType(
+    shader.floatType, spv::StorageClassPrivate), var, 1, &index);
+  m.opStore(ptr, m.constf32(0.0f));
+
+  uint32_t load = m.opLoad(shader.vec4Type, var);
+  m.opStore(output, load);
+
+  SpirvCodeBuffer code = optimize("access-chains", shader.endMain());
+
+  expect(countLoads(code, var) == 1, "access-chains", "Load forwarded despite access chain");
+  expect(countStores(code, var) == 1, "access-chains", "Store removed");
+}
+
+
+void testDeadInputs() {
+  // Unused user-defined inputs are removed from the
+  // interface, used inputs and built-ins are kept.
+  TestShader shader;
+  SpirvModule& m = shader.module();
+
+  uint32_t output = shader.defVar(shader.vec4Type, spv::StorageClassOutput);
+  m.decorateLocation(output, 0);
+
+  uint32_t unused = shader.defVar(shader.vec4Type, spv::StorageClassInput);
+  m.decorateLocation(unused, 0);
+
+  uint32_t used = shader.defVar(shader.vec4Type, spv::StorageClassInput);
+  m.decorateLocation(used, 1);
+
+  uint32_t builtin = shader.defVar(shader.vec4Type, spv::StorageClassInput);
+  m.decorateBuiltIn(builtin, spv::BuiltInFragCoord);
+
+  shader.beginMain();
+  m.opStore(output, m.opLoad(shader.vec4Type, used));
+
+  SpirvCodeBuffer code = optimize("dead-inputs", shader.endMain());
+
+  expect(!hasVariable(code, unused), "dead-inputs", "Unused input not removed");
+  expect(!isInInterface(code, unused), "dead-inputs", "Unused input still in interface");
+  expect(!countInstructions(code, [unused] (SpirvInstruction ins) {
+    return ins.opCode() == spv::OpDecorate && ins.arg(1) == unused;
+  }), "dead-inputs", "Decoration of unused input not removed");
+
+  expect(hasVariable(code, used) && isInInterface(code, used), "dead-inputs", "Used input removed");
+  expect(hasVariable(code, builtin) && isInInterface(code, builtin), "dead-inputs", "Built-in removed");
+  expect(hasVariable(code, output) && isInInterface(code, output), "dead-inputs", "Output removed");
+}
+
+
+void testComposites() {
+  // Extracts are resolved through constructs, shuffles and
+  // inserts, and selects with a constant condition are folded.
+  TestShader shader;
+  SpirvModule& m = shader.module();
+
+  uint32_t output = shader.defVar(shader.vec4Type, spv::StorageClassOutput);
+  m.decorateLocation(output, 0);
+
+  uint32_t input = shader.defVar(shader.vec4Type, spv::StorageClassInput);
+  m.decorateLocation(input, 0);
+
+  shader.beginMain();
+  uint32_t vector = m.opLoad(shader.vec4Type, input);
+
+  std::array<uint32_t, 4> scalars;
+
+  for (uint32_t i = 0; i < 4; i++)
+    scalars[i] = m.opCompositeExtract(shader.floatType, vector, 1, &i);
+
+  uint32_t construct = m.opCompositeConstruct(shader.vec4Type, scalars.size(), scalars.data());
+
+  uint32_t index = 2;
+  uint32_t extractConstruct = m.opCompositeExtract(shader.floatType, construct, 1, &index);
+
+  std::array<uint32_t, 4> swizzle = { 3, 2, 1, 0 };
+  uint32_t shuffle = m.opVectorShuffle(shader.vec4Type, construct, construct, swizzle.size(), swizzle.data());
+
+  index = 0;
+  uint32_t extractShuffle = m.opCompositeExtract(shader.floatType, shuffle, 1, &index);
+
+  uint32_t scalar = m.constf32(1.0f);
+  index = 1;
+  uint32_t insert = m.opCompositeInsert(shader.vec4Type, scalar, construct, 1, &index);
+  uint32_t extractInsert = m.opCompositeExtract(shader.floatType, insert, 1, &index);
+
+  index = 3;
+  uint32_t extractBehindInsert = m.opCompositeExtract(shader.floatType, insert, 1, &index);
+
+  uint32_t select = m.opSelect(shader.floatType, m.constBool(false), scalars[0], scalars[1]);
+
+  std::array<uint32_t, 4> results0 = { extractConstruct, extractShuffle, extractInsert, select };
+  std::array<uint32_t, 4> results1 = { extractBehindInsert, scalar, scalar, scalar };
+
+  m.opStore(output, m.opFAdd(shader.vec4Type,
+    m.opCompositeConstruct(shader.vec4Type, results0.size(), results0.data()),
+    m.opCompositeConstruct(shader.vec4Type, results1.size(), results1.data())));
+
+  SpirvCodeBuffer code = optimize("composites", shader.endMain());
+
+  expect(isCopyOf(code, extractConstruct, scalars[2]), "composites", "Extract from construct not resolved");
+  expect(isCopyOf(code, extractShuffle, scalars[3]), "composites", "Extract from shuffle not resolved");
+  expect(isCopyOf(code, extractInsert, scalar), "composites", "Extract from insert not resolved");
+  expect(isCopyOf(code, extractBehindInsert, scalars[3]), "composites", "Extract behind insert not resolved");
+  expect(isCopyOf(code, select, scalars[1]), "composites", "Constant select not folded");
+
+  // Extracts from the loaded vector itself must stay
+  expect(countInstructions(code, [vector] (SpirvInstruction ins) {
+    return ins.opCode() == spv::OpCompositeExtract && ins.arg(3) == vector;
+  }) == 4, "composites", "Extract from unknown vector removed");
+}
+
+
+void testInvalidCode() {
+  // Anything that does not look like a valid module
+  // must be passed through without modifications.
+  std::array<uint32_t, 8> words = { spv::MagicNumber, 0x10300, 0, 16, 0,
+    uint32_t(spv::OpNop) | (4u << spv::WordCountShift), 0, 0 };
+
+  SpirvCodeBuffer input(words.size(), words.data());
+  SpirvCodeBuffer output = SpirvOptimizer(SpirvCodeBuffer(input)).run();
+
+  expect(output.dwords() == input.dwords() && !std::memcmp(
+    output.data(), input.data(), input.size()), "invalid-code", "Truncated module modified");
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  int     argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(
+    GetCommandLineW(), &argc);
+
+  if (argc == 3 && str::fromws(argv[1]) == "--dump") {
+    g_dumpPath = str::fromws(argv[2]);
+  } else if (argc != 1) {
+    std::cerr << "Usage: spirv-optimizer [--dump directory]" << std::endl;
+    return 1;
+  }
+
+  const std::array<std::pair<const char*, void (*)()>, 8> tests = {{
+    { "forward-stores",   &testForwardStores   },
+    { "forward-loads",    &testForwardLoads    },
+    { "block-boundaries", &testBlockBoundaries },
+    { "function-calls",   &testFunctionCalls   },
+    { "access-chains",    &testAccessChains    },
+    { "dead-inputs",      &testDeadInputs      },
+    { "composites",       &testComposites      },
+    { "invalid-code",     &testInvalidCode     },
+  }};
+
+  uint32_t failures = 0;
+
+  for (const auto& test : tests) {
+    try {
+      test.second();
+      std::cout << test.first << ": Passed" << std::endl;
+    } catch (const DxvkError& e) {
+      std::cerr << e.message() << std::endl;
+      failures += 1;
+    }
+  }
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace dxvk {
+
+  /**
+   * \brief Input file found on the command line
+   */
+  struct TestFile {
+    /// Path to the file
+    std::filesystem::path path;
+    /// Path relative to the directory that was
+    /// scanned, or the file name for single files
+    std::filesystem::path name;
+  };
+
+
+  /**
+   * \brief Reads an entire file
+   *
+   * \param [in] path File path
+   * \returns File contents, empty on error
+   */
+  inline std::vector<char> readFile(const std::filesystem::path& path) {
+    std::ifstream ifile(path, std::ios::binary);
+
+    return std::vector<char>(
+      std::istreambuf_iterator<char>(ifile),
+      std::istreambuf_iterator<char>());
+  }
+
+
+  /**
+   * \brief Collects input files
+   *
+   * Accepts both individual files and directories. The
+   * latter are scanned for files with one of the given
+   * extensions, optionally including subdirectories.
+   * \param [in] paths Files and directories
+   * \param [in] extensions File extensions, e.g. \c ".dxbc"
+   * \param [in] recursive Whether to scan subdirectories
+   * \returns Files, sorted by path
+   */
+  inline std::vector<TestFile> findFiles(
+    const std::vector<std::filesystem::path>&   paths,
+          std::initializer_list<const char*>    extensions,
+          bool                                  recursive) {
+    std::vector<TestFile> files;
+
+    auto addFile = [&] (const std::filesystem::path& root, const std::filesystem::path& path) {
+      for (const char* ext : extensions) {
+        if (path.extension() == ext) {
+          files.push_back({ path, path.lexically_relative(root) });
+          break;
+        }
+      }
+    };
+
+    for (const auto& path : paths) {
+      if (!std::filesystem::is_directory(path)) {
+        files.push_back({ path, path.filename() });
+      } else if (recursive) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+          if (entry.is_regular_file())
+            addFile(path, entry.path());
+        }
+      } else {
+        for (const auto& entry : std::filesystem::directory_iterator(path)) {
+          if (entry.is_regular_file())
+            addFile(path, entry.path());
+        }
+      }
+    }
+
+    std::sort(files.begin(), files.end(),
+      [] (const TestFile& a, const TestFile& b) { return a.path < b.path; });
+    return files;
+  }
+
+}